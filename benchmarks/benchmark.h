@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string_view>
+
+namespace ng::benchmark {
+
+/// @brief Measures the average duration of a function, after a warm-up call that fills the caches and grows the reused buffers.
+/// @tparam TFunction The type of the function.
+/// @param runs The number of measured calls.
+/// @param function The function to measure.
+/// @return The average duration of a call, in microseconds.
+template <typename TFunction>
+[[nodiscard]] double MeasureMicroseconds(int runs, TFunction&& function) {
+  function();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; ++i) {
+    function();
+  }
+  std::chrono::duration<double, std::micro> duration =
+      std::chrono::steady_clock::now() - start;
+  return duration.count() / runs;
+}
+
+/// @brief Prints a row of results, aligned with the other rows.
+/// @param name The name of the measured case.
+/// @param count The size of the measured case.
+/// @param microseconds The measured duration, in microseconds.
+inline void Report(std::string_view name, size_t count, double microseconds) {
+  std::printf("%-40.*s %8zu %12.2f us\n", static_cast<int>(name.size()),
+              name.data(), count, microseconds);
+}
+
+}  // namespace ng::benchmark
@@ -0,0 +1,104 @@
+#include <SFML/System/Vector2.hpp>
+#include <bit>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <utility>
+
+#include "benchmarks/benchmark.h"
+#include "engine/app.h"
+#include "engine/circle_collider.h"
+#include "engine/collider_cache.h"
+#include "engine/rectangle_collider.h"
+#include "engine/scene.h"
+
+namespace {
+
+/// @brief Fills a scene with a bullet-heavy layout: many small circle bullets around a few larger rectangle bodies.
+/// @param scene The scene to fill.
+/// @param count The number of colliders.
+/// @param cache The cache to add the colliders to.
+void MakeBulletScene(ng::Scene& scene, size_t count, ng::ColliderCache& cache) {
+  std::mt19937 random(5);
+  std::uniform_real_distribution<float> position(0, 1024);
+  for (size_t i = 0; i < count; ++i) {
+    ng::Collider* collider = nullptr;
+    if (i % 10 == 0) {
+      collider = &scene.MakeChild<ng::RectangleCollider>(sf::Vector2f(16, 24));
+    } else {
+      collider = &scene.MakeChild<ng::CircleCollider>(3.F);
+    }
+    collider->SetLocalPosition({position(random), position(random)});
+    cache.Add(collider);
+  }
+}
+
+/// @brief Tests every entry against every other one, like the physics does without a broadphase.
+/// @param cache The cache to test.
+/// @return The number of overlapping pairs, counted twice.
+size_t CountBatchedOverlaps(const ng::ColliderCache& cache) {
+  size_t overlaps = 0;
+  for (size_t index = 0; index < cache.GetSize(); ++index) {
+    for (size_t first = 0; first < cache.GetSize();
+         first += ng::ColliderCache::kBatchSize) {
+      overlaps += static_cast<size_t>(
+          std::popcount(cache.CollidesBatch(first, index)));
+    }
+  }
+  return overlaps;
+}
+
+/// @brief Tests every entry against every other one, one pair at a time.
+/// @param cache The cache to test.
+/// @return The number of overlapping pairs, counted twice.
+size_t CountOverlaps(const ng::ColliderCache& cache) {
+  size_t overlaps = 0;
+  for (size_t index = 0; index < cache.GetSize(); ++index) {
+    for (size_t other = 0; other < cache.GetSize(); ++other) {
+      overlaps += cache.Collides(other, index) ? 1 : 0;
+    }
+  }
+  return overlaps;
+}
+
+}  // namespace
+
+int main() {
+  ng::App app(60);
+  for (size_t count : {500, 2000, 8000}) {
+    auto scene = std::make_unique<ng::Scene>(&app);
+    ng::ColliderCache cache;
+    MakeBulletScene(*scene, count, cache);
+    app.LoadScene(std::move(scene));
+    app.RunTicks(1);
+
+    size_t overlaps = 0;
+    double microseconds = ng::benchmark::MeasureMicroseconds(
+        3, [&]() { overlaps = CountOverlaps(cache); });
+    ng::benchmark::Report("one pair at a time", count, microseconds);
+
+    for (auto [kernel, name] :
+         {std::pair{ng::BatchKernel::kScalar, "scalar batches"},
+          std::pair{ng::BatchKernel::kSse2, "SSE2 batches"},
+          std::pair{ng::BatchKernel::kAvx2, "AVX2 batches"}}) {
+      if (!ng::ColliderCache::IsBatchKernelAvailable(kernel)) {
+        continue;
+      }
+
+      cache.SetBatchKernel(kernel);
+      size_t batched_overlaps = 0;
+      microseconds = ng::benchmark::MeasureMicroseconds(
+          3, [&]() { batched_overlaps = CountBatchedOverlaps(cache); });
+      ng::benchmark::Report(name, count, microseconds);
+      if (batched_overlaps != overlaps) {
+        std::printf("%s found %zu overlaps instead of %zu\n", name,
+                    batched_overlaps, overlaps);
+        return 1;
+      }
+    }
+
+    app.UnloadScene();
+    app.RunTicks(1);
+  }
+}
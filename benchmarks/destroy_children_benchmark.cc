@@ -0,0 +1,82 @@
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "engine/app.h"
+#include "engine/node.h"
+#include "engine/rectangle_collider.h"
+#include "engine/scene.h"
+#include "engine/spatial_grid.h"
+
+namespace {
+
+// The number of children destroyed in the measured tick.
+constexpr size_t kDestroyedCount = 10000;
+// The number of scenes measured for each child count.
+constexpr int kRuns = 5;
+
+/// @brief Measures the tick that removes many random children of the scene root at once, like a level clearing its bullets.
+/// @param app The app to load the scenes in.
+/// @param count The number of children of the scene root.
+/// @param with_colliders True to give each child a collider overlapping those of its neighbours, so the physics has pairs to forget.
+/// @return The average duration of the tick, in microseconds.
+double MeasureDestroyTick(ng::App& app, size_t count, bool with_colliders) {
+  std::mt19937 random(17);
+  std::chrono::duration<double, std::micro> total{};
+  // One more run than measured, as a warm-up.
+  for (int run = 0; run <= kRuns; ++run) {
+    auto scene = std::make_unique<ng::Scene>(&app);
+    if (with_colliders) {
+      scene->GetMutablePhysics().SetBroadphase(
+          std::make_unique<ng::SpatialGrid>(sf::Vector2f(64, 64)));
+    }
+    std::vector<ng::Node*> children;
+    children.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      children.push_back(&scene->MakeChild<ng::Node>());
+      if (with_colliders) {
+        // Rows of 100 colliders, each overlapping the next one.
+        children.back()->SetLocalPosition({static_cast<float>(i % 100) * 8,
+                                           static_cast<float>(i / 100) * 32});
+        children.back()->MakeChild<ng::RectangleCollider>(
+            sf::Vector2f(12, 12));
+      }
+    }
+    app.LoadScene(std::move(scene));
+    app.RunTicks(1);
+
+    std::ranges::shuffle(children, random);
+    for (size_t i = 0; i < kDestroyedCount; ++i) {
+      children[i]->Destroy();
+    }
+    auto start = std::chrono::steady_clock::now();
+    app.RunTicks(1);
+    if (run > 0) {
+      total += std::chrono::steady_clock::now() - start;
+    }
+
+    app.UnloadScene();
+    app.RunTicks(1);
+  }
+  return total.count() / kRuns;
+}
+
+}  // namespace
+
+int main() {
+  ng::App app(60);
+  for (size_t count : {20000, 100000}) {
+    ng::benchmark::Report("destroy 10000 children in one tick", count,
+                          MeasureDestroyTick(app, count, false));
+  }
+  for (size_t count : {20000, 100000}) {
+    ng::benchmark::Report("destroy 10000 colliding children", count,
+                          MeasureDestroyTick(app, count, true));
+  }
+}
@@ -0,0 +1,94 @@
+#include <SFML/System/Angle.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "engine/app.h"
+#include "engine/node.h"
+#include "engine/scene.h"
+#include "engine/thread_pool.h"
+
+namespace {
+
+// The number of independent subtrees of the scene.
+constexpr size_t kAgentCount = 4000;
+// The number of children moved by each subtree.
+constexpr size_t kPartCount = 4;
+
+/// @brief A root of an independent subtree that does some math every tick, like an enemy choosing where to go, then moves itself and its children.
+class Agent final : public ng::Node {
+ public:
+  /// @brief Constructs an Agent and its children.
+  /// @param app A pointer to the App instance.
+  /// @param seed The value the agent starts thinking from.
+  Agent(ng::App* app, float seed) : ng::Node(app), heading_(seed) {
+    SetParallelUpdate(true);
+    for (size_t i = 0; i < kPartCount; ++i) {
+      parts_.push_back(&MakeChild<ng::Node>());
+      parts_.back()->SetLocalPosition({static_cast<float>(i), 0});
+    }
+  }
+
+ protected:
+  void Update() override {
+    for (int i = 0; i < 64; ++i) {
+      heading_ = std::fmod(heading_ + std::sin(heading_) + 1.F, 6.283F);
+    }
+    SetLocalRotation(sf::radians(heading_));
+    Translate({std::cos(heading_), std::sin(heading_)});
+    for (ng::Node* part : parts_) {
+      part->SetLocalRotation(sf::radians(-heading_));
+    }
+  }
+
+ private:
+  // The current direction of the agent, in radians.
+  float heading_ = 0;
+  // The children moved every tick.
+  std::vector<ng::Node*> parts_;
+};
+
+/// @brief Measures a tick of a scene made of independent subtrees.
+/// @param app The app to load the scene in.
+/// @param thread_pool The thread pool of the scene, or nullptr to update every node in tree order.
+/// @return The average duration of a tick, in microseconds.
+double MeasureTick(ng::App& app, ng::ThreadPool* thread_pool) {
+  auto scene = std::make_unique<ng::Scene>(&app);
+  scene->SetThreadPool(thread_pool);
+  for (size_t i = 0; i < kAgentCount; ++i) {
+    scene->MakeChild<Agent>(static_cast<float>(i));
+  }
+  app.LoadScene(std::move(scene));
+  app.RunTicks(1);
+
+  double microseconds =
+      ng::benchmark::MeasureMicroseconds(20, [&]() { app.RunTicks(1); });
+  app.UnloadScene();
+  app.RunTicks(1);
+  return microseconds;
+}
+
+}  // namespace
+
+int main() {
+  ng::App app(60);
+  ng::benchmark::Report("tick without a pool", kAgentCount,
+                        MeasureTick(app, nullptr));
+
+  std::vector<size_t> thread_counts = {1, 2, 4};
+  if (std::thread::hardware_concurrency() > 4) {
+    thread_counts.push_back(std::thread::hardware_concurrency());
+  }
+  for (size_t thread_count : thread_counts) {
+    ng::ThreadPool thread_pool(thread_count);
+    ng::benchmark::Report("tick on " + std::to_string(thread_count) +
+                              (thread_count == 1 ? " thread" : " threads"),
+                          kAgentCount, MeasureTick(app, &thread_pool));
+  }
+}
@@ -0,0 +1,77 @@
+#include <SFML/System/Vector2.hpp>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "engine/app.h"
+#include "engine/circle_collider.h"
+#include "engine/collider.h"
+#include "engine/physics.h"
+#include "engine/rectangle_collider.h"
+#include "engine/scene.h"
+#include "engine/spatial_grid.h"
+
+namespace {
+
+// The number of colliders whose overlaps are queried in each measured run.
+constexpr size_t kQueryCount = 256;
+
+/// @brief Measures Physics::Overlap among colliders of about 16x16 px spread with the same density whatever their number, so each query has a similar number of hits.
+/// @param app The app owning the scene.
+/// @param count The number of colliders.
+/// @param use_grid Whether the physics uses a SpatialGrid broadphase.
+/// @return The average duration of a query, in microseconds.
+double MeasureOverlap(ng::App& app, size_t count, bool use_grid) {
+  auto scene = std::make_unique<ng::Scene>(&app);
+  if (use_grid) {
+    scene->GetMutablePhysics().SetBroadphase(
+        std::make_unique<ng::SpatialGrid>(sf::Vector2f(16, 16)));
+  }
+
+  // One collider per 32x32 px on average.
+  float world_size = std::sqrt(static_cast<float>(count)) * 32;
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> position(0, world_size);
+  std::vector<const ng::Collider*> colliders;
+  for (size_t i = 0; i < count; ++i) {
+    ng::Collider* collider = nullptr;
+    if (i % 2 == 0) {
+      collider = &scene->MakeChild<ng::RectangleCollider>(sf::Vector2f(16, 16));
+    } else {
+      collider = &scene->MakeChild<ng::CircleCollider>(8.F);
+    }
+    collider->SetLocalPosition({position(random), position(random)});
+    colliders.push_back(collider);
+  }
+
+  const ng::Physics& physics = scene->GetPhysics();
+  app.LoadScene(std::move(scene));
+  app.RunTicks(1);
+
+  std::array<const ng::Collider*, 64> hits{};
+  size_t stride = count / kQueryCount + 1;
+  double microseconds = ng::benchmark::MeasureMicroseconds(10, [&]() {
+    for (size_t i = 0; i < count; i += stride) {
+      physics.Overlap(*colliders[i], hits);
+    }
+  });
+  app.UnloadScene();
+  app.RunTicks(1);
+  return microseconds / static_cast<double>((count + stride - 1) / stride);
+}
+
+}  // namespace
+
+int main() {
+  ng::App app(60);
+  for (size_t count : {100, 1000, 10000, 50000}) {
+    ng::benchmark::Report("overlap query, no broadphase", count,
+                          MeasureOverlap(app, count, false));
+    ng::benchmark::Report("overlap query, spatial grid", count,
+                          MeasureOverlap(app, count, true));
+  }
+}
@@ -0,0 +1,95 @@
+#include <SFML/System/Vector2.hpp>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "engine/app.h"
+#include "engine/circle_collider.h"
+#include "engine/collider.h"
+#include "engine/rectangle_collider.h"
+#include "engine/scene.h"
+#include "engine/spatial_grid.h"
+#include "engine/thread_pool.h"
+
+namespace {
+
+/// @brief Measures a tick of a scene whose colliders all move every tick, so the physics step searches every pair again.
+/// @param app The app owning the scene.
+/// @param count The number of colliders.
+/// @param use_grid Whether the physics uses a SpatialGrid broadphase.
+/// @param thread_pool The thread pool of the physics, or nullptr to search on the stepping thread only.
+/// @return The average duration of a tick, in microseconds.
+double MeasureTick(ng::App& app, size_t count, bool use_grid,
+                   ng::ThreadPool* thread_pool) {
+  auto scene = std::make_unique<ng::Scene>(&app);
+  if (use_grid) {
+    scene->GetMutablePhysics().SetBroadphase(
+        std::make_unique<ng::SpatialGrid>(sf::Vector2f(32, 32)));
+  }
+  scene->GetMutablePhysics().SetThreadPool(thread_pool);
+
+  // About one collider per 24x24 px, so most colliders touch a few others.
+  float world_size = std::sqrt(static_cast<float>(count)) * 24;
+  std::mt19937 random(11);
+  std::uniform_real_distribution<float> position(0, world_size);
+  std::vector<ng::Collider*> colliders;
+  for (size_t i = 0; i < count; ++i) {
+    ng::Collider* collider = nullptr;
+    if (i % 2 == 0) {
+      collider = &scene->MakeChild<ng::RectangleCollider>(sf::Vector2f(16, 16));
+    } else {
+      collider = &scene->MakeChild<ng::CircleCollider>(8.F);
+    }
+    collider->SetLocalPosition({position(random), position(random)});
+    colliders.push_back(collider);
+  }
+
+  app.LoadScene(std::move(scene));
+  app.RunTicks(1);
+
+  float step = 1;
+  double microseconds = ng::benchmark::MeasureMicroseconds(20, [&]() {
+    // Back and forth, so the layout stays the same over the runs.
+    step = -step;
+    for (ng::Collider* collider : colliders) {
+      collider->Translate({step, step});
+    }
+    app.RunTicks(1);
+  });
+  app.UnloadScene();
+  app.RunTicks(1);
+  return microseconds;
+}
+
+}  // namespace
+
+int main() {
+  ng::App app(60);
+  std::vector<size_t> thread_counts = {1, 2, 4};
+  if (std::thread::hardware_concurrency() > 4) {
+    thread_counts.push_back(std::thread::hardware_concurrency());
+  }
+
+  for (size_t count : {10000, 40000}) {
+    for (bool use_grid : {false, true}) {
+      // Without a broadphase, 40000 colliders take seconds per tick.
+      if (!use_grid && count > 10000) {
+        continue;
+      }
+
+      for (size_t thread_count : thread_counts) {
+        ng::ThreadPool thread_pool(thread_count);
+        std::string name = use_grid ? "spatial grid" : "no broadphase";
+        name += " tick on " + std::to_string(thread_count) +
+                (thread_count == 1 ? " thread" : " threads");
+        ng::benchmark::Report(name, count,
+                              MeasureTick(app, count, use_grid, &thread_pool));
+      }
+    }
+  }
+}
@@ -0,0 +1,111 @@
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "engine/broadphase.h"
+#include "engine/collision_filter.h"
+#include "engine/sweep_and_prune.h"
+
+namespace {
+
+// The id of each collider is its index in the level.
+ng::ColliderId GetId(size_t index) {
+  return static_cast<ng::ColliderId>(index);
+}
+
+/// @brief A wide platformer level: rows of static 16x16 tiles, with a fifth of the colliders walking left and right above them.
+struct Level {
+  std::vector<sf::FloatRect> bounds;
+  std::vector<float> velocities;
+};
+
+Level MakeLevel(size_t count) {
+  std::mt19937 random(7);
+  Level level;
+  size_t tile_count = count - count / 5;
+  // Three rows of ground, as wide as needed to hold the tiles.
+  size_t columns = (tile_count + 2) / 3;
+  for (size_t i = 0; i < tile_count; ++i) {
+    level.bounds.push_back({{static_cast<float>(i % columns) * 16,
+                             600 - static_cast<float>(i / columns) * 16},
+                            {16, 16}});
+    level.velocities.push_back(0);
+  }
+
+  std::uniform_real_distribution<float> x(0, static_cast<float>(columns) * 16);
+  std::uniform_real_distribution<float> y(400, 570);
+  std::uniform_real_distribution<float> velocity(-3, 3);
+  for (size_t i = tile_count; i < count; ++i) {
+    level.bounds.push_back({{x(random), y(random)}, {16, 24}});
+    level.velocities.push_back(velocity(random));
+  }
+  return level;
+}
+
+void Move(Level& level) {
+  for (size_t i = 0; i < level.bounds.size(); ++i) {
+    level.bounds[i].position.x += level.velocities[i];
+  }
+}
+
+void QueryBruteForcePairs(const Level& level,
+                          std::vector<ng::ColliderPair>& pairs) {
+  for (size_t i = 0; i < level.bounds.size(); ++i) {
+    for (size_t j = i + 1; j < level.bounds.size(); ++j) {
+      if (ng::Overlaps(level.bounds[i], level.bounds[j])) {
+        pairs.push_back(ng::MakeColliderPair(GetId(i), GetId(j)));
+      }
+    }
+  }
+}
+
+void Run(size_t count) {
+  std::vector<ng::ColliderPair> pairs;
+
+  Level level = MakeLevel(count);
+  ng::SweepAndPrune broadphase;
+  for (size_t i = 0; i < count; ++i) {
+    broadphase.Insert(GetId(i), level.bounds[i], {});
+  }
+  double sweep_and_prune = ng::benchmark::MeasureMicroseconds(100, [&]() {
+    Move(level);
+    for (size_t i = 0; i < count; ++i) {
+      if (level.velocities[i] != 0) {
+        broadphase.Update(GetId(i), level.bounds[i]);
+      }
+    }
+    pairs.clear();
+    broadphase.QueryPairs(pairs);
+  });
+  ng::benchmark::Report("sweep and prune tick", count, sweep_and_prune);
+
+  std::vector<ng::ColliderId> candidates;
+  double queries = ng::benchmark::MeasureMicroseconds(100, [&]() {
+    candidates.clear();
+    for (size_t i = 0; i < count; ++i) {
+      if (level.velocities[i] != 0) {
+        broadphase.Query(level.bounds[i], {}, candidates);
+      }
+    }
+  });
+  ng::benchmark::Report("sweep and prune walker queries", count, queries);
+
+  level = MakeLevel(count);
+  double brute_force = ng::benchmark::MeasureMicroseconds(3, [&]() {
+    Move(level);
+    pairs.clear();
+    QueryBruteForcePairs(level, pairs);
+  });
+  ng::benchmark::Report("brute force tick", count, brute_force);
+}
+
+}  // namespace
+
+int main() {
+  for (size_t count : {250, 1000, 4000, 16000}) {
+    Run(count);
+  }
+}
@@ -0,0 +1,109 @@
+#include <SFML/Graphics/Transform.hpp>
+#include <SFML/System/Angle.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "engine/app.h"
+#include "engine/node.h"
+#include "engine/scene.h"
+
+namespace {
+
+// The number of nodes of each tree.
+constexpr size_t kNodeCount = 10000;
+
+/// @brief Moves the roots of a tree, which dirties every global transform, then reads the global transform and position of every node.
+/// @param roots The nodes moved each run.
+/// @param nodes The nodes read each run.
+/// @return The average duration of a run, in microseconds.
+double MeasureRefresh(const std::vector<ng::Node*>& roots,
+                      const std::vector<ng::Node*>& nodes) {
+  float angle = 1;
+  float checksum = 0;
+  double microseconds = ng::benchmark::MeasureMicroseconds(100, [&]() {
+    angle = -angle;
+    for (ng::Node* root : roots) {
+      root->SetLocalRotation(sf::degrees(angle));
+      root->Translate({angle, 0});
+    }
+    for (const ng::Node* node : nodes) {
+      checksum += node->GetGlobalTransform().getMatrix()[12];
+      checksum += node->GetGlobalPosition().y;
+    }
+  });
+  // Keeps the reads from being optimized away.
+  if (checksum == 0.5F) {
+    microseconds = 0;
+  }
+  return microseconds;
+}
+
+/// @brief Loads a scene and measures its trees once their children are added.
+/// @param app The app to load the scene in.
+/// @param scene The scene holding the trees.
+/// @param roots The nodes moved each run.
+/// @param nodes The nodes read each run.
+/// @return The average duration of a run, in microseconds.
+double MeasureScene(ng::App& app, std::unique_ptr<ng::Scene> scene,
+                    const std::vector<ng::Node*>& roots,
+                    const std::vector<ng::Node*>& nodes) {
+  app.LoadScene(std::move(scene));
+  app.RunTicks(1);
+  double microseconds = MeasureRefresh(roots, nodes);
+  app.UnloadScene();
+  app.RunTicks(1);
+  return microseconds;
+}
+
+/// @brief Measures chains of nodes, each node the only child of the previous one, like entities holding colliders holding effects, taken to the extreme.
+/// @param app The app to load the scene in.
+/// @param depth The number of nodes of each chain.
+void RunDeep(ng::App& app, size_t depth) {
+  auto scene = std::make_unique<ng::Scene>(&app);
+  std::vector<ng::Node*> roots;
+  std::vector<ng::Node*> nodes;
+  for (size_t chain = 0; chain < kNodeCount / depth; ++chain) {
+    ng::Node* node = &scene->MakeChild<ng::Node>();
+    roots.push_back(node);
+    nodes.push_back(node);
+    for (size_t i = 1; i < depth; ++i) {
+      node = &node->MakeChild<ng::Node>();
+      node->SetLocalPosition({1, 2});
+      node->SetLocalRotation(sf::degrees(1));
+      nodes.push_back(node);
+    }
+  }
+  ng::benchmark::Report("deep trees, depth " + std::to_string(depth),
+                        nodes.size(),
+                        MeasureScene(app, std::move(scene), roots, nodes));
+}
+
+/// @brief Measures a single root with every other node as its child, like a level holding its bullets and pickups.
+/// @param app The app to load the scene in.
+void RunWide(ng::App& app) {
+  auto scene = std::make_unique<ng::Scene>(&app);
+  ng::Node& root = scene->MakeChild<ng::Node>();
+  std::vector<ng::Node*> nodes = {&root};
+  for (size_t i = 1; i < kNodeCount; ++i) {
+    ng::Node& node = root.MakeChild<ng::Node>();
+    node.SetLocalPosition({static_cast<float>(i), 2});
+    nodes.push_back(&node);
+  }
+  ng::benchmark::Report("wide tree", nodes.size(),
+                        MeasureScene(app, std::move(scene), {&root}, nodes));
+}
+
+}  // namespace
+
+int main() {
+  ng::App app(60);
+  for (size_t depth : {10, 100, 1000}) {
+    RunDeep(app, depth);
+  }
+  RunWide(app);
+}
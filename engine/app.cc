@@ -4,13 +4,18 @@
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Window/Event.hpp>
 #include <SFML/Window/VideoMode.hpp>
+#include <cassert>
 #include <chrono>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "input.h"
+#include "name_table.h"
+#include "node_arena.h"
+#include "node_slot_table.h"
 #include "resource_manager.h"
 #include "scene.h"
 
@@ -18,17 +23,20 @@ namespace ng {
 
 App::App(sf::Vector2u window_size, const sf::String& window_title, uint32_t tps,
          uint32_t fps)
-    : window_(sf::RenderWindow(sf::VideoMode(window_size), window_title)),
+    : window_(std::in_place, sf::VideoMode(window_size), window_title),
       tps_(tps),
       fps_(fps) {
-  window_.setFramerateLimit(fps_);
+  window_->setFramerateLimit(fps_);
 }
 
+App::App(uint32_t tps) : tps_(tps) {}
+
 void App::Run() {
+  assert(window_);
   auto previous = std::chrono::steady_clock::now();
   // Accumulator for unprocessed time.
   std::chrono::nanoseconds lag(0);
-  while (window_.isOpen()) {
+  while (window_->isOpen()) {
     auto current = std::chrono::steady_clock::now();
 
     std::chrono::duration elapsed = (current - previous);
@@ -36,18 +44,7 @@ void App::Run() {
     previous = current;
     lag += elapsed;
 
-    if (is_scene_unloading_scheduled_) {
-      scene_->InternalOnDestroy();
-      scene_ = nullptr;
-      is_scene_unloading_scheduled_ = false;
-    }
-
-    if (scheduled_scene_to_load_) {
-      scene_ = std::move(scheduled_scene_to_load_);
-      scene_->InternalOnAdd();
-      scheduled_scene_to_load_ = nullptr;
-    }
-
+    ApplySceneChanges();
     PollInput();
 
     // Process game logic updates based on the target TPS.
@@ -58,13 +55,22 @@ void App::Run() {
       lag -= NanosecondsPerTick();
     }
 
-    window_.clear();
+    window_->clear();
 
     if (scene_) {
-      scene_->InternalDraw(window_);
+      scene_->InternalDraw(*window_);
     }
 
-    window_.display();
+    window_->display();
+  }
+}
+
+void App::RunTicks(uint32_t tick_count) {
+  for (uint32_t i = 0; i < tick_count; ++i) {
+    ApplySceneChanges();
+    if (scene_) {
+      scene_->InternalUpdate();
+    }
   }
 }
 
@@ -79,7 +85,8 @@ std::chrono::nanoseconds App::NanosecondsPerTick() const {
 }
 
 const sf::RenderWindow& App::GetWindow() const {
-  return window_;
+  assert(window_);
+  return *window_;
 }
 
 ResourceManager& App::GetResourceManager() {
@@ -90,6 +97,14 @@ const Input& App::GetInput() const {
   return input_;
 }
 
+NameTable& App::GetNameTable() {
+  return name_table_;
+}
+
+const NodeSlotTable& App::GetNodeSlots() const {
+  return node_slots_;
+}
+
 App& App::LoadScene(std::unique_ptr<Scene> scene) {
   scheduled_scene_to_load_ = std::move(scene);
   return *this;
@@ -99,13 +114,27 @@ void App::UnloadScene() {
   is_scene_unloading_scheduled_ = true;
 }
 
+void App::ApplySceneChanges() {
+  if (is_scene_unloading_scheduled_) {
+    scene_->InternalOnDestroy();
+    scene_ = nullptr;
+    is_scene_unloading_scheduled_ = false;
+  }
+
+  if (scheduled_scene_to_load_) {
+    scene_ = std::move(scheduled_scene_to_load_);
+    scene_->InternalOnAdd();
+    scheduled_scene_to_load_ = nullptr;
+  }
+}
+
 void App::PollInput() {
   // Prepare the input handler for new events.
   input_.Advance();
 
-  while (std::optional event = window_.pollEvent()) {
+  while (std::optional event = window_->pollEvent()) {
     if (event->is<sf::Event::Closed>()) {
-      window_.close();
+      window_->close();
     } else if (const auto* resized = event->getIf<sf::Event::Resized>()) {
       if (scene_) {
         scene_->OnWindowResize(resized->size);
@@ -117,4 +146,20 @@ void App::PollInput() {
   }
 }
 
+std::unique_ptr<NodeArena> App::TakeNodeArena() {
+  if (spare_node_arenas_.empty()) {
+    return std::make_unique<NodeArena>();
+  }
+
+  std::unique_ptr<NodeArena> node_arena = std::move(spare_node_arenas_.back());
+  spare_node_arenas_.pop_back();
+  return node_arena;
+}
+
+void App::RecycleNodeArena(std::unique_ptr<NodeArena> node_arena) {
+  assert(node_arena);
+  node_arena->Reset();
+  spare_node_arenas_.push_back(std::move(node_arena));
+}
+
 }  // namespace ng
\ No newline at end of file
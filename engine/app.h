@@ -4,8 +4,13 @@
 #include <SFML/System/String.hpp>
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include "input.h"
+#include "name_table.h"
+#include "node_arena.h"
+#include "node_slot_table.h"
 #include "resource_manager.h"
 #include "scene.h"
 
@@ -14,6 +19,11 @@ namespace ng {
 /// @brief The core application class, managing the game loop, window, resources, input, and scenes.
 class App {
  public:
+  // Scene needs to be able to call TakeNodeArena and RecycleNodeArena.
+  friend class Scene;
+  // Node needs to be able to acquire and release its slot in node_slots_.
+  friend class Node;
+
   /// @brief Constructs an App instance with the specified window size and title, ticks and frames per second.
   /// @param window_size The initial size of the game window.
   /// @param window_title The title of the game window.
@@ -21,6 +31,9 @@ class App {
   /// @param fps The target frames per second (rendering updates).
   App(sf::Vector2u window_size, const sf::String& window_title, uint32_t tps,
       uint32_t fps);
+  /// @brief Constructs an App without a window, for tests and benchmarks that only call RunTicks. It needs no display, nothing is drawn, and no input is ever received.
+  /// @param tps The target ticks per second (game logic updates).
+  explicit App(uint32_t tps);
   ~App() = default;
 
   App(const App& other) = delete;
@@ -28,9 +41,13 @@ class App {
   App(App&& other) = delete;
   App& operator=(App&& other) = delete;
 
-  /// @brief Runs the main game loop.
+  /// @brief Runs the main game loop. The App must have a window.
   void Run();
 
+  /// @brief Runs a number of game ticks back to back, without polling input, drawing, or waiting. Scheduled scene changes are applied before each tick, as in the main loop. Meant for tests and benchmarks.
+  /// @param tick_count The number of ticks to run.
+  void RunTicks(uint32_t tick_count);
+
   /// @brief Returns the duration of a single game tick in seconds.
   /// @return The time elapsed per tick.
   [[nodiscard]] std::chrono::duration<float> SecondsPerTick() const;
@@ -39,7 +56,7 @@ class App {
   /// @return The time elapsed per tick.
   [[nodiscard]] std::chrono::nanoseconds NanosecondsPerTick() const;
 
-  /// @brief Returns a constant reference to the SFML RenderWindow.
+  /// @brief Returns a constant reference to the SFML RenderWindow. The App must have a window.
   /// @return A constant reference to the game window object.
   [[nodiscard]] const sf::RenderWindow& GetWindow() const;
 
@@ -51,6 +68,14 @@ class App {
   /// @return A constant reference to the Input manager.
   [[nodiscard]] const Input& GetInput() const;
 
+  /// @brief Returns the NameTable holding the text of every interned node name.
+  /// @return A reference to the NameTable.
+  [[nodiscard]] NameTable& GetNameTable();
+
+  /// @brief Returns the table of slots that NodeHandle resolves through.
+  /// @return A constant reference to the NodeSlotTable.
+  [[nodiscard]] const NodeSlotTable& GetNodeSlots() const;
+
   /// @brief Loads a new scene, replacing the currently active one. The old scene (if any) will be unloaded in the next frame.
   /// @param scene A unique pointer to the new Scene to load. Ownership is transferred to the App. This pointer must not be null.
   /// @return A reference to the App instance for method chaining.
@@ -60,11 +85,21 @@ class App {
   void UnloadScene();
 
  private:
+  /// @brief Unloads and loads the scenes scheduled by UnloadScene and LoadScene.
+  void ApplySceneChanges();
+
   /// @brief Polls for SFML window events and updates the input state.
   void PollInput();
 
-  // The main SFML render window.
-  sf::RenderWindow window_;
+  /// @brief Returns an empty NodeArena for a new scene, reusing the arena of a destroyed scene if there is one.
+  /// @return A unique pointer to the NodeArena. This pointer is never null.
+  std::unique_ptr<NodeArena> TakeNodeArena();
+  /// @brief Keeps the NodeArena of a destroyed scene for the next scene, so reloading a scene does not allocate node memory again.
+  /// @param node_arena A unique pointer to the NodeArena. Every node allocated from it must have been destroyed. This pointer must not be null.
+  void RecycleNodeArena(std::unique_ptr<NodeArena> node_arena);
+
+  // The main SFML render window. Empty if the App was constructed without one.
+  std::optional<sf::RenderWindow> window_;
 
   // Target ticks per second for game logic updates.
   uint32_t tps_ = 0;
@@ -75,6 +110,13 @@ class App {
   ResourceManager resource_manager_;
   // Handles user input events.
   Input input_;
+  // Interns the names of the nodes.
+  NameTable name_table_;
+
+  // The slot of every live node. Declared before the scenes so it outlives their nodes.
+  NodeSlotTable node_slots_;
+  // The arenas of destroyed scenes, ready to be reused. Declared before the scenes so it outlives them.
+  std::vector<std::unique_ptr<NodeArena>> spare_node_arenas_;
 
   // The currently active game scene. Can be null if no scene is loaded. Ownership is managed by the App.
   std::unique_ptr<Scene> scene_;
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "collision_filter.h"
+
+namespace ng {
+
+/// @brief Checks if two axis-aligned bounding boxes overlap. Touching edges count as an overlap, matching the narrowphase tests.
+/// @param a The first bounding box.
+/// @param b The second bounding box.
+/// @return True if the boxes overlap or touch, false otherwise.
+[[nodiscard]] inline bool Overlaps(const sf::FloatRect& a,
+                                   const sf::FloatRect& b) {
+  return a.position.x <= b.position.x + b.size.x &&
+         b.position.x <= a.position.x + a.size.x &&
+         a.position.y <= b.position.y + b.size.y &&
+         b.position.y <= a.position.y + a.size.y;
+}
+
+/// @brief Checks if a bounding box moved along a displacement touches another bounding box at any point of its motion.
+/// @param bounds The bounding box at the start of the motion.
+/// @param displacement The motion of the bounding box.
+/// @param target The bounding box to check against.
+/// @return True if the moving box touches the target, false otherwise.
+[[nodiscard]] inline bool CastOverlaps(const sf::FloatRect& bounds,
+                                       sf::Vector2f displacement,
+                                       const sf::FloatRect& target) {
+  // Growing the target by the size of the moving box reduces the test to a
+  // segment starting at the top-left corner of the box, clipped one axis at a
+  // time.
+  float t_min = 0;
+  float t_max = 1;
+  auto clip = [&t_min, &t_max](float start, float delta, float min,
+                               float max) -> bool {
+    if (delta == 0) {
+      return start >= min && start <= max;
+    }
+
+    float t_near = (min - start) / delta;
+    float t_far = (max - start) / delta;
+    if (t_near > t_far) {
+      std::swap(t_near, t_far);
+    }
+    t_min = std::max(t_min, t_near);
+    t_max = std::min(t_max, t_far);
+    return t_min <= t_max;
+  };
+
+  return clip(bounds.position.x, displacement.x,
+              target.position.x - bounds.size.x,
+              target.position.x + target.size.x) &&
+         clip(bounds.position.y, displacement.y,
+              target.position.y - bounds.size.y,
+              target.position.y + target.size.y);
+}
+
+/// @brief Computes the bounding box of everything a bounding box touches while moving along a displacement.
+/// @param bounds The bounding box at the start of the motion.
+/// @param displacement The motion of the bounding box.
+/// @return The bounding box of the motion.
+[[nodiscard]] inline sf::FloatRect GetCastBounds(const sf::FloatRect& bounds,
+                                                 sf::Vector2f displacement) {
+  sf::Vector2f min{std::min(bounds.position.x,
+                            bounds.position.x + displacement.x),
+                   std::min(bounds.position.y,
+                            bounds.position.y + displacement.y)};
+  sf::Vector2f max{
+      std::max(bounds.position.x, bounds.position.x + displacement.x) +
+          bounds.size.x,
+      std::max(bounds.position.y, bounds.position.y + displacement.y) +
+          bounds.size.y};
+  return {min, max - min};
+}
+
+/// @brief The id a ColliderCache gives to each of its colliders, see ColliderCache::GetId. Ids are small, dense, and reused once their collider is removed, so broadphases key their entries with them and Physics turns the candidates they return into cache indices without a hash lookup.
+using ColliderId = uint32_t;
+
+/// @brief A pair of colliders. The first id is always lower than the second one.
+struct ColliderPair {
+  ColliderId first = 0;
+  ColliderId second = 0;
+
+  bool operator==(const ColliderPair& other) const = default;
+
+  /// @brief Orders pairs by their first id, then by their second id.
+  bool operator<(const ColliderPair& other) const {
+    return first != other.first ? first < other.first : second < other.second;
+  }
+};
+
+/// @brief Builds a ColliderPair with its ids in the canonical order.
+/// @param a The id of the first collider.
+/// @param b The id of the second collider.
+/// @return The ordered pair.
+[[nodiscard]] inline ColliderPair MakeColliderPair(ColliderId a,
+                                                   ColliderId b) {
+  if (a < b) {
+    return {a, b};
+  }
+  return {b, a};
+}
+
+/// @brief An abstract acceleration structure used by Physics to cull collision candidates before the exact narrowphase tests.
+class Broadphase {
+ public:
+  Broadphase() = default;
+  virtual ~Broadphase() = default;
+
+  Broadphase(const Broadphase& other) = delete;
+  Broadphase& operator=(const Broadphase& other) = delete;
+  Broadphase(Broadphase&& other) = delete;
+  Broadphase& operator=(Broadphase&& other) = delete;
+
+  /// @brief Inserts a collider into the structure.
+  /// @param id The id of the collider to insert. It must not be in the structure already.
+  /// @param bounds The world-space bounding box of the collider.
+  /// @param filter The collision filter of the collider. Structures may use the categories to skip whole groups of colliders.
+  virtual void Insert(ColliderId id, sf::FloatRect bounds,
+                      CollisionFilter filter) = 0;
+
+  /// @brief Updates the bounding box of a collider that is already in the structure.
+  /// @param id The id of the collider to update.
+  /// @param bounds The new world-space bounding box of the collider.
+  virtual void Update(ColliderId id, sf::FloatRect bounds) = 0;
+
+  /// @brief Removes a collider from the structure.
+  /// @param id The id of the collider to remove. Once removed, the id may be inserted again for another collider.
+  virtual void Remove(ColliderId id) = 0;
+
+  /// @brief Appends every collider whose bounding box overlaps the given bounds and whose filter can collide with the given one. Each collider is appended at most once.
+  /// @param bounds The world-space bounding box to query.
+  /// @param filter The collision filter of the query.
+  /// @param candidates The vector the ids of the overlapping colliders are appended to.
+  virtual void Query(sf::FloatRect bounds, CollisionFilter filter,
+                     std::vector<ColliderId>& candidates) const = 0;
+
+  /// @brief Appends every collider whose bounding box is touched by a bounding box moved along a displacement and whose filter can collide with the given one. Each collider is appended at most once.
+  /// @param bounds The world-space bounding box at the start of the motion. Has no size for rays.
+  /// @param displacement The motion of the bounding box.
+  /// @param filter The collision filter of the query.
+  /// @param candidates The vector the ids of the touched colliders are appended to.
+  virtual void QueryCast(sf::FloatRect bounds, sf::Vector2f displacement,
+                         CollisionFilter filter,
+                         std::vector<ColliderId>& candidates) const = 0;
+
+  /// @brief Appends every pair of colliders whose bounding boxes overlap and whose filters can collide. Each pair is appended once, in no particular order.
+  /// @param pairs The vector the overlapping pairs are appended to.
+  virtual void QueryPairs(std::vector<ColliderPair>& pairs) const = 0;
+};
+
+}  // namespace ng
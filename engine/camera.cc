@@ -33,12 +33,12 @@ void Camera::SetViewSize(sf::Vector2f size) {
 
 void Camera::OnAdd() {
   SetViewSize(sf::Vector2f(GetApp()->GetWindow().getSize()));
-  view_.setCenter(GetGlobalTransform().getPosition());
+  view_.setCenter(GetGlobalPosition());
   GetScene()->GetCameraManager().AddCamera(this);
 }
 
 void Camera::Update() {
-  view_.setCenter(GetGlobalTransform().getPosition());
+  view_.setCenter(GetGlobalPosition());
 }
 
 void Camera::OnDestroy() {
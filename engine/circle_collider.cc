@@ -4,6 +4,7 @@
 #include <SFML/Graphics/CircleShape.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 #endif
+#include <SFML/Graphics/Rect.hpp>
 #include <SFML/System/Vector2.hpp>
 #include <algorithm>
 
@@ -26,42 +27,43 @@ bool CircleCollider::Collides(const Collider& other) const {
   return other.Collides(*this);
 }
 
+float CircleCollider::GetWorldRadius() const {
+  return GetBounds().size.x / 2;
+}
+
 bool CircleCollider::Collides(const CircleCollider& other) const {
-  float distanceSquared = (GetGlobalTransform().getPosition() -
-                           other.GetGlobalTransform().getPosition())
-                              .lengthSquared();
-  float combinedRadius =
-      (radius_ * std::max(GetGlobalTransform().getScale().x,
-                          GetGlobalTransform().getScale().y)) +
-      (other.radius_ * std::max(other.GetGlobalTransform().getScale().x,
-                                other.GetGlobalTransform().getScale().y));
+  float distanceSquared = (GetCenter() - other.GetCenter()).lengthSquared();
+  float combinedRadius = GetWorldRadius() + other.GetWorldRadius();
   return distanceSquared <= combinedRadius * combinedRadius;
 }
 
 bool CircleCollider::Collides(const RectangleCollider& other) const {
-  sf::Vector2f pos = GetGlobalTransform().getPosition();
-  sf::Vector2f other_pos = other.GetGlobalTransform().getPosition();
-  // Calculate the half-extents of the rectangle in world space.
-  float half_x =
-      (other.GetSize().x * other.GetGlobalTransform().getScale().x) / 2;
-  float half_y =
-      (other.GetSize().y * other.GetGlobalTransform().getScale().y) / 2;
+  return Collides(other.GetBounds());
+}
 
+bool CircleCollider::Collides(const sf::FloatRect& rect) const {
+  sf::Vector2f pos = GetCenter();
   // Find the closest point on the rectangle to the circle's center.
-  float closest_x =
-      std::max(other_pos.x - half_x, std::min(pos.x, other_pos.x + half_x));
-  float closest_y =
-      std::max(other_pos.y - half_y, std::min(pos.y, other_pos.y + half_y));
+  float closest_x = std::max(rect.position.x,
+                             std::min(pos.x, rect.position.x + rect.size.x));
+  float closest_y = std::max(rect.position.y,
+                             std::min(pos.y, rect.position.y + rect.size.y));
 
   float diff_x = pos.x - closest_x;
   float diff_y = pos.y - closest_y;
   float distance_squared = (diff_x * diff_x) + (diff_y * diff_y);
 
-  float radius = radius_ * std::max(GetGlobalTransform().getScale().x,
-                                    GetGlobalTransform().getScale().y);
+  float radius = GetWorldRadius();
   return distance_squared <= radius * radius;
 }
 
+sf::FloatRect CircleCollider::ComputeBounds() const {
+  sf::Vector2f scale = GetGlobalScale();
+  float radius = radius_ * std::max(scale.x, scale.y);
+  return {GetGlobalPosition() - sf::Vector2f(radius, radius),
+          {2 * radius, 2 * radius}};
+}
+
 #ifndef NDEBUG
 void CircleCollider::Draw(sf::RenderTarget& target) {
   sf::CircleShape shape(radius_);
@@ -69,7 +71,7 @@ void CircleCollider::Draw(sf::RenderTarget& target) {
   shape.setOutlineThickness(2);
   shape.setFillColor(sf::Color::Transparent);
   shape.setOrigin(sf::Vector2f(radius_, radius_));
-  target.draw(shape, GetGlobalTransform().getTransform());
+  target.draw(shape, GetGlobalTransform());
 }
 #endif
 
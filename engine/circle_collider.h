@@ -1,5 +1,7 @@
 #pragma once
 
+#include <SFML/Graphics/Rect.hpp>
+
 #include "collider.h"
 
 namespace ng {
@@ -16,6 +18,10 @@ class CircleCollider : public Collider {
   /// @return The radius of the circle.
   [[nodiscard]] float GetRadius() const;
 
+  /// @brief Returns the world-space radius of the circle collider, scaled by the largest axis of its global scale. Cached like GetBounds.
+  /// @return The world-space radius of the circle.
+  [[nodiscard]] float GetWorldRadius() const;
+
   /// @brief Checks for collision with another Collider. Uses double-dispatch.
   /// @param other A constant reference to the other Collider.
   /// @return True if a collision occurs, false otherwise.
@@ -31,7 +37,14 @@ class CircleCollider : public Collider {
   /// @return True if a collision occurs, false otherwise.
   [[nodiscard]] bool Collides(const RectangleCollider& other) const override;
 
+  /// @brief Checks for collision with a world-space axis-aligned rectangle.
+  /// @param rect The rectangle to check against.
+  /// @return True if a collision occurs, false otherwise.
+  [[nodiscard]] bool Collides(const sf::FloatRect& rect) const override;
+
  protected:
+  [[nodiscard]] sf::FloatRect ComputeBounds() const override;
+
 #ifndef NDEBUG
   /// @brief Draw the collider's bounds for debugging purposes.
   /// @param target The SFML RenderTarget to draw to.
@@ -1,18 +1,94 @@
 #include "collider.h"
 
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <mutex>
+
+#include "collision_filter.h"
 #include "node.h"
 #include "scene.h"
+#include "type_id.h"
 
 namespace ng {
 
 Collider::Collider(App* app) : Node(app) {}
 
+const sf::FloatRect& Collider::GetBounds() const {
+  if (is_bounds_dirty_) {
+    bounds_ = ComputeBounds();
+    is_bounds_dirty_ = false;
+  }
+  return bounds_;
+}
+
+sf::Vector2f Collider::GetCenter() const {
+  return GetBounds().getCenter();
+}
+
+const CollisionFilter& Collider::GetCollisionFilter() const {
+  return collision_filter_;
+}
+
+void Collider::SetCollisionFilter(CollisionFilter filter) {
+  collision_filter_ = filter;
+  // The collider is not part of the physics world until it is added to a scene.
+  if (GetScene() == nullptr) {
+    return;
+  }
+
+  GetScene()->GetMutablePhysics().RefreshCollisionFilter(this);
+}
+
+bool Collider::IsStatic() const {
+  return is_static_;
+}
+
+void Collider::SetStatic(bool is_static) {
+  if (is_static_ == is_static) {
+    return;
+  }
+
+  is_static_ = is_static;
+  // The collider is not part of the physics world until it is added to a scene.
+  if (GetScene() == nullptr) {
+    return;
+  }
+
+  GetScene()->GetMutablePhysics().RefreshStatic(this);
+}
+
+uint64_t Collider::GetRegistrationId() const {
+  return registration_id_;
+}
+
+TypeId Collider::GetOwnerTypeId() const {
+  return owner_type_id_;
+}
+
+bool Collider::IsOwnerTypeKnown() const {
+  return owner_type_id_ != kNoTypeId || GetScene() == nullptr ||
+         GetParent()->GetParent() == nullptr;
+}
+
 void Collider::OnAdd() {
-  GetScene()->GetMutablePhysics().AddCollider(this);
+  owner_type_id_ = GetParent()->GetTypeId();
+  registration_id_ = GetScene()->GetMutablePhysics().AddCollider(this);
 }
 
 void Collider::OnDestroy() {
   GetScene()->GetMutablePhysics().RemoveCollider(this);
 }
 
+void Collider::OnGlobalTransformDirty() {
+  is_bounds_dirty_ = true;
+  // The collider is not part of the physics world until it is added to a scene.
+  if (GetScene() == nullptr) {
+    return;
+  }
+
+  std::unique_lock<std::recursive_mutex> lock = GetScene()->LockSharedState();
+  GetScene()->GetMutablePhysics().MarkDirty(this);
+}
+
 }  // namespace ng
\ No newline at end of file
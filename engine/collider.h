@@ -1,6 +1,14 @@
 #pragma once
 
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cassert>
+#include <cstdint>
+
+#include "collision_filter.h"
+#include "derived.h"
 #include "node.h"
+#include "type_id.h"
 
 namespace ng {
 
@@ -30,9 +38,84 @@ class Collider : public Node {
   /// @return True if a collision occurs, false otherwise.
   [[nodiscard]] virtual bool Collides(const RectangleCollider& other) const = 0;
 
+  /// @brief Checks for collision with a world-space axis-aligned rectangle.
+  /// @param rect The rectangle to check against. A rectangle of size zero checks against a single point.
+  /// @return True if a collision occurs, false otherwise.
+  [[nodiscard]] virtual bool Collides(const sf::FloatRect& rect) const = 0;
+
+  /// @brief Returns the world-space axis-aligned bounding box of the collider, used by the broadphase and the collision tests.
+  ///        Cached, and only recomputed after the global transform of the collider changed.
+  /// @return The bounding box enclosing the collider.
+  [[nodiscard]] const sf::FloatRect& GetBounds() const;
+
+  /// @brief Returns the world-space center of the collider. Cached like GetBounds.
+  /// @return The center of the bounding box of the collider.
+  [[nodiscard]] sf::Vector2f GetCenter() const;
+
+  /// @brief Returns the collision filter of the collider.
+  /// @return A constant reference to the collision filter.
+  [[nodiscard]] const CollisionFilter& GetCollisionFilter() const;
+
+  /// @brief Sets the categories the collider belongs to and collides with. Physics skips pairs whose filters cannot collide before any geometry test.
+  /// @param filter The new collision filter.
+  void SetCollisionFilter(CollisionFilter filter);
+
+  /// @brief Checks if the collider is static.
+  /// @return True if the collider is static, false if it is dynamic (default).
+  [[nodiscard]] bool IsStatic() const;
+
+  /// @brief Sets whether the collider is static. Static colliders are expected to never move: they are kept apart from the dynamic ones, never tested against each other, and never woken up.
+  ///        Moving a static collider, or changing its filter, is allowed: it wakes only the sleeping dynamic colliders overlapping its old or new bounds, found with a single broadphase query, or a scan of the sleeping colliders without a broadphase.
+  /// @param is_static True to make the collider static, false to make it dynamic.
+  void SetStatic(bool is_static);
+
+  /// @brief Returns the rank of the collider in the order colliders were added to its scene's physics world. Collision pairs and their callbacks are sorted by it, so they do not depend on where the colliders sit in memory.
+  /// @return The registration id, starting at 1, or 0 if the collider was never added to a physics world.
+  [[nodiscard]] uint64_t GetRegistrationId() const;
+
+  /// @brief Returns the id of the exact type of the collider's owner, its parent node. Recorded when the collider is added to a scene.
+  /// @return The TypeId of the owner, or kNoTypeId if the collider is not part of a scene or the exact type of its owner was not recorded, see Node::GetTypeId.
+  [[nodiscard]] TypeId GetOwnerTypeId() const;
+
+  /// @brief Returns whether typed queries such as GetOwner can tell the type of the collider's owner. False only for owners added through a pointer to one of their base classes; the scene root, which no query looks for, and colliders outside of a scene count as known.
+  /// @return True if the type of the owner is recorded or does not matter.
+  [[nodiscard]] bool IsOwnerTypeKnown() const;
+
+  /// @brief Returns the owner of the collider, its parent node, if it is exactly of a given type. Costs a single integer compare, without RTTI.
+  /// @tparam T The type of the owner to look for, must derive from Node.
+  /// @return A pointer to the owner, or nullptr if the owner is not exactly of type T.
+  template <Derived<Node> T>
+  [[nodiscard]] T* GetOwner() const {
+    // An owner of unknown type would be missed even if it is a T.
+    assert(IsOwnerTypeKnown());
+    if (owner_type_id_ != TypeIdOf<T>()) {
+      return nullptr;
+    }
+    return static_cast<T*>(GetParent());
+  }
+
  protected:
   void OnAdd() override;
   void OnDestroy() override;
+  void OnGlobalTransformDirty() override;
+
+  /// @brief Computes the world-space axis-aligned bounding box of the collider from its global transform. Called by GetBounds when the cached one is out of date.
+  /// @return The bounding box enclosing the collider.
+  [[nodiscard]] virtual sf::FloatRect ComputeBounds() const = 0;
+
+ private:
+  // The categories the collider belongs to and collides with.
+  CollisionFilter collision_filter_;
+  // The cached world-space bounding box. Mutable for lazy evaluation.
+  mutable sf::FloatRect bounds_;
+  // Flag indicating if bounds_ needs to be recomputed. Mutable for lazy evaluation.
+  mutable bool is_bounds_dirty_ = true;
+  // Whether the collider is static.
+  bool is_static_ = false;
+  // The type of the owner, copied from the parent when the collider is added to a scene.
+  TypeId owner_type_id_ = kNoTypeId;
+  // The rank of the collider in the order colliders were added to the physics world, or 0.
+  uint64_t registration_id_ = 0;
 };
 
 }  // namespace ng
\ No newline at end of file
@@ -0,0 +1,615 @@
+#include "collider_cache.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#include "circle_collider.h"
+#include "collider.h"
+#include "collision_filter.h"
+#include "raycast_hit.h"
+
+// The SSE2 kernel is compiled wherever SSE2 is part of the target. GCC and
+// Clang also compile the AVX2 kernel for targets without AVX2 and only select
+// it on processors that support it.
+#if defined(__SSE2__) || defined(_M_X64)
+#define NG_SSE2_KERNEL
+#if defined(__AVX2__)
+#define NG_AVX2_KERNEL
+#define NG_AVX2_TARGET
+#elif defined(__GNUC__)
+#define NG_AVX2_KERNEL
+#define NG_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace ng {
+
+namespace {
+
+/// @brief Casts a ray against an axis-aligned box centered on the origin.
+/// @param origin The start of the ray, relative to the center of the box.
+/// @param direction The unit direction of the ray.
+/// @param half_extents The half extents of the box.
+/// @return The hit without its collider, or std::nullopt if the ray misses the box.
+std::optional<RaycastHit> CastBox(sf::Vector2f origin, sf::Vector2f direction,
+                                  sf::Vector2f half_extents) {
+  float t_enter = -std::numeric_limits<float>::infinity();
+  float t_exit = std::numeric_limits<float>::infinity();
+  sf::Vector2f normal;
+  auto clip = [&](float start, float delta, float half_extent,
+                  sf::Vector2f axis) -> bool {
+    if (delta == 0) {
+      return std::abs(start) <= half_extent;
+    }
+
+    // The ray enters through the side facing against its direction.
+    float near_side = std::copysign(half_extent, -delta);
+    float t_near = (near_side - start) / delta;
+    float t_far = (-near_side - start) / delta;
+    if (t_near > t_enter) {
+      t_enter = t_near;
+      normal = delta > 0 ? -axis : axis;
+    }
+    t_exit = std::min(t_exit, t_far);
+    return true;
+  };
+
+  if (!clip(origin.x, direction.x, half_extents.x, {1, 0}) ||
+      !clip(origin.y, direction.y, half_extents.y, {0, 1}) ||
+      t_enter > t_exit || t_exit < 0) {
+    return std::nullopt;
+  }
+
+  if (t_enter < 0) {
+    return RaycastHit{.distance = 0, .normal = -direction};
+  }
+  return RaycastHit{.distance = t_enter, .normal = normal};
+}
+
+/// @brief Casts a ray against a circle centered on the origin.
+/// @param origin The start of the ray, relative to the center of the circle.
+/// @param direction The unit direction of the ray.
+/// @param radius The radius of the circle.
+/// @return The hit without its collider, or std::nullopt if the ray misses the circle.
+std::optional<RaycastHit> CastCircle(sf::Vector2f origin,
+                                     sf::Vector2f direction, float radius) {
+  float projection = origin.dot(direction);
+  float outside = origin.lengthSquared() - (radius * radius);
+  // The ray starts outside and points away from the circle.
+  if (outside > 0 && projection > 0) {
+    return std::nullopt;
+  }
+
+  float discriminant = (projection * projection) - outside;
+  if (discriminant < 0) {
+    return std::nullopt;
+  }
+
+  float distance = -projection - std::sqrt(discriminant);
+  if (distance < 0) {
+    return RaycastHit{.distance = 0, .normal = -direction};
+  }
+  return RaycastHit{.distance = distance,
+                    .normal = (origin + (direction * distance)) / radius};
+}
+
+/// @brief Replaces a hit with another one if the other one is closer.
+/// @param closest The closest hit so far.
+/// @param hit The hit to compare.
+void KeepClosest(std::optional<RaycastHit>& closest,
+                 const std::optional<RaycastHit>& hit) {
+  if (hit && (!closest || hit->distance < closest->distance)) {
+    closest = hit;
+  }
+}
+
+}  // namespace
+
+ColliderShape ColliderCache::GetShape(const Collider& collider) {
+  if (dynamic_cast<const CircleCollider*>(&collider) != nullptr) {
+    return ColliderShape::kCircle;
+  }
+  return ColliderShape::kRectangle;
+}
+
+bool ColliderCache::Collides(ColliderShape a_shape,
+                             const sf::FloatRect& a_bounds,
+                             ColliderShape b_shape,
+                             const sf::FloatRect& b_bounds) {
+  return Collides(ToGeometry(a_shape, a_bounds), ToGeometry(b_shape, b_bounds));
+}
+
+bool ColliderCache::IsBatchKernelAvailable(BatchKernel kernel) {
+  switch (kernel) {
+    case BatchKernel::kScalar:
+      return true;
+    case BatchKernel::kSse2:
+#if defined(NG_SSE2_KERNEL)
+      return true;
+#else
+      return false;
+#endif
+    case BatchKernel::kAvx2:
+#if defined(__AVX2__)
+      return true;
+#elif defined(NG_AVX2_KERNEL)
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") != 0;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+void ColliderCache::SetBatchKernel(BatchKernel kernel) {
+  assert(IsBatchKernelAvailable(kernel));
+  batch_kernel_ = kernel;
+}
+
+ColliderId ColliderCache::Add(const Collider* collider) {
+  assert(collider);
+  ColliderId id = 0;
+  if (free_ids_.empty()) {
+    id = static_cast<ColliderId>(indices_.size());
+    indices_.emplace_back();
+  } else {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+  }
+  [[maybe_unused]] auto [it, inserted] =
+      ids_by_collider_.insert({collider, id});
+  assert(inserted);
+
+  size_t index = colliders_.size();
+  indices_[id] = index;
+  colliders_.push_back(collider);
+  ids_.push_back(id);
+  shapes_.push_back(GetShape(*collider));
+  center_x_.emplace_back();
+  center_y_.emplace_back();
+  half_width_.emplace_back();
+  half_height_.emplace_back();
+  radius_.emplace_back();
+  categories_.emplace_back();
+  masks_.emplace_back();
+  idle_ticks_.emplace_back();
+  Refresh(index);
+  RefreshFilter(index);
+  Wake(index);
+  return id;
+}
+
+void ColliderCache::Remove(const Collider* collider) {
+  assert(collider);
+  auto it = ids_by_collider_.find(collider);
+  if (it == ids_by_collider_.end()) {
+    return;
+  }
+
+  // Only the awake entries must stay together, so the entry is moved to the
+  // end of the awake ones, then to the end of the table, and popped.
+  size_t index = indices_[it->second];
+  if (index < awake_count_) {
+    Swap(index, awake_count_ - 1);
+    index = --awake_count_;
+  }
+  Swap(index, colliders_.size() - 1);
+
+  colliders_.pop_back();
+  ids_.pop_back();
+  shapes_.pop_back();
+  center_x_.pop_back();
+  center_y_.pop_back();
+  half_width_.pop_back();
+  half_height_.pop_back();
+  radius_.pop_back();
+  categories_.pop_back();
+  masks_.pop_back();
+  idle_ticks_.pop_back();
+  free_ids_.push_back(it->second);
+  ids_by_collider_.erase(it);
+}
+
+void ColliderCache::Refresh(size_t index) {
+  assert(index < colliders_.size());
+  Geometry geometry =
+      ToGeometry(shapes_[index], colliders_[index]->GetBounds());
+  center_x_[index] = geometry.center_x;
+  center_y_[index] = geometry.center_y;
+  half_width_[index] = geometry.half_width;
+  half_height_[index] = geometry.half_height;
+  radius_[index] = geometry.radius;
+}
+
+void ColliderCache::RefreshFilter(size_t index) {
+  assert(index < colliders_.size());
+  const CollisionFilter& filter = colliders_[index]->GetCollisionFilter();
+  categories_[index] = filter.category;
+  masks_[index] = filter.mask;
+}
+
+void ColliderCache::Wake(size_t index) {
+  assert(index < colliders_.size());
+  idle_ticks_[index] = 0;
+  if (index >= awake_count_) {
+    Swap(index, awake_count_++);
+  }
+}
+
+void ColliderCache::Sleep(size_t index) {
+  assert(index < awake_count_);
+  Swap(index, --awake_count_);
+}
+
+uint32_t ColliderCache::AddIdleTick(size_t index) {
+  assert(index < awake_count_);
+  return ++idle_ticks_[index];
+}
+
+size_t ColliderCache::GetAwakeCount() const {
+  return awake_count_;
+}
+
+const size_t* ColliderCache::FindIndex(const Collider* collider) const {
+  const ColliderId* id = FindId(collider);
+  if (id == nullptr) {
+    return nullptr;
+  }
+
+  return &indices_[*id];
+}
+
+const ColliderId* ColliderCache::FindId(const Collider* collider) const {
+  auto it = ids_by_collider_.find(collider);
+  if (it == ids_by_collider_.end()) {
+    return nullptr;
+  }
+
+  return &it->second;
+}
+
+ColliderId ColliderCache::GetId(size_t index) const {
+  return ids_[index];
+}
+
+size_t ColliderCache::GetIndex(ColliderId id) const {
+  assert(id < indices_.size());
+  return indices_[id];
+}
+
+size_t ColliderCache::GetSize() const {
+  return colliders_.size();
+}
+
+const Collider* ColliderCache::GetCollider(size_t index) const {
+  return colliders_[index];
+}
+
+ColliderShape ColliderCache::GetShape(size_t index) const {
+  return shapes_[index];
+}
+
+sf::FloatRect ColliderCache::GetBounds(size_t index) const {
+  float extent_x = half_width_[index] + radius_[index];
+  float extent_y = half_height_[index] + radius_[index];
+  return {{center_x_[index] - extent_x, center_y_[index] - extent_y},
+          {2 * extent_x, 2 * extent_y}};
+}
+
+CollisionFilter ColliderCache::GetFilter(size_t index) const {
+  return {.category = categories_[index], .mask = masks_[index]};
+}
+
+bool ColliderCache::Collides(size_t a, size_t b) const {
+  return GetFilter(a).CanCollide(GetFilter(b)) &&
+         Collides(GetGeometry(a), GetGeometry(b));
+}
+
+bool ColliderCache::Collides(size_t index, ColliderShape shape,
+                             const sf::FloatRect& bounds,
+                             CollisionFilter filter) const {
+  return GetFilter(index).CanCollide(filter) &&
+         Collides(GetGeometry(index), ToGeometry(shape, bounds));
+}
+
+std::optional<RaycastHit> ColliderCache::Cast(size_t index,
+                                              ColliderShape shape,
+                                              const sf::FloatRect& bounds,
+                                              CollisionFilter filter,
+                                              sf::Vector2f direction,
+                                              float max_distance) const {
+  if (!GetFilter(index).CanCollide(filter)) {
+    return std::nullopt;
+  }
+
+  std::optional<RaycastHit> hit = Cast(
+      GetGeometry(index), ToGeometry(shape, bounds), direction, max_distance);
+  if (hit) {
+    hit->collider = colliders_[index];
+  }
+  return hit;
+}
+
+uint32_t ColliderCache::CollidesBatch(size_t first, size_t index) const {
+  return CollidesBatch(first, GetGeometry(index), GetFilter(index));
+}
+
+uint32_t ColliderCache::CollidesBatch(size_t first, ColliderShape shape,
+                                      const sf::FloatRect& bounds,
+                                      CollisionFilter filter) const {
+  return CollidesBatch(first, ToGeometry(shape, bounds), filter);
+}
+
+ColliderCache::Geometry ColliderCache::ToGeometry(
+    ColliderShape shape, const sf::FloatRect& bounds) {
+  sf::Vector2f half_size = bounds.size / 2.F;
+  Geometry geometry{
+      .center_x = bounds.position.x + half_size.x,
+      .center_y = bounds.position.y + half_size.y,
+  };
+  if (shape == ColliderShape::kCircle) {
+    geometry.radius = half_size.x;
+  } else {
+    geometry.half_width = half_size.x;
+    geometry.half_height = half_size.y;
+  }
+
+  return geometry;
+}
+
+bool ColliderCache::Collides(const Geometry& a, const Geometry& b) {
+  // The distance between the two boxes, ignoring the radii. Zero on an axis
+  // where the boxes overlap.
+  float gap_x = std::max(0.F, std::abs(a.center_x - b.center_x) -
+                                  (a.half_width + b.half_width));
+  float gap_y = std::max(0.F, std::abs(a.center_y - b.center_y) -
+                                  (a.half_height + b.half_height));
+  float radius = a.radius + b.radius;
+  return (gap_x * gap_x) + (gap_y * gap_y) <= radius * radius;
+}
+
+std::optional<RaycastHit> ColliderCache::Cast(const Geometry& target,
+                                              const Geometry& shape,
+                                              sf::Vector2f direction,
+                                              float max_distance) {
+  if (Collides(target, shape)) {
+    return RaycastHit{.distance = 0, .normal = -direction};
+  }
+
+  // Moving the shape against the target is the same as moving the center of
+  // the shape against their Minkowski sum, which is again a rounded box. A
+  // rounded box is the union of its box grown by the radius along each axis
+  // and of a circle on each corner.
+  sf::Vector2f origin{shape.center_x - target.center_x,
+                      shape.center_y - target.center_y};
+  float half_width = target.half_width + shape.half_width;
+  float half_height = target.half_height + shape.half_height;
+  float radius = target.radius + shape.radius;
+
+  std::optional<RaycastHit> hit =
+      CastBox(origin, direction, {half_width + radius, half_height});
+  KeepClosest(hit,
+              CastBox(origin, direction, {half_width, half_height + radius}));
+  if (radius > 0) {
+    for (sf::Vector2f corner : {sf::Vector2f{-half_width, -half_height},
+                                sf::Vector2f{half_width, -half_height},
+                                sf::Vector2f{-half_width, half_height},
+                                sf::Vector2f{half_width, half_height}}) {
+      KeepClosest(hit, CastCircle(origin - corner, direction, radius));
+    }
+  }
+
+  if (!hit || hit->distance > max_distance) {
+    return std::nullopt;
+  }
+  return hit;
+}
+
+uint32_t ColliderCache::CollidesBatch(const float* center_x,
+                                      const float* center_y,
+                                      const float* half_width,
+                                      const float* half_height,
+                                      const float* radius,
+                                      const Geometry& other) const {
+  switch (batch_kernel_) {
+#if defined(NG_AVX2_KERNEL)
+    case BatchKernel::kAvx2:
+      return CollidesBatchAvx2(center_x, center_y, half_width, half_height,
+                               radius, other);
+#endif
+#if defined(NG_SSE2_KERNEL)
+    case BatchKernel::kSse2:
+      return CollidesBatchSse2(center_x, center_y, half_width, half_height,
+                               radius, other);
+#endif
+    default:
+      return CollidesBatchScalar(center_x, center_y, half_width, half_height,
+                                 radius, other);
+  }
+}
+
+uint32_t ColliderCache::CollidesBatchScalar(
+    const float* center_x, const float* center_y, const float* half_width,
+    const float* half_height, const float* radius, const Geometry& other) {
+  uint32_t mask = 0;
+  for (size_t i = 0; i < kBatchSize; ++i) {
+    Geometry geometry{
+        .center_x = center_x[i],
+        .center_y = center_y[i],
+        .half_width = half_width[i],
+        .half_height = half_height[i],
+        .radius = radius[i],
+    };
+    if (Collides(geometry, other)) {
+      mask |= 1U << i;
+    }
+  }
+
+  return mask;
+}
+
+#if defined(NG_SSE2_KERNEL)
+uint32_t ColliderCache::CollidesBatchSse2(
+    const float* center_x, const float* center_y, const float* half_width,
+    const float* half_height, const float* radius, const Geometry& other) {
+  static_assert(kBatchSize % 4 == 0);
+  const __m128 zero = _mm_setzero_ps();
+  // Clearing the sign bit computes the absolute value.
+  const __m128 sign_mask = _mm_set1_ps(-0.F);
+
+  uint32_t mask = 0;
+  for (size_t i = 0; i < kBatchSize; i += 4) {
+    __m128 distance_x = _mm_andnot_ps(
+        sign_mask,
+        _mm_sub_ps(_mm_loadu_ps(center_x + i), _mm_set1_ps(other.center_x)));
+    __m128 gap_x = _mm_max_ps(
+        zero,
+        _mm_sub_ps(distance_x, _mm_add_ps(_mm_loadu_ps(half_width + i),
+                                          _mm_set1_ps(other.half_width))));
+    __m128 distance_y = _mm_andnot_ps(
+        sign_mask,
+        _mm_sub_ps(_mm_loadu_ps(center_y + i), _mm_set1_ps(other.center_y)));
+    __m128 gap_y = _mm_max_ps(
+        zero,
+        _mm_sub_ps(distance_y, _mm_add_ps(_mm_loadu_ps(half_height + i),
+                                          _mm_set1_ps(other.half_height))));
+    __m128 radii =
+        _mm_add_ps(_mm_loadu_ps(radius + i), _mm_set1_ps(other.radius));
+
+    __m128 distance_squared =
+        _mm_add_ps(_mm_mul_ps(gap_x, gap_x), _mm_mul_ps(gap_y, gap_y));
+    __m128 hits = _mm_cmple_ps(distance_squared, _mm_mul_ps(radii, radii));
+    mask |= static_cast<uint32_t>(_mm_movemask_ps(hits)) << i;
+  }
+
+  return mask;
+}
+#endif
+
+#if defined(NG_AVX2_KERNEL)
+NG_AVX2_TARGET uint32_t ColliderCache::CollidesBatchAvx2(
+    const float* center_x, const float* center_y, const float* half_width,
+    const float* half_height, const float* radius, const Geometry& other) {
+  static_assert(kBatchSize == 8);
+  const __m256 zero = _mm256_setzero_ps();
+  // Clearing the sign bit computes the absolute value.
+  const __m256 sign_mask = _mm256_set1_ps(-0.F);
+
+  __m256 distance_x = _mm256_andnot_ps(
+      sign_mask, _mm256_sub_ps(_mm256_loadu_ps(center_x),
+                               _mm256_set1_ps(other.center_x)));
+  __m256 gap_x = _mm256_max_ps(
+      zero, _mm256_sub_ps(distance_x,
+                          _mm256_add_ps(_mm256_loadu_ps(half_width),
+                                        _mm256_set1_ps(other.half_width))));
+  __m256 distance_y = _mm256_andnot_ps(
+      sign_mask, _mm256_sub_ps(_mm256_loadu_ps(center_y),
+                               _mm256_set1_ps(other.center_y)));
+  __m256 gap_y = _mm256_max_ps(
+      zero, _mm256_sub_ps(distance_y,
+                          _mm256_add_ps(_mm256_loadu_ps(half_height),
+                                        _mm256_set1_ps(other.half_height))));
+  __m256 radii =
+      _mm256_add_ps(_mm256_loadu_ps(radius), _mm256_set1_ps(other.radius));
+
+  __m256 distance_squared = _mm256_add_ps(_mm256_mul_ps(gap_x, gap_x),
+                                          _mm256_mul_ps(gap_y, gap_y));
+  __m256 hits = _mm256_cmp_ps(distance_squared, _mm256_mul_ps(radii, radii),
+                              _CMP_LE_OQ);
+  return static_cast<uint32_t>(_mm256_movemask_ps(hits));
+}
+#endif
+
+BatchKernel ColliderCache::GetFastestBatchKernel() {
+  if (IsBatchKernelAvailable(BatchKernel::kAvx2)) {
+    return BatchKernel::kAvx2;
+  }
+  if (IsBatchKernelAvailable(BatchKernel::kSse2)) {
+    return BatchKernel::kSse2;
+  }
+  return BatchKernel::kScalar;
+}
+
+void ColliderCache::Swap(size_t a, size_t b) {
+  if (a == b) {
+    return;
+  }
+
+  std::swap(colliders_[a], colliders_[b]);
+  std::swap(ids_[a], ids_[b]);
+  std::swap(shapes_[a], shapes_[b]);
+  std::swap(center_x_[a], center_x_[b]);
+  std::swap(center_y_[a], center_y_[b]);
+  std::swap(half_width_[a], half_width_[b]);
+  std::swap(half_height_[a], half_height_[b]);
+  std::swap(radius_[a], radius_[b]);
+  std::swap(categories_[a], categories_[b]);
+  std::swap(masks_[a], masks_[b]);
+  std::swap(idle_ticks_[a], idle_ticks_[b]);
+  indices_[ids_[a]] = a;
+  indices_[ids_[b]] = b;
+}
+
+ColliderCache::Geometry ColliderCache::GetGeometry(size_t index) const {
+  return {
+      .center_x = center_x_[index],
+      .center_y = center_y_[index],
+      .half_width = half_width_[index],
+      .half_height = half_height_[index],
+      .radius = radius_[index],
+  };
+}
+
+uint32_t ColliderCache::CollidesBatch(size_t first, const Geometry& other,
+                                      CollisionFilter filter) const {
+  assert(first < colliders_.size());
+  size_t count = std::min(kBatchSize, colliders_.size() - first);
+  uint32_t allowed = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (filter.CanCollide(GetFilter(first + i))) {
+      allowed |= 1U << i;
+    }
+  }
+
+  if (allowed == 0) {
+    return 0;
+  }
+
+  if (count == kBatchSize) {
+    return allowed & CollidesBatch(&center_x_[first], &center_y_[first],
+                                   &half_width_[first], &half_height_[first],
+                                   &radius_[first], other);
+  }
+
+  // The last batch is copied to a padded buffer so that the kernels never
+  // read past the end of the arrays.
+  std::array<float, kBatchSize> center_x{};
+  std::array<float, kBatchSize> center_y{};
+  std::array<float, kBatchSize> half_width{};
+  std::array<float, kBatchSize> half_height{};
+  std::array<float, kBatchSize> radius{};
+  std::copy_n(&center_x_[first], count, center_x.begin());
+  std::copy_n(&center_y_[first], count, center_y.begin());
+  std::copy_n(&half_width_[first], count, half_width.begin());
+  std::copy_n(&half_height_[first], count, half_height.begin());
+  std::copy_n(&radius_[first], count, radius.begin());
+  return allowed & CollidesBatch(center_x.data(), center_y.data(),
+                                 half_width.data(), half_height.data(),
+                                 radius.data(), other);
+}
+
+}  // namespace ng
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "broadphase.h"
+#include "collision_filter.h"
+#include "raycast_hit.h"
+
+namespace ng {
+
+class Collider;
+
+/// @brief The geometric shape of a collider.
+enum class ColliderShape : uint8_t {
+  /// @brief A circle, described by its center and radius.
+  kCircle,
+  /// @brief An axis-aligned rectangle, described by its bounding box.
+  kRectangle,
+};
+
+/// @brief An implementation of the batched overlap tests of ColliderCache.
+enum class BatchKernel : uint8_t {
+  /// @brief A loop over the scalar test, available on every target.
+  kScalar,
+  /// @brief Two groups of 4 entries with SSE2 instructions, available on x86 targets with SSE2.
+  kSse2,
+  /// @brief A single group of 8 entries with AVX2 instructions, available on x86 processors that support them.
+  kAvx2,
+};
+
+/// @brief A structure-of-arrays table holding the world-space geometry of every collider in the physics world.
+///        Entries are refreshed only when their collider moves, so collision tests never go back through the scene graph.
+///        Every shape is stored as a box rounded by a radius: rectangles have no radius and circles have an empty box, which lets a single branch-free test handle every pair of shapes.
+///        Entries are either awake or asleep. Awake entries always come first, so the awake ones can be iterated as a contiguous range.
+///        Each collider also gets an id that does not change while it stays in the table, which broadphases use as their key, see GetIndex.
+class ColliderCache {
+ public:
+  /// @brief The number of entries tested at once by CollidesBatch.
+  static constexpr size_t kBatchSize = 8;
+
+  /// @brief Determines the shape of a collider.
+  /// @param collider The Collider to inspect.
+  /// @return The shape of the collider.
+  [[nodiscard]] static ColliderShape GetShape(const Collider& collider);
+
+  /// @brief Tests two shapes for overlap. Touching shapes count as overlapping.
+  /// @param a_shape The shape of the first collider.
+  /// @param a_bounds The world-space bounding box of the first collider.
+  /// @param b_shape The shape of the second collider.
+  /// @param b_bounds The world-space bounding box of the second collider.
+  /// @return True if the shapes overlap, false otherwise.
+  [[nodiscard]] static bool Collides(ColliderShape a_shape,
+                                     const sf::FloatRect& a_bounds,
+                                     ColliderShape b_shape,
+                                     const sf::FloatRect& b_bounds);
+
+  /// @brief Checks if a batch kernel was compiled for this target and runs on this processor.
+  /// @param kernel The kernel to check.
+  /// @return True if the kernel can be selected, false otherwise.
+  [[nodiscard]] static bool IsBatchKernelAvailable(BatchKernel kernel);
+
+  /// @brief Selects the kernel used by CollidesBatch. The fastest available one is selected by default, so selecting another one is only useful to compare them.
+  /// @param kernel The kernel to use. It must be available.
+  void SetBatchKernel(BatchKernel kernel);
+
+  /// @brief Adds an awake collider to the table and computes its geometry.
+  /// @param collider A pointer to the Collider to add. This pointer must not be null and the Collider must not be in the table already.
+  /// @return The id given to the collider. It may be the id of a collider removed earlier.
+  ColliderId Add(const Collider* collider);
+
+  /// @brief Removes a collider from the table. Other entries may change index, but keep their id.
+  /// @param collider A pointer to the Collider to remove. This pointer must not be null.
+  void Remove(const Collider* collider);
+
+  /// @brief Recomputes the geometry of a collider from its global transform.
+  /// @param index The index of the entry to refresh.
+  void Refresh(size_t index);
+
+  /// @brief Copies the collision filter of a collider again.
+  /// @param index The index of the entry to refresh.
+  void RefreshFilter(size_t index);
+
+  /// @brief Wakes an entry up and resets its idle ticks. The entry may change index.
+  /// @param index The index of the entry to wake up.
+  void Wake(size_t index);
+
+  /// @brief Puts an awake entry to sleep. The entry and the last awake entry swap indices.
+  /// @param index The index of the entry to put to sleep.
+  void Sleep(size_t index);
+
+  /// @brief Counts one more tick without motion for an awake entry.
+  /// @param index The index of the entry.
+  /// @return The number of ticks the entry has been idle for.
+  uint32_t AddIdleTick(size_t index);
+
+  /// @brief Returns the number of awake entries. The awake entries are the ones with an index lower than this.
+  /// @return The number of awake entries.
+  [[nodiscard]] size_t GetAwakeCount() const;
+
+  /// @brief Finds the index of a collider.
+  /// @param collider The Collider to look for.
+  /// @return A pointer to the index of the collider, or nullptr if it is not in the table.
+  [[nodiscard]] const size_t* FindIndex(const Collider* collider) const;
+
+  /// @brief Finds the id of a collider.
+  /// @param collider The Collider to look for.
+  /// @return A pointer to the id of the collider, or nullptr if it is not in the table.
+  [[nodiscard]] const ColliderId* FindId(const Collider* collider) const;
+
+  /// @brief Returns the id of an entry.
+  /// @param index The index of the entry.
+  /// @return The id of the collider.
+  [[nodiscard]] ColliderId GetId(size_t index) const;
+
+  /// @brief Returns the index of the entry of an id, without a hash lookup.
+  /// @param id The id of a collider in the table.
+  /// @return The index of the entry.
+  [[nodiscard]] size_t GetIndex(ColliderId id) const;
+
+  /// @brief Returns the number of colliders in the table.
+  /// @return The number of entries.
+  [[nodiscard]] size_t GetSize() const;
+
+  /// @brief Returns the collider of an entry.
+  /// @param index The index of the entry.
+  /// @return A pointer to the Collider.
+  [[nodiscard]] const Collider* GetCollider(size_t index) const;
+
+  /// @brief Returns the shape of an entry.
+  /// @param index The index of the entry.
+  /// @return The shape of the collider.
+  [[nodiscard]] ColliderShape GetShape(size_t index) const;
+
+  /// @brief Returns the world-space bounding box of an entry.
+  /// @param index The index of the entry.
+  /// @return The bounding box of the collider.
+  [[nodiscard]] sf::FloatRect GetBounds(size_t index) const;
+
+  /// @brief Returns the collision filter of an entry.
+  /// @param index The index of the entry.
+  /// @return The collision filter of the collider.
+  [[nodiscard]] CollisionFilter GetFilter(size_t index) const;
+
+  /// @brief Tests two entries for overlap. Entries whose filters cannot collide never overlap.
+  /// @param a The index of the first entry.
+  /// @param b The index of the second entry.
+  /// @return True if the colliders overlap, false otherwise.
+  [[nodiscard]] bool Collides(size_t a, size_t b) const;
+
+  /// @brief Tests an entry against an arbitrary shape.
+  /// @param index The index of the entry.
+  /// @param shape The shape to test against.
+  /// @param bounds The world-space bounding box of the shape to test against.
+  /// @param filter The collision filter of the shape to test against.
+  /// @return True if the collider overlaps the shape, false otherwise.
+  [[nodiscard]] bool Collides(size_t index, ColliderShape shape,
+                              const sf::FloatRect& bounds,
+                              CollisionFilter filter) const;
+
+  /// @brief Moves an arbitrary shape along a direction and finds where it first touches an entry.
+  /// @param index The index of the entry.
+  /// @param shape The shape to move.
+  /// @param bounds The world-space bounding box of the shape at the start of the motion. Has no size for rays.
+  /// @param filter The collision filter of the shape.
+  /// @param direction The unit direction of the motion.
+  /// @param max_distance The length of the motion.
+  /// @return The hit, or std::nullopt if the shape does not touch the collider within max_distance or their filters cannot collide.
+  [[nodiscard]] std::optional<RaycastHit> Cast(size_t index,
+                                               ColliderShape shape,
+                                               const sf::FloatRect& bounds,
+                                               CollisionFilter filter,
+                                               sf::Vector2f direction,
+                                               float max_distance) const;
+
+  /// @brief Tests up to kBatchSize consecutive entries against another entry at once.
+  /// @param first The index of the first entry to test.
+  /// @param index The index of the entry to test against.
+  /// @return A bitmask whose bit i is set if the entry first + i overlaps the other entry. Bits past the last entry are never set.
+  [[nodiscard]] uint32_t CollidesBatch(size_t first, size_t index) const;
+
+  /// @brief Tests up to kBatchSize consecutive entries against an arbitrary shape at once.
+  /// @param first The index of the first entry to test.
+  /// @param shape The shape to test against.
+  /// @param bounds The world-space bounding box of the shape to test against.
+  /// @param filter The collision filter of the shape to test against.
+  /// @return A bitmask whose bit i is set if the entry first + i overlaps the shape. Bits past the last entry are never set.
+  [[nodiscard]] uint32_t CollidesBatch(size_t first, ColliderShape shape,
+                                       const sf::FloatRect& bounds,
+                                       CollisionFilter filter) const;
+
+ private:
+  /// @brief The geometry of a single shape, gathered from the arrays or from a bounding box.
+  struct Geometry {
+    float center_x = 0;
+    float center_y = 0;
+    float half_width = 0;
+    float half_height = 0;
+    float radius = 0;
+  };
+
+  /// @brief Converts a shape and its bounding box to a rounded box.
+  /// @param shape The shape.
+  /// @param bounds The world-space bounding box of the shape.
+  /// @return The geometry of the shape.
+  [[nodiscard]] static Geometry ToGeometry(ColliderShape shape,
+                                           const sf::FloatRect& bounds);
+
+  /// @brief Tests two rounded boxes for overlap.
+  /// @param a The first geometry.
+  /// @param b The second geometry.
+  /// @return True if the rounded boxes overlap, false otherwise.
+  [[nodiscard]] static bool Collides(const Geometry& a, const Geometry& b);
+
+  /// @brief Moves a rounded box along a direction and finds where it first touches another one.
+  /// @param target The geometry that does not move.
+  /// @param shape The geometry to move.
+  /// @param direction The unit direction of the motion.
+  /// @param max_distance The length of the motion.
+  /// @return The hit without its collider, or std::nullopt if the rounded boxes do not touch within max_distance.
+  [[nodiscard]] static std::optional<RaycastHit> Cast(const Geometry& target,
+                                                      const Geometry& shape,
+                                                      sf::Vector2f direction,
+                                                      float max_distance);
+
+  /// @brief Tests kBatchSize consecutive rounded boxes stored in structure-of-arrays form against another one, with the selected kernel.
+  ///        Every kernel performs exactly the operations of the scalar Collides, so they give the same results; tests/collider_cache_test.cc checks it.
+  /// @param center_x A pointer to kBatchSize center x coordinates.
+  /// @param center_y A pointer to kBatchSize center y coordinates.
+  /// @param half_width A pointer to kBatchSize half widths.
+  /// @param half_height A pointer to kBatchSize half heights.
+  /// @param radius A pointer to kBatchSize radii.
+  /// @param other The geometry to test against.
+  /// @return A bitmask whose bit i is set if the i-th rounded box overlaps the other one.
+  [[nodiscard]] uint32_t CollidesBatch(const float* center_x,
+                                       const float* center_y,
+                                       const float* half_width,
+                                       const float* half_height,
+                                       const float* radius,
+                                       const Geometry& other) const;
+
+  /// @brief The scalar kernel of CollidesBatch, with the same parameters.
+  [[nodiscard]] static uint32_t CollidesBatchScalar(
+      const float* center_x, const float* center_y, const float* half_width,
+      const float* half_height, const float* radius, const Geometry& other);
+
+  /// @brief The SSE2 kernel of CollidesBatch, with the same parameters. Only defined where BatchKernel::kSse2 is available.
+  [[nodiscard]] static uint32_t CollidesBatchSse2(
+      const float* center_x, const float* center_y, const float* half_width,
+      const float* half_height, const float* radius, const Geometry& other);
+
+  /// @brief The AVX2 kernel of CollidesBatch, with the same parameters. Only defined where BatchKernel::kAvx2 can be compiled.
+  [[nodiscard]] static uint32_t CollidesBatchAvx2(
+      const float* center_x, const float* center_y, const float* half_width,
+      const float* half_height, const float* radius, const Geometry& other);
+
+  /// @brief Finds the fastest kernel available on this target and processor.
+  /// @return The fastest kernel.
+  [[nodiscard]] static BatchKernel GetFastestBatchKernel();
+
+  /// @brief Swaps two entries, keeping the index of each id up to date.
+  /// @param a The index of the first entry.
+  /// @param b The index of the second entry.
+  void Swap(size_t a, size_t b);
+
+  /// @brief Returns the geometry of an entry.
+  /// @param index The index of the entry.
+  /// @return The geometry of the collider.
+  [[nodiscard]] Geometry GetGeometry(size_t index) const;
+
+  /// @brief Tests up to kBatchSize consecutive entries against a geometry at once. Entries whose filters cannot collide are skipped before the geometry test.
+  /// @param first The index of the first entry to test.
+  /// @param other The geometry to test against.
+  /// @param filter The collision filter of the geometry.
+  /// @return A bitmask whose bit i is set if the entry first + i overlaps the geometry. Bits past the last entry are never set.
+  [[nodiscard]] uint32_t CollidesBatch(size_t first, const Geometry& other,
+                                       CollisionFilter filter) const;
+
+  // The colliders of the entries. The Physics owns neither the table nor these pointers.
+  std::vector<const Collider*> colliders_;
+  // The ids of the entries.
+  std::vector<ColliderId> ids_;
+  // The shapes of the entries.
+  std::vector<ColliderShape> shapes_;
+  // The world-space centers of the entries.
+  std::vector<float> center_x_;
+  std::vector<float> center_y_;
+  // The world-space half extents of the rectangle entries. Zero for circles.
+  std::vector<float> half_width_;
+  std::vector<float> half_height_;
+  // The world-space radii of the circle entries. Zero for rectangles.
+  std::vector<float> radius_;
+  // The collision categories and masks of the entries.
+  std::vector<uint32_t> categories_;
+  std::vector<uint32_t> masks_;
+  // The number of ticks each entry has been awake without moving.
+  std::vector<uint32_t> idle_ticks_;
+  // The number of awake entries, which are stored before the sleeping ones.
+  size_t awake_count_ = 0;
+  // The index of the entry of each id in the arrays above. Out of date for the ids in free_ids_.
+  std::vector<size_t> indices_;
+  // The ids of the removed colliders, given again to the next colliders added.
+  std::vector<ColliderId> free_ids_;
+  // The id of each collider in the table.
+  std::unordered_map<const Collider*, ColliderId> ids_by_collider_;
+  // The kernel used by CollidesBatch.
+  BatchKernel batch_kernel_ = GetFastestBatchKernel();
+};
+
+}  // namespace ng
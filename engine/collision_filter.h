@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ng {
+
+/// @brief Decides which colliders are tested against each other, similar to the Layer bitmask used for rendering.
+///        The meaning of each category bit is defined by the user of the engine.
+struct CollisionFilter {
+  /// @brief Checks if two filters allow their colliders to collide. Each collider's category must be part of the other's mask.
+  /// @param other The filter of the other collider.
+  /// @return True if the colliders may collide, false otherwise.
+  [[nodiscard]] bool CanCollide(const CollisionFilter& other) const {
+    return (category & other.mask) != 0 && (other.category & mask) != 0;
+  }
+
+  bool operator==(const CollisionFilter& other) const = default;
+
+  // The categories the collider belongs to, usually a single bit.
+  uint32_t category = 1U;
+  // The categories the collider collides with. Every category by default.
+  uint32_t mask = ~0U;
+};
+
+}  // namespace ng
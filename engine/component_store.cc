@@ -0,0 +1,62 @@
+#include "component_store.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "entity.h"
+#include "type_id.h"
+
+namespace ng {
+
+Entity ComponentStore::CreateEntity() {
+  if (!free_indices_.empty()) {
+    uint32_t index = free_indices_.back();
+    free_indices_.pop_back();
+    return {.index = index, .generation = generations_[index]};
+  }
+
+  generations_.push_back(0);
+  return {.index = static_cast<uint32_t>(generations_.size() - 1),
+          .generation = 0};
+}
+
+void ComponentStore::DestroyEntity(Entity entity) {
+  if (!IsAlive(entity)) {
+    return;
+  }
+
+  for (const std::unique_ptr<PoolBase>& pool : pools_) {
+    if (pool != nullptr) {
+      pool->Remove(entity.index);
+    }
+  }
+  // Ids still held for this entity no longer match its slot.
+  ++generations_[entity.index];
+  free_indices_.push_back(entity.index);
+}
+
+bool ComponentStore::IsAlive(Entity entity) const {
+  return entity.index < generations_.size() &&
+         generations_[entity.index] == entity.generation;
+}
+
+size_t ComponentStore::GetEntityCount() const {
+  return generations_.size() - free_indices_.size();
+}
+
+ComponentStore::PoolBase* ComponentStore::FindPool(TypeId type_id) {
+  if (type_id >= pools_.size()) {
+    return nullptr;
+  }
+  return pools_[type_id].get();
+}
+
+const ComponentStore::PoolBase* ComponentStore::FindPool(TypeId type_id) const {
+  if (type_id >= pools_.size()) {
+    return nullptr;
+  }
+  return pools_[type_id].get();
+}
+
+}  // namespace ng
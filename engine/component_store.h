@@ -0,0 +1,307 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "entity.h"
+#include "function_ref.h"
+#include "type_id.h"
+
+namespace ng {
+
+/// @brief Stores plain data components for a set of entities, in one dense array per component type.
+///        Systems iterate the arrays directly, so hot data such as velocities or animation timers can be processed without chasing node pointers.
+///        Adding or removing a component moves other components of the same type, so references and spans are only valid until the next structural change of that type.
+class ComponentStore {
+ public:
+  ComponentStore() = default;
+
+  ComponentStore(const ComponentStore& other) = delete;
+  ComponentStore& operator=(const ComponentStore& other) = delete;
+  ComponentStore(ComponentStore&& other) = delete;
+  ComponentStore& operator=(ComponentStore&& other) = delete;
+
+  /// @brief Creates an entity without components.
+  /// @return The new entity.
+  [[nodiscard]] Entity CreateEntity();
+
+  /// @brief Destroys an entity and all its components. No-op if the entity is not alive.
+  /// @param entity The entity to destroy.
+  void DestroyEntity(Entity entity);
+
+  /// @brief Checks if an entity was created by this store and not destroyed since.
+  /// @param entity The entity to check.
+  /// @return True if the entity is alive, false otherwise.
+  [[nodiscard]] bool IsAlive(Entity entity) const;
+
+  /// @brief Returns the number of alive entities.
+  /// @return The number of entities.
+  [[nodiscard]] size_t GetEntityCount() const;
+
+  /// @brief Adds a component to an entity. The entity must be alive and must not have a component of this type already.
+  /// @tparam T The type of the component.
+  /// @tparam Args The constructor arguments for T.
+  /// @param entity The entity to add the component to.
+  /// @param args The arguments to forward to the constructor of T.
+  /// @return A reference to the new component, valid until the next structural change of T.
+  template <typename T, typename... Args>
+  T& Add(Entity entity, Args&&... args) {
+    assert(IsAlive(entity));
+    return GetOrCreatePool<T>().Add(entity, std::forward<Args>(args)...);
+  }
+
+  /// @brief Removes a component from an entity. No-op if the entity has no component of this type.
+  /// @tparam T The type of the component.
+  /// @param entity The entity to remove the component from.
+  template <typename T>
+  void Remove(Entity entity) {
+    Pool<T>* pool = FindPool<T>();
+    if (pool != nullptr && IsAlive(entity)) {
+      pool->Remove(entity.index);
+    }
+  }
+
+  /// @brief Returns the component of an entity.
+  /// @tparam T The type of the component.
+  /// @param entity The entity.
+  /// @return A pointer to the component, or nullptr if the entity is not alive or has no component of this type.
+  template <typename T>
+  [[nodiscard]] T* Get(Entity entity) {
+    Pool<T>* pool = FindPool<T>();
+    if (pool == nullptr || !IsAlive(entity)) {
+      return nullptr;
+    }
+    return pool->Find(entity.index);
+  }
+
+  /// @brief Returns the component of an entity.
+  /// @tparam T The type of the component.
+  /// @param entity The entity.
+  /// @return A pointer to the component, or nullptr if the entity is not alive or has no component of this type.
+  template <typename T>
+  [[nodiscard]] const T* Get(Entity entity) const {
+    const Pool<T>* pool = FindPool<T>();
+    if (pool == nullptr || !IsAlive(entity)) {
+      return nullptr;
+    }
+    return pool->Find(entity.index);
+  }
+
+  /// @brief Checks if an entity has a component.
+  /// @tparam T The type of the component.
+  /// @param entity The entity.
+  /// @return True if the entity is alive and has a component of this type, false otherwise.
+  template <typename T>
+  [[nodiscard]] bool Has(Entity entity) const {
+    return Get<T>(entity) != nullptr;
+  }
+
+  /// @brief Returns every component of a type, packed in a contiguous array. The i-th component belongs to the i-th entity of GetEntities.
+  /// @tparam T The type of the components.
+  /// @return The components, valid until the next structural change of T.
+  template <typename T>
+  [[nodiscard]] std::span<T> GetComponents() {
+    Pool<T>* pool = FindPool<T>();
+    if (pool == nullptr) {
+      return {};
+    }
+    return pool->components;
+  }
+
+  /// @brief Returns the entities owning the components of a type, in the same order as GetComponents.
+  /// @tparam T The type of the components.
+  /// @return The entities, valid until the next structural change of T.
+  template <typename T>
+  [[nodiscard]] std::span<const Entity> GetEntities() const {
+    const PoolBase* pool = FindPool(TypeIdOf<T>());
+    if (pool == nullptr) {
+      return {};
+    }
+    return pool->entities;
+  }
+
+  /// @brief Calls a function for every entity that has all the given components.
+  ///        The smallest pool drives the iteration. The function must not add or remove components of the iterated types.
+  /// @tparam T The types of the components.
+  /// @param func The function to call with each entity and its components.
+  template <typename... T>
+    requires(sizeof...(T) > 0)
+  void ForEach(std::type_identity_t<FunctionRef<void(Entity, T&...)>> func) {
+    ForEachIn(func, FindPool<T>()...);
+  }
+
+ private:
+  /// @brief The sparse index of an entity slot without a component in a pool.
+  static constexpr uint32_t kAbsent = std::numeric_limits<uint32_t>::max();
+
+  /// @brief The part of a component pool that does not depend on the component type.
+  ///        A sparse set: sparse maps an entity slot to its dense index, entities maps it back.
+  struct PoolBase {
+    virtual ~PoolBase() = default;
+
+    /// @brief Checks if an entity slot has a component in this pool.
+    /// @param index The slot of the entity.
+    /// @return True if the slot has a component, false otherwise.
+    [[nodiscard]] bool Contains(uint32_t index) const {
+      return index < sparse.size() && sparse[index] != kAbsent;
+    }
+
+    /// @brief Removes the component of an entity slot by moving the last component into its place. No-op if the slot has none.
+    /// @param index The slot of the entity.
+    virtual void Remove(uint32_t index) = 0;
+
+    // The dense index of each entity slot, or kAbsent.
+    std::vector<uint32_t> sparse;
+    // The entity owning each dense component.
+    std::vector<Entity> entities;
+  };
+
+  /// @brief The dense array of every component of a type.
+  /// @tparam T The type of the components.
+  template <typename T>
+  struct Pool final : PoolBase {
+    /// @brief Adds a component to an entity that has none in this pool.
+    /// @tparam Args The constructor arguments for T.
+    /// @param entity The entity.
+    /// @param args The arguments to forward to the constructor of T.
+    /// @return A reference to the new component.
+    template <typename... Args>
+    T& Add(Entity entity, Args&&... args) {
+      assert(!Contains(entity.index));
+      if (entity.index >= sparse.size()) {
+        sparse.resize(entity.index + 1, kAbsent);
+      }
+      sparse[entity.index] = static_cast<uint32_t>(entities.size());
+      entities.push_back(entity);
+      return components.emplace_back(std::forward<Args>(args)...);
+    }
+
+    /// @brief Returns the component of an entity slot.
+    /// @param index The slot of the entity.
+    /// @return A pointer to the component, or nullptr if the slot has none.
+    [[nodiscard]] T* Find(uint32_t index) {
+      if (!Contains(index)) {
+        return nullptr;
+      }
+      return &components[sparse[index]];
+    }
+
+    /// @brief Returns the component of an entity slot.
+    /// @param index The slot of the entity.
+    /// @return A pointer to the component, or nullptr if the slot has none.
+    [[nodiscard]] const T* Find(uint32_t index) const {
+      if (!Contains(index)) {
+        return nullptr;
+      }
+      return &components[sparse[index]];
+    }
+
+    void Remove(uint32_t index) override {
+      if (!Contains(index)) {
+        return;
+      }
+      uint32_t dense = sparse[index];
+      if (dense + 1 != entities.size()) {
+        entities[dense] = entities.back();
+        components[dense] = std::move(components.back());
+        sparse[entities[dense].index] = dense;
+      }
+      entities.pop_back();
+      components.pop_back();
+      sparse[index] = kAbsent;
+    }
+
+    // The components, in the same order as entities.
+    std::vector<T> components;
+  };
+
+  /// @brief Returns the pool of a component type.
+  /// @param type_id The TypeId of the component type.
+  /// @return A pointer to the pool, or nullptr if no component of this type was ever added.
+  [[nodiscard]] PoolBase* FindPool(TypeId type_id);
+
+  /// @brief Returns the pool of a component type.
+  /// @param type_id The TypeId of the component type.
+  /// @return A pointer to the pool, or nullptr if no component of this type was ever added.
+  [[nodiscard]] const PoolBase* FindPool(TypeId type_id) const;
+
+  /// @brief Returns the pool of a component type.
+  /// @tparam T The type of the components.
+  /// @return A pointer to the pool, or nullptr if no component of this type was ever added.
+  template <typename T>
+  [[nodiscard]] Pool<T>* FindPool() {
+    return static_cast<Pool<T>*>(FindPool(TypeIdOf<T>()));
+  }
+
+  /// @brief Returns the pool of a component type.
+  /// @tparam T The type of the components.
+  /// @return A pointer to the pool, or nullptr if no component of this type was ever added.
+  template <typename T>
+  [[nodiscard]] const Pool<T>* FindPool() const {
+    return static_cast<const Pool<T>*>(FindPool(TypeIdOf<T>()));
+  }
+
+  /// @brief Returns the pool of a component type, creating it the first time.
+  /// @tparam T The type of the components.
+  /// @return A reference to the pool.
+  template <typename T>
+  Pool<T>& GetOrCreatePool() {
+    TypeId type_id = TypeIdOf<T>();
+    if (type_id >= pools_.size()) {
+      pools_.resize(type_id + 1);
+    }
+    if (pools_[type_id] == nullptr) {
+      pools_[type_id] = std::make_unique<Pool<T>>();
+    }
+    return static_cast<Pool<T>&>(*pools_[type_id]);
+  }
+
+  /// @brief Calls a function for every entity that has a component in all the given pools. See ForEach.
+  /// @tparam T The types of the components.
+  /// @param func The function to call with each entity and its components.
+  /// @param pools The pool of each component type. Can be null if no component of the type was ever added.
+  template <typename... T>
+  void ForEachIn(FunctionRef<void(Entity, T&...)> func, Pool<T>*... pools) {
+    if (((pools == nullptr) || ...)) {
+      return;
+    }
+
+    if constexpr (sizeof...(T) == 1) {
+      // A single pool is walked in order, without any lookup.
+      auto walk = [&func](auto* pool) -> void {
+        for (size_t i = 0; i < pool->entities.size(); ++i) {
+          func(pool->entities[i], pool->components[i]);
+        }
+      };
+      (walk(pools), ...);
+    } else {
+      const PoolBase* smallest = nullptr;
+      ((smallest = (smallest == nullptr ||
+                    pools->entities.size() < smallest->entities.size())
+                       ? pools
+                       : smallest),
+       ...);
+      for (Entity entity : smallest->entities) {
+        if ((pools->Contains(entity.index) && ...)) {
+          func(entity, *pools->Find(entity.index)...);
+        }
+      }
+    }
+  }
+
+  // The pool of each component type, indexed by TypeId. Null for types that are not components.
+  std::vector<std::unique_ptr<PoolBase>> pools_;
+  // The generation of each entity slot, bumped every time the slot is freed.
+  std::vector<uint32_t> generations_;
+  // The freed entity slots, reused before new ones.
+  std::vector<uint32_t> free_indices_;
+};
+
+}  // namespace ng
@@ -0,0 +1,422 @@
+#include "dynamic_aabb_tree.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "broadphase.h"
+#include "collision_filter.h"
+
+namespace ng {
+
+namespace {
+
+// Enough slack for around 0.5 s of movement at the player's speed.
+constexpr float kDefaultMargin = 4.F;
+// A balanced tree of a billion leaves is about 45 levels deep.
+constexpr size_t kMaxQueryStackSize = 256;
+
+sf::FloatRect Union(const sf::FloatRect& a, const sf::FloatRect& b) {
+  sf::Vector2f min(std::min(a.position.x, b.position.x),
+                   std::min(a.position.y, b.position.y));
+  sf::Vector2f max(std::max(a.position.x + a.size.x, b.position.x + b.size.x),
+                   std::max(a.position.y + a.size.y, b.position.y + b.size.y));
+  return {min, max - min};
+}
+
+float Perimeter(const sf::FloatRect& rect) {
+  return 2 * (rect.size.x + rect.size.y);
+}
+
+bool Contains(const sf::FloatRect& outer, const sf::FloatRect& inner) {
+  return outer.position.x <= inner.position.x &&
+         outer.position.y <= inner.position.y &&
+         inner.position.x + inner.size.x <= outer.position.x + outer.size.x &&
+         inner.position.y + inner.size.y <= outer.position.y + outer.size.y;
+}
+
+}  // namespace
+
+DynamicAabbTree::DynamicAabbTree() : DynamicAabbTree(kDefaultMargin) {}
+
+DynamicAabbTree::DynamicAabbTree(float margin) : margin_(margin) {
+  assert(margin_ >= 0);
+}
+
+int32_t DynamicAabbTree::GetHeight() const {
+  if (root_ == kNull) {
+    return 0;
+  }
+
+  return nodes_[root_].height + 1;
+}
+
+void DynamicAabbTree::Insert(ColliderId id, sf::FloatRect bounds,
+                             CollisionFilter filter) {
+  if (id >= leaves_.size()) {
+    leaves_.resize(id + 1, kNull);
+  }
+  assert(leaves_[id] == kNull);
+  int32_t leaf = AllocateNode();
+  nodes_[leaf].bounds = Fatten(bounds);
+  nodes_[leaf].id = id;
+  nodes_[leaf].filter = filter;
+  nodes_[leaf].categories = filter.category;
+  nodes_[leaf].height = 0;
+
+  leaves_[id] = leaf;
+  InsertLeaf(leaf);
+}
+
+void DynamicAabbTree::Update(ColliderId id, sf::FloatRect bounds) {
+  assert(id < leaves_.size() && leaves_[id] != kNull);
+  int32_t leaf = leaves_[id];
+  // Small movements stay within the fattened bounding box and leave the
+  // tree untouched.
+  if (Contains(nodes_[leaf].bounds, bounds)) {
+    return;
+  }
+
+  RemoveLeaf(leaf);
+  nodes_[leaf].bounds = Fatten(bounds);
+  InsertLeaf(leaf);
+}
+
+void DynamicAabbTree::Remove(ColliderId id) {
+  if (id >= leaves_.size() || leaves_[id] == kNull) {
+    return;
+  }
+
+  RemoveLeaf(leaves_[id]);
+  FreeNode(leaves_[id]);
+  leaves_[id] = kNull;
+}
+
+void DynamicAabbTree::Query(sf::FloatRect bounds, CollisionFilter filter,
+                            std::vector<ColliderId>& candidates) const {
+  if (root_ == kNull) {
+    return;
+  }
+
+  std::array<int32_t, kMaxQueryStackSize> stack{};
+  size_t stack_size = 0;
+  stack[stack_size++] = root_;
+  while (stack_size > 0) {
+    const TreeNode& node = nodes_[stack[--stack_size]];
+    if ((node.categories & filter.mask) == 0 ||
+        !Overlaps(node.bounds, bounds)) {
+      continue;
+    }
+
+    if (node.IsLeaf()) {
+      if (filter.CanCollide(node.filter)) {
+        candidates.push_back(node.id);
+      }
+    } else {
+      assert(stack_size + 2 <= kMaxQueryStackSize);
+      stack[stack_size++] = node.left;
+      stack[stack_size++] = node.right;
+    }
+  }
+}
+
+void DynamicAabbTree::QueryCast(
+    sf::FloatRect bounds, sf::Vector2f displacement, CollisionFilter filter,
+    std::vector<ColliderId>& candidates) const {
+  if (root_ == kNull) {
+    return;
+  }
+
+  std::array<int32_t, kMaxQueryStackSize> stack{};
+  size_t stack_size = 0;
+  stack[stack_size++] = root_;
+  while (stack_size > 0) {
+    const TreeNode& node = nodes_[stack[--stack_size]];
+    if ((node.categories & filter.mask) == 0 ||
+        !CastOverlaps(bounds, displacement, node.bounds)) {
+      continue;
+    }
+
+    if (node.IsLeaf()) {
+      if (filter.CanCollide(node.filter)) {
+        candidates.push_back(node.id);
+      }
+    } else {
+      assert(stack_size + 2 <= kMaxQueryStackSize);
+      stack[stack_size++] = node.left;
+      stack[stack_size++] = node.right;
+    }
+  }
+}
+
+void DynamicAabbTree::QueryPairs(std::vector<ColliderPair>& pairs) const {
+  std::array<int32_t, kMaxQueryStackSize> stack{};
+  for (int32_t leaf : leaves_) {
+    if (leaf == kNull) {
+      continue;
+    }
+
+    ColliderId id = nodes_[leaf].id;
+    const sf::FloatRect& bounds = nodes_[leaf].bounds;
+    const CollisionFilter& filter = nodes_[leaf].filter;
+    size_t stack_size = 0;
+    stack[stack_size++] = root_;
+    while (stack_size > 0) {
+      const TreeNode& node = nodes_[stack[--stack_size]];
+      if ((node.categories & filter.mask) == 0 ||
+          !Overlaps(node.bounds, bounds)) {
+        continue;
+      }
+
+      if (node.IsLeaf()) {
+        // Each pair is found from both of its leaves, keep only one.
+        if (id < node.id && filter.CanCollide(node.filter)) {
+          pairs.push_back({id, node.id});
+        }
+      } else {
+        assert(stack_size + 2 <= kMaxQueryStackSize);
+        stack[stack_size++] = node.left;
+        stack[stack_size++] = node.right;
+      }
+    }
+  }
+}
+
+int32_t DynamicAabbTree::AllocateNode() {
+  if (free_list_ == kNull) {
+    nodes_.emplace_back();
+    return static_cast<int32_t>(nodes_.size() - 1);
+  }
+
+  int32_t index = free_list_;
+  free_list_ = nodes_[index].parent;
+  nodes_[index] = TreeNode{};
+  return index;
+}
+
+void DynamicAabbTree::FreeNode(int32_t index) {
+  nodes_[index] = TreeNode{};
+  nodes_[index].parent = free_list_;
+  free_list_ = index;
+}
+
+void DynamicAabbTree::InsertLeaf(int32_t leaf) {
+  if (root_ == kNull) {
+    root_ = leaf;
+    nodes_[leaf].parent = kNull;
+    return;
+  }
+
+  // Descend towards the sibling that minimizes the total perimeter of the
+  // tree, accounting for the growth inherited by the ancestors.
+  sf::FloatRect leaf_bounds = nodes_[leaf].bounds;
+  int32_t index = root_;
+  while (!nodes_[index].IsLeaf()) {
+    const TreeNode& node = nodes_[index];
+    float perimeter = Perimeter(node.bounds);
+    float combined_perimeter = Perimeter(Union(node.bounds, leaf_bounds));
+
+    // The cost of creating a new parent for this node and the leaf.
+    float cost = 2 * combined_perimeter;
+    // The minimum cost of pushing the leaf further down the tree.
+    float inheritance_cost = 2 * (combined_perimeter - perimeter);
+
+    auto descend_cost = [&](int32_t child_index) -> float {
+      const TreeNode& child = nodes_[child_index];
+      float child_cost = Perimeter(Union(child.bounds, leaf_bounds));
+      if (!child.IsLeaf()) {
+        child_cost -= Perimeter(child.bounds);
+      }
+      return child_cost + inheritance_cost;
+    };
+
+    float left_cost = descend_cost(node.left);
+    float right_cost = descend_cost(node.right);
+    if (cost < left_cost && cost < right_cost) {
+      break;
+    }
+
+    index = left_cost < right_cost ? node.left : node.right;
+  }
+
+  int32_t sibling = index;
+  int32_t old_parent = nodes_[sibling].parent;
+  int32_t new_parent = AllocateNode();
+  nodes_[new_parent].parent = old_parent;
+  nodes_[new_parent].bounds = Union(leaf_bounds, nodes_[sibling].bounds);
+  nodes_[new_parent].categories =
+      nodes_[leaf].categories | nodes_[sibling].categories;
+  nodes_[new_parent].height = nodes_[sibling].height + 1;
+  nodes_[new_parent].left = sibling;
+  nodes_[new_parent].right = leaf;
+  nodes_[sibling].parent = new_parent;
+  nodes_[leaf].parent = new_parent;
+
+  if (old_parent == kNull) {
+    root_ = new_parent;
+  } else if (nodes_[old_parent].left == sibling) {
+    nodes_[old_parent].left = new_parent;
+  } else {
+    nodes_[old_parent].right = new_parent;
+  }
+
+  RefitAncestors(new_parent);
+}
+
+void DynamicAabbTree::RemoveLeaf(int32_t leaf) {
+  if (leaf == root_) {
+    root_ = kNull;
+    return;
+  }
+
+  int32_t parent = nodes_[leaf].parent;
+  int32_t grand_parent = nodes_[parent].parent;
+  int32_t sibling = nodes_[parent].left == leaf ? nodes_[parent].right
+                                                : nodes_[parent].left;
+
+  // The parent is replaced by the sibling.
+  nodes_[sibling].parent = grand_parent;
+  FreeNode(parent);
+  if (grand_parent == kNull) {
+    root_ = sibling;
+    return;
+  }
+
+  if (nodes_[grand_parent].left == parent) {
+    nodes_[grand_parent].left = sibling;
+  } else {
+    nodes_[grand_parent].right = sibling;
+  }
+
+  RefitAncestors(grand_parent);
+}
+
+void DynamicAabbTree::RefitAncestors(int32_t index) {
+  while (index != kNull) {
+    index = Balance(index);
+
+    TreeNode& node = nodes_[index];
+    const TreeNode& left = nodes_[node.left];
+    const TreeNode& right = nodes_[node.right];
+    node.height = 1 + std::max(left.height, right.height);
+    node.bounds = Union(left.bounds, right.bounds);
+    node.categories = left.categories | right.categories;
+
+    index = node.parent;
+  }
+}
+
+int32_t DynamicAabbTree::Balance(int32_t index) {
+  TreeNode& a = nodes_[index];
+  if (a.IsLeaf() || a.height < 2) {
+    return index;
+  }
+
+  int32_t b_index = a.left;
+  int32_t c_index = a.right;
+  TreeNode& b = nodes_[b_index];
+  TreeNode& c = nodes_[c_index];
+
+  int32_t balance = c.height - b.height;
+  if (balance > 1) {
+    // Rotate the right child up.
+    int32_t f_index = c.left;
+    int32_t g_index = c.right;
+    TreeNode& f = nodes_[f_index];
+    TreeNode& g = nodes_[g_index];
+
+    c.left = index;
+    c.parent = a.parent;
+    a.parent = c_index;
+    if (c.parent == kNull) {
+      root_ = c_index;
+    } else if (nodes_[c.parent].left == index) {
+      nodes_[c.parent].left = c_index;
+    } else {
+      nodes_[c.parent].right = c_index;
+    }
+
+    // The taller grandchild stays under the new subtree root.
+    if (f.height > g.height) {
+      c.right = f_index;
+      a.right = g_index;
+      g.parent = index;
+      a.bounds = Union(b.bounds, g.bounds);
+      a.categories = b.categories | g.categories;
+      c.bounds = Union(a.bounds, f.bounds);
+      c.categories = a.categories | f.categories;
+      a.height = 1 + std::max(b.height, g.height);
+      c.height = 1 + std::max(a.height, f.height);
+    } else {
+      c.right = g_index;
+      a.right = f_index;
+      f.parent = index;
+      a.bounds = Union(b.bounds, f.bounds);
+      a.categories = b.categories | f.categories;
+      c.bounds = Union(a.bounds, g.bounds);
+      c.categories = a.categories | g.categories;
+      a.height = 1 + std::max(b.height, f.height);
+      c.height = 1 + std::max(a.height, g.height);
+    }
+
+    return c_index;
+  }
+
+  if (balance < -1) {
+    // Rotate the left child up.
+    int32_t d_index = b.left;
+    int32_t e_index = b.right;
+    TreeNode& d = nodes_[d_index];
+    TreeNode& e = nodes_[e_index];
+
+    b.left = index;
+    b.parent = a.parent;
+    a.parent = b_index;
+    if (b.parent == kNull) {
+      root_ = b_index;
+    } else if (nodes_[b.parent].left == index) {
+      nodes_[b.parent].left = b_index;
+    } else {
+      nodes_[b.parent].right = b_index;
+    }
+
+    // The taller grandchild stays under the new subtree root.
+    if (d.height > e.height) {
+      b.right = d_index;
+      a.left = e_index;
+      e.parent = index;
+      a.bounds = Union(c.bounds, e.bounds);
+      a.categories = c.categories | e.categories;
+      b.bounds = Union(a.bounds, d.bounds);
+      b.categories = a.categories | d.categories;
+      a.height = 1 + std::max(c.height, e.height);
+      b.height = 1 + std::max(a.height, d.height);
+    } else {
+      b.right = e_index;
+      a.left = d_index;
+      d.parent = index;
+      a.bounds = Union(c.bounds, d.bounds);
+      a.categories = c.categories | d.categories;
+      b.bounds = Union(a.bounds, e.bounds);
+      b.categories = a.categories | e.categories;
+      a.height = 1 + std::max(c.height, d.height);
+      b.height = 1 + std::max(a.height, e.height);
+    }
+
+    return b_index;
+  }
+
+  return index;
+}
+
+sf::FloatRect DynamicAabbTree::Fatten(sf::FloatRect bounds) const {
+  return {bounds.position - sf::Vector2f(margin_, margin_),
+          bounds.size + sf::Vector2f(2 * margin_, 2 * margin_)};
+}
+
+}  // namespace ng
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "broadphase.h"
+#include "collision_filter.h"
+
+namespace ng {
+
+/// @brief A broadphase that stores colliders in a dynamic bounding volume hierarchy.
+///        Leaves hold fattened bounding boxes, so small movements do not touch the tree, and the tree is kept balanced with rotations. Queries test the fattened boxes, so they may also return colliders that are only near the queried bounds.
+///        Handles colliders of very different sizes well.
+class DynamicAabbTree : public Broadphase {
+ public:
+  /// @brief Constructs a DynamicAabbTree with the default fattening margin.
+  DynamicAabbTree();
+
+  /// @brief Constructs a DynamicAabbTree with the specified fattening margin.
+  /// @param margin The distance each leaf bounding box is expanded by on every side. Must not be negative.
+  explicit DynamicAabbTree(float margin);
+
+  /// @brief Returns the height of the tree. An empty tree has a height of 0.
+  /// @return The number of levels in the tree.
+  [[nodiscard]] int32_t GetHeight() const;
+
+  void Insert(ColliderId id, sf::FloatRect bounds,
+              CollisionFilter filter) override;
+  void Update(ColliderId id, sf::FloatRect bounds) override;
+  void Remove(ColliderId id) override;
+  void Query(sf::FloatRect bounds, CollisionFilter filter,
+             std::vector<ColliderId>& candidates) const override;
+  void QueryCast(sf::FloatRect bounds, sf::Vector2f displacement,
+                 CollisionFilter filter,
+                 std::vector<ColliderId>& candidates) const override;
+  void QueryPairs(std::vector<ColliderPair>& pairs) const override;
+
+ private:
+  /// @brief Marks the absence of a node.
+  static constexpr int32_t kNull = -1;
+
+  /// @brief A node of the tree. Leaves reference a collider, internal nodes always have two children.
+  struct TreeNode {
+    /// @brief Checks if the node is a leaf.
+    /// @return True if the node has no children, false otherwise.
+    [[nodiscard]] bool IsLeaf() const { return left == kNull; }
+
+    // The bounding box enclosing the node and all of its descendants. Fattened for leaves.
+    sf::FloatRect bounds;
+    // The id of the collider referenced by the node. Unused for internal nodes.
+    ColliderId id = 0;
+    // The collision filter of the collider. Unused for internal nodes.
+    CollisionFilter filter;
+    // The union of the categories of all the leaves in the subtree, used to skip subtrees that cannot match a query.
+    uint32_t categories = 0;
+    // The parent node, or the next free node when the node is unused.
+    int32_t parent = kNull;
+    // The child nodes. kNull for leaves.
+    int32_t left = kNull;
+    int32_t right = kNull;
+    // The height of the subtree rooted at this node. 0 for leaves, -1 for unused nodes.
+    int32_t height = -1;
+  };
+
+  /// @brief Takes a node from the free list, growing the pool if needed.
+  /// @return The index of the allocated node.
+  int32_t AllocateNode();
+
+  /// @brief Returns a node to the free list.
+  /// @param index The index of the node to free.
+  void FreeNode(int32_t index);
+
+  /// @brief Links a leaf into the tree, choosing the sibling that minimizes the total perimeter.
+  /// @param leaf The index of the leaf to insert.
+  void InsertLeaf(int32_t leaf);
+
+  /// @brief Unlinks a leaf from the tree without freeing it.
+  /// @param leaf The index of the leaf to remove.
+  void RemoveLeaf(int32_t leaf);
+
+  /// @brief Walks from a node up to the root, refitting bounding boxes and heights and rebalancing along the way.
+  /// @param index The index of the first node to refit.
+  void RefitAncestors(int32_t index);
+
+  /// @brief Performs a left or right rotation if the subtree rooted at the given node is unbalanced.
+  /// @param index The index of the subtree root.
+  /// @return The index of the new subtree root.
+  int32_t Balance(int32_t index);
+
+  /// @brief Expands a bounding box by the fattening margin on every side.
+  /// @param bounds The bounding box to fatten.
+  /// @return The fattened bounding box.
+  [[nodiscard]] sf::FloatRect Fatten(sf::FloatRect bounds) const;
+
+  // The distance each leaf bounding box is expanded by on every side.
+  float margin_ = 0;
+  // The pool of tree nodes. Unused nodes are chained in a free list.
+  std::vector<TreeNode> nodes_;
+  // The index of the root node, or kNull if the tree is empty.
+  int32_t root_ = kNull;
+  // The index of the first unused node, or kNull if the pool is full.
+  int32_t free_list_ = kNull;
+  // The leaf of each collider in the tree, indexed by its id. kNull for ids that are not in the tree.
+  std::vector<int32_t> leaves_;
+};
+
+}  // namespace ng
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+namespace ng {
+
+/// @brief Identifies an entity of a ComponentStore. An entity is only an id, its data lives in the component pools of the store.
+///        The slot of a destroyed entity is reused with a new generation, so stale ids are recognized instead of reaching the new entity.
+struct Entity {
+  bool operator==(const Entity& other) const = default;
+
+  // The slot of the entity in its store.
+  uint32_t index = std::numeric_limits<uint32_t>::max();
+  // The number of times the slot was reused before this entity.
+  uint32_t generation = 0;
+};
+
+/// @brief An id that never refers to an entity.
+inline constexpr Entity kNoEntity;
+
+}  // namespace ng
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace ng {
+
+template <typename TSignature>
+class FunctionRef;
+
+/// @brief A non-owning reference to a callable object. Unlike std::function, it never allocates, so it is cheap to pass to functions called every tick.
+///        The referenced callable must outlive the FunctionRef, so it should only be used for function parameters.
+/// @tparam TReturn The return type of the callable.
+/// @tparam TArgs The argument types of the callable.
+template <typename TReturn, typename... TArgs>
+class FunctionRef<TReturn(TArgs...)> {
+ public:
+  /// @brief Constructs a FunctionRef referencing a callable object.
+  /// @tparam TCallable The type of the callable object.
+  /// @param callable The callable object to reference. It must outlive the FunctionRef.
+  template <typename TCallable>
+    requires(!std::same_as<std::remove_cvref_t<TCallable>, FunctionRef> &&
+             std::is_invocable_r_v<TReturn, TCallable&, TArgs...>)
+  FunctionRef(TCallable&& callable)  // NOLINT(google-explicit-constructor)
+      : callable_(const_cast<void*>(
+            static_cast<const void*>(std::addressof(callable)))),
+        invoke_([](void* callable, TArgs... args) -> TReturn {
+          return std::invoke(
+              *static_cast<std::add_pointer_t<TCallable>>(callable),
+              std::forward<TArgs>(args)...);
+        }) {}
+
+  /// @brief Calls the referenced callable object.
+  /// @param args The arguments to forward to the callable.
+  /// @return The value returned by the callable.
+  TReturn operator()(TArgs... args) const {
+    return invoke_(callable_, std::forward<TArgs>(args)...);
+  }
+
+ private:
+  // The referenced callable object. Only cast back to its original type.
+  void* callable_ = nullptr;
+  // Casts callable_ back to its original type and calls it.
+  TReturn (*invoke_)(void*, TArgs...) = nullptr;
+};
+
+}  // namespace ng
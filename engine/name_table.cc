@@ -0,0 +1,31 @@
+#include "name_table.h"
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace ng {
+
+NameId NameTable::Intern(std::string_view name) {
+  NameId name_id = HashName(name);
+  if (name_id == kNoName) {
+    return kNoName;
+  }
+
+  auto [it, inserted] = strings_.try_emplace(name_id, name);
+  if (!inserted && it->second != name) {
+    throw std::invalid_argument(
+        "The name has the same id as another interned name");
+  }
+  return name_id;
+}
+
+std::string_view NameTable::GetString(NameId name_id) const {
+  auto it = strings_.find(name_id);
+  if (it == strings_.end()) {
+    return {};
+  }
+  return it->second;
+}
+
+}  // namespace ng
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ng {
+
+/// @brief Identifies an interned name. Two names are equal if and only if their ids are, so comparing names is a single integer compare.
+using NameId = uint32_t;
+
+/// @brief The id of the empty name.
+inline constexpr NameId kNoName = 0;
+
+/// @brief Hashes a name into its id. Usable at compile time, so ids of known names can be precomputed as constants.
+/// @param name The name to hash.
+/// @return The 32-bit FNV-1a hash of the name, kNoName for the empty name and never kNoName otherwise.
+[[nodiscard]] constexpr NameId HashName(std::string_view name) {
+  if (name.empty()) {
+    return kNoName;
+  }
+
+  NameId hash = 2166136261U;
+  for (char c : name) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619U;
+  }
+  // Keeps kNoName for the empty name only.
+  return hash == kNoName ? 1U : hash;
+}
+
+/// @brief Stores the text of every interned name once, so names can be passed around as ids and turned back into text when needed (e.g. for debugging).
+class NameTable {
+ public:
+  /// @brief Interns a name, storing its text if it was not interned yet.
+  ///        Throws std::invalid_argument if a different name with the same id was interned before, so two names never share an id.
+  /// @param name The name to intern.
+  /// @return The id of the name, equal to HashName(name).
+  NameId Intern(std::string_view name);
+
+  /// @brief Returns the text of an interned name.
+  /// @param name_id The id of the name.
+  /// @return The text of the name, or an empty view if the id was never interned (e.g. it was only hashed at compile time).
+  [[nodiscard]] std::string_view GetString(NameId name_id) const;
+
+ private:
+  // The text of each interned name.
+  std::unordered_map<NameId, std::string> strings_;
+};
+
+}  // namespace ng
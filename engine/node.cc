@@ -5,32 +5,126 @@
 #include <SFML/Graphics/Transformable.hpp>
 #include <SFML/System/Angle.hpp>
 #include <SFML/System/Vector2.hpp>
-#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
-#include <functional>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
 #include <span>
-#include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
+#include "app.h"
+#include "component_store.h"
+#include "entity.h"
 #include "layer.h"
+#include "name_table.h"
+#include "node_arena.h"
+#include "node_slot_table.h"
 #include "scene.h"
+#include "type_id.h"
 
 namespace ng {
 
-Node::Node(App* app) : app_(app) {
+namespace {
+
+// The arena of the node whose constructor is running on this thread, if it
+// was created by MakeChild in an arena.
+thread_local NodeArena* constructing_arena = nullptr;
+
+}  // namespace
+
+thread_local std::vector<Node::DeferredChange>* Node::deferred_changes_ =
+    nullptr;
+thread_local Scene* Node::parallel_scene_ = nullptr;
+
+Node::Node(App* app) : app_(app), arena_(constructing_arena) {
   assert(app);
+  // The slot table is shared by every node of the App.
+  std::unique_lock<std::recursive_mutex> lock = LockParallelScene();
+  slot_index_ = app_->node_slots_.Acquire(this);
+}
+
+Node::~Node() {
+  if (slot_index_ != NodeSlotTable::kNoSlot) {
+    std::unique_lock<std::recursive_mutex> lock = LockParallelScene();
+    app_->node_slots_.Release(slot_index_);
+  }
+}
+
+void* Node::operator new(size_t size) {
+  return ::operator new(size);
+}
+
+void* Node::operator new(size_t size, std::align_val_t alignment) {
+  return ::operator new(size, alignment);
+}
+
+void Node::operator delete(void* memory) {
+  ::operator delete(memory);
 }
 
-const std::string& Node::GetName() const {
+void Node::operator delete(void* memory, std::align_val_t alignment) {
+  ::operator delete(memory, alignment);
+}
+
+void Node::operator delete(Node* node, std::destroying_delete_t) {
+  DestroyAndFree(node, std::nullopt);
+}
+
+void Node::operator delete(Node* node, std::destroying_delete_t,
+                           std::align_val_t alignment) {
+  DestroyAndFree(node, alignment);
+}
+
+void Node::DestroyAndFree(Node* node,
+                          std::optional<std::align_val_t> alignment) {
+  NodeArena* arena = node->arena_;
+  size_t allocation_size = node->allocation_size_;
+  // The most derived object may not start where its Node base does.
+  void* memory = dynamic_cast<void*>(node);
+  node->~Node();
+  if (allocation_size != 0) {
+    arena->Deallocate(memory, allocation_size);
+  } else if (alignment.has_value()) {
+    ::operator delete(memory, *alignment);
+  } else {
+    ::operator delete(memory);
+  }
+}
+
+std::string_view Node::GetName() const {
+  return app_->GetNameTable().GetString(name_);
+}
+
+NameId Node::GetNameId() const {
   return name_;
 }
 
-void Node::SetName(std::string name) {
-  name_ = std::move(name);
+void Node::SetName(std::string_view name) {
+  std::unique_lock<std::recursive_mutex> lock = LockSceneSharedState();
+  SetName(app_->GetNameTable().Intern(name));
+}
+
+void Node::SetName(NameId name_id) {
+  std::unique_lock<std::recursive_mutex> lock = LockSceneSharedState();
+  // A registered node moves to the index entry of its new name.
+  bool is_indexed = name_index_ != kNotInNameIndex;
+  if (is_indexed) {
+    scene_->UnindexName(this);
+  }
+  name_ = name_id;
+  if (is_indexed) {
+    scene_->IndexName(this);
+  }
+}
+
+TypeId Node::GetTypeId() const {
+  return type_id_;
 }
 
 App* Node::GetApp() const {
@@ -53,19 +147,42 @@ void Node::SetLayer(Layer layer) {
   layer_ = layer;
 }
 
-void Node::AddChild(std::unique_ptr<Node> new_child) {
+void Node::AttachChild(std::unique_ptr<Node> new_child) {
   new_child->parent_ = this;
   new_child->DirtyGlobalTransform();
+  // Parallel updates must not touch the children of nodes outside of their
+  // subtree, so the addition waits for every subtree to be updated.
+  if (deferred_changes_ != nullptr) {
+    deferred_changes_->push_back(
+        {.parent = this,
+         .child_to_add = std::move(new_child),
+         .child_to_destroy = nullptr});
+    return;
+  }
   children_to_add_.push_back(std::move(new_child));
+  QueueChildrenChanges();
 }
 
 void Node::DestroyChild(const Node& child_to_destroy) {
-  for (size_t i = 0; i < children_.size(); ++i) {
-    if (children_[i].get() == &child_to_destroy) {
-      children_to_erase_.push_back(i);
-      break;
-    }
+  if (deferred_changes_ != nullptr) {
+    deferred_changes_->push_back(
+        {.parent = this,
+         .child_to_add = nullptr,
+         .child_to_destroy = &child_to_destroy});
+    return;
+  }
+
+  size_t index = child_to_destroy.index_in_parent_;
+  // Children still waiting to be added are not in children_ yet.
+  if (index >= children_.size() ||
+      children_[index].get() != &child_to_destroy ||
+      children_[index]->is_destruction_scheduled_) {
+    return;
   }
+
+  children_[index]->is_destruction_scheduled_ = true;
+  children_to_erase_.push_back(children_[index].get());
+  QueueChildrenChanges();
 }
 
 void Node::Destroy() {
@@ -74,44 +191,52 @@ void Node::Destroy() {
   }
 }
 
+void Node::SetParallelUpdate(bool enabled) {
+  is_parallel_update_ = enabled;
+  if (scene_ != nullptr) {
+    RefreshParallelRoot();
+  }
+}
+
 const sf::Transformable& Node::GetLocalTransform() const {
   return local_transform_;
 }
 
-const sf::Transformable& Node::GetGlobalTransform() const {
+const sf::Transform& Node::GetGlobalTransform() const {
   if (is_global_transform_dirty_) {
     if (parent_ != nullptr) {
-      sf::Transform new_transform =
-          parent_->GetGlobalTransform().getTransform() *
-          GetLocalTransform().getTransform();
-
-      auto matrix = std::span(new_transform.getMatrix(), 16);
-
-      float a00 = matrix[0];
-      float a01 = matrix[4];
-      float a02 = matrix[12];
-      float a10 = matrix[1];
-      float a11 = matrix[5];
-      float a12 = matrix[13];
-
-      sf::Angle rotation(sf::radians(std::atan2(-a01, a00)));
-      sf::Vector2 scale(std::sqrt((a00 * a00) + (a10 * a10)),
-                        std::sqrt((a01 * a01) + (a11 * a11)));
-      sf::Vector2f position(a02, a12);
-
-      global_transform_.setRotation(rotation);
-      global_transform_.setScale(scale);
-      global_transform_.setPosition(position);
+      global_transform_ = parent_->GetGlobalTransform() *
+                          GetLocalTransform().getTransform();
     } else {
-      global_transform_ = GetLocalTransform();
+      global_transform_ = GetLocalTransform().getTransform();
     }
 
     is_global_transform_dirty_ = false;
+    if (scene_ != nullptr) {
+      scene_->QueueTransformChildren(this);
+    }
   }
 
   return global_transform_;
 }
 
+sf::Vector2f Node::GetGlobalPosition() const {
+  auto matrix = std::span(GetGlobalTransform().getMatrix(), 16);
+  return {matrix[12], matrix[13]};
+}
+
+sf::Angle Node::GetGlobalRotation() const {
+  auto matrix = std::span(GetGlobalTransform().getMatrix(), 16);
+  return sf::radians(std::atan2(matrix[1], matrix[0]));
+}
+
+sf::Vector2f Node::GetGlobalScale() const {
+  auto matrix = std::span(GetGlobalTransform().getMatrix(), 16);
+  // The length of each transformed basis vector.
+  return {std::sqrt((matrix[0] * matrix[0]) + (matrix[1] * matrix[1])),
+          std::sqrt((matrix[4] * matrix[4]) + (matrix[5] * matrix[5]))};
+}
+
 void Node::SetLocalPosition(sf::Vector2f position) {
   local_transform_.setPosition(position);
   DirtyGlobalTransform();
@@ -132,6 +257,10 @@ void Node::Translate(sf::Vector2f delta) {
   DirtyGlobalTransform();
 }
 
+Entity Node::GetEntity() const {
+  return entity_;
+}
+
 void Node::OnAdd() {}
 
 void Node::Update() {}
@@ -140,6 +269,40 @@ void Node::Draw([[maybe_unused]] sf::RenderTarget& target) {}
 
 void Node::OnDestroy() {}
 
+void Node::OnGlobalTransformDirty() {}
+
+void Node::OnCollisionEnter([[maybe_unused]] const Collider& collider,
+                            [[maybe_unused]] const Collider& other) {}
+
+void Node::OnCollisionStay([[maybe_unused]] const Collider& collider,
+                           [[maybe_unused]] const Collider& other) {}
+
+void Node::OnCollisionExit([[maybe_unused]] const Collider& collider,
+                           [[maybe_unused]] const Collider& other) {}
+
+Node::ArenaConstructionScope::ArenaConstructionScope(NodeArena* arena,
+                                                     void* memory, size_t size)
+    : arena_(arena),
+      memory_(memory),
+      size_(size),
+      previous_arena_(std::exchange(constructing_arena, arena)) {
+  assert(arena);
+  assert(memory);
+}
+
+Node::ArenaConstructionScope::~ArenaConstructionScope() {
+  constructing_arena = previous_arena_;
+  // The constructor threw. The node, and any child it made, is already
+  // destroyed.
+  if (memory_ != nullptr) {
+    arena_->Deallocate(memory_, size_);
+  }
+}
+
+void Node::ArenaConstructionScope::Commit() {
+  memory_ = nullptr;
+}
+
 void Node::EraseDestroyedChildren() {
   if (children_to_erase_.empty()) {
     return;
@@ -148,11 +311,26 @@ void Node::EraseDestroyedChildren() {
   // This is required because a newly destroyed child may destroy a new child
   // from its parent (this node), invalidating the current children_to_erase_ vector.
   auto prev_frame_children_to_erase = std::move(children_to_erase_);
-  std::ranges::sort(prev_frame_children_to_erase, std::greater<>());
-  for (size_t to_erase : prev_frame_children_to_erase) {
-    children_[to_erase]->InternalOnDestroy();
-    children_.erase(children_.begin() + static_cast<int64_t>(to_erase));
+  for (Node* to_erase : prev_frame_children_to_erase) {
+    to_erase->InternalOnDestroy();
+    // Marks the child for the compaction below.
+    to_erase->index_in_parent_ = kNotInChildren;
   }
+
+  // A single stable pass keeps the drawing order of the remaining children.
+  size_t kept = 0;
+  for (size_t i = 0; i < children_.size(); ++i) {
+    if (children_[i]->index_in_parent_ == kNotInChildren) {
+      children_[i] = nullptr;
+      continue;
+    }
+    children_[i]->index_in_parent_ = kept;
+    if (i != kept) {
+      children_[kept] = std::move(children_[i]);
+    }
+    ++kept;
+  }
+  children_.resize(kept);
 }
 
 void Node::AddQueuedChildren() {
@@ -161,6 +339,7 @@ void Node::AddQueuedChildren() {
   auto prev_frame_children_to_add = std::move(children_to_add_);
   for (auto& to_add : prev_frame_children_to_add) {
     Node* tmp = to_add.get();
+    tmp->index_in_parent_ = children_.size();
     children_.push_back(std::move(to_add));
     tmp->InternalOnAdd(scene_);
   }
@@ -168,18 +347,51 @@ void Node::AddQueuedChildren() {
 
 void Node::InternalOnAdd(Scene* scene) {
   scene_ = scene;
+  RefreshParallelRoot();
   scene_->RegisterNode(this);
+  // The node was dirtied when it was added, before it knew its scene.
+  if (is_global_transform_dirty_ &&
+      (parent_ == nullptr || !parent_->is_global_transform_dirty_)) {
+    scene_->QueueTransformRoot(this);
+  }
+  // Children queued before the node joined the scene are added by the
+  // current update phase, like the node itself.
+  if (!children_to_add_.empty()) {
+    QueueChildrenChanges();
+  }
   OnAdd();
 }
 
-void Node::InternalUpdate() {
+void Node::InternalApplyQueuedChildren() {
   EraseDestroyedChildren();
   AddQueuedChildren();
+}
 
-  Update();
-  for (auto& child : children_) {
-    child->InternalUpdate();
+void Node::InternalParallelUpdate(
+    std::span<Node* const> nodes,
+    std::vector<DeferredChange>& deferred_changes) {
+  if (nodes.empty()) {
+    return;
+  }
+
+  deferred_changes_ = &deferred_changes;
+  parallel_scene_ = nodes.front()->scene_;
+  for (Node* node : nodes) {
+    node->Update();
   }
+  deferred_changes_ = nullptr;
+  parallel_scene_ = nullptr;
+}
+
+void Node::ApplyDeferredChanges(std::vector<DeferredChange>& deferred_changes) {
+  for (DeferredChange& change : deferred_changes) {
+    if (change.child_to_add != nullptr) {
+      change.parent->AttachChild(std::move(change.child_to_add));
+    } else {
+      change.parent->DestroyChild(*change.child_to_destroy);
+    }
+  }
+  deferred_changes.clear();
 }
 
 void Node::InternalDraw(const Camera& camera, sf::RenderTarget& target) {
@@ -196,10 +408,65 @@ void Node::InternalDraw(const Camera& camera, sf::RenderTarget& target) {
 
 void Node::InternalOnDestroy() {
   scene_->UnregisterNode(this);
+  scene_->UnqueueTransformRoot(this);
+  scene_->UnqueueChildrenChanges(this);
   OnDestroy();
+  // The components outlive OnDestroy, so it can still read them.
+  if (entity_ != kNoEntity) {
+    scene_->GetMutableComponents().DestroyEntity(entity_);
+    entity_ = kNoEntity;
+  }
   for (auto& child : children_) {
     child->InternalOnDestroy();
   }
+  // Handles stop resolving once the node is destroyed, before its memory is
+  // freed.
+  app_->node_slots_.Release(slot_index_);
+  slot_index_ = NodeSlotTable::kNoSlot;
+}
+
+void Node::QueueChildrenChanges() {
+  if (scene_ != nullptr) {
+    scene_->QueueChildrenChanges(this);
+  }
+}
+
+void Node::RefreshParallelRoot() {
+  // Subtrees flagged inside a parallel subtree are part of it.
+  Node* inherited_root = parent_ != nullptr ? parent_->parallel_root_ : nullptr;
+  if (inherited_root != nullptr) {
+    parallel_root_ = inherited_root;
+  } else {
+    parallel_root_ = is_parallel_update_ ? this : nullptr;
+  }
+  for (auto& child : children_) {
+    child->RefreshParallelRoot();
+  }
+}
+
+std::unique_lock<std::recursive_mutex> Node::LockSceneSharedState() const {
+  // Nodes created by a parallel update are not in the scene yet, but one of
+  // their ancestors is.
+  const Node* node = this;
+  while (node != nullptr && node->scene_ == nullptr) {
+    node = node->parent_;
+  }
+  if (node == nullptr) {
+    return {};
+  }
+  return node->scene_->LockSharedState();
+}
+
+std::unique_lock<std::recursive_mutex> Node::LockParallelScene() {
+  if (parallel_scene_ == nullptr) {
+    return {};
+  }
+  return parallel_scene_->LockSharedState();
+}
+
+ComponentStore& Node::GetComponentStore() const {
+  assert(scene_);
+  return scene_->GetMutableComponents();
 }
 
 void Node::DirtyGlobalTransform() {
@@ -208,6 +475,12 @@ void Node::DirtyGlobalTransform() {
   }
 
   is_global_transform_dirty_ = true;
+  // Only the top of a dirty subtree is queued, the pass reaches the rest.
+  if (scene_ != nullptr &&
+      (parent_ == nullptr || !parent_->is_global_transform_dirty_)) {
+    scene_->QueueTransformRoot(this);
+  }
+  OnGlobalTransformDirty();
   for (auto& child : children_) {
     child->DirtyGlobalTransform();
   }
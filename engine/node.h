@@ -1,48 +1,111 @@
 #pragma once
 
 #include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Transform.hpp>
 #include <SFML/Graphics/Transformable.hpp>
 #include <SFML/System/Angle.hpp>
 #include <SFML/System/Vector2.hpp>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
-#include <string>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
 #include <vector>
 
+#include "component_store.h"
 #include "derived.h"
+#include "entity.h"
 #include "layer.h"
+#include "name_table.h"
+#include "node_arena.h"
+#include "node_slot_table.h"
+#include "type_id.h"
 
 namespace ng {
 
 class App;
 class Camera;
+class Collider;
 class Scene;
+template <typename T>
+class NodeHandle;
 
 /// @brief The base class for all entities in the game world, forming a scene graph.
 ///        Manages local and global transformations, parent-child relationships, and rendering layers.
 class Node {
  public:
-  // Scene needs to be able to call InternalOnAdd, InternalUpdate,
-  // InternalDraw, and InternalOnDestroy.
+  // Scene needs to be able to call InternalOnAdd, InternalApplyQueuedChildren,
+  // Update, InternalParallelUpdate, InternalDraw, and InternalOnDestroy.
   friend class Scene;
+  // Physics needs to be able to call OnCollisionEnter, OnCollisionStay, and
+  // OnCollisionExit.
+  friend class Physics;
+  // NodeHandle needs to be able to read the slot of the node.
+  template <typename T>
+  friend class NodeHandle;
 
   /// @brief Constructs a Node associated with a specific App instance.
   /// @param app A pointer to the App instance this node belongs to. This pointer must not be null.
   explicit Node(App* app);
-  virtual ~Node() = default;
+  virtual ~Node();
+
+  /// @brief Allocates a node created with new or std::make_unique on the heap.
+  /// @param size The size of the node.
+  /// @return A pointer to the memory. Never null.
+  static void* operator new(size_t size);
+  /// @brief Allocates an over-aligned node created with new, std::make_unique, or MakeChild on the heap.
+  /// @param size The size of the node.
+  /// @param alignment The alignment of the node's type.
+  /// @return A pointer to the memory. Never null.
+  static void* operator new(size_t size, std::align_val_t alignment);
+  /// @brief Frees the memory of a node whose constructor threw.
+  /// @param memory A pointer returned by operator new(size_t).
+  static void operator delete(void* memory);
+  /// @brief Frees the memory of an over-aligned node whose constructor threw.
+  /// @param memory A pointer returned by operator new(size_t, std::align_val_t).
+  /// @param alignment The alignment the memory was allocated with.
+  static void operator delete(void* memory, std::align_val_t alignment);
+  /// @brief Destroys a node and frees its memory, giving it back to its scene's NodeArena if it was allocated there.
+  /// @param node A pointer to the Node to delete. This pointer must not be null.
+  static void operator delete(Node* node, std::destroying_delete_t);
+  /// @brief Destroys an over-aligned node and frees its memory. The compiler picks this form from the dynamic type of the node, so deleting it through a pointer to any base frees the memory with the alignment it was allocated with.
+  /// @param node A pointer to the Node to delete. This pointer must not be null.
+  /// @param alignment The alignment of the node's dynamic type.
+  static void operator delete(Node* node, std::destroying_delete_t,
+                              std::align_val_t alignment);
 
   Node(const Node& other) = delete;
   Node& operator=(const Node& other) = delete;
   Node(Node&& other) = delete;
   Node& operator=(Node&& other) = delete;
 
-  /// @brief Returns the name of the node.
-  /// @return A constant reference to the node's name.
-  [[nodiscard]] const std::string& GetName() const;
+  /// @brief Returns the name of the node, looked up in the App's NameTable.
+  /// @return The text of the node's name, or an empty view if it was set from an id that was never interned.
+  [[nodiscard]] std::string_view GetName() const;
 
-  /// @brief Sets the name of the node.
+  /// @brief Returns the interned id of the name of the node. Comparing it against another id, such as HashName("Player"), is a single integer compare.
+  /// @return The NameId of the node's name, or kNoName if it has none.
+  [[nodiscard]] NameId GetNameId() const;
+
+  /// @brief Sets the name of the node, interning it in the App's NameTable.
+  ///        Throws std::invalid_argument, keeping the old name, if a different name with the same id was interned before.
   /// @param name The new name for the node.
-  void SetName(std::string name);
+  void SetName(std::string_view name);
+
+  /// @brief Sets the name of the node from a precomputed id, without touching the NameTable.
+  /// @param name_id The id of the new name, usually a HashName constant.
+  void SetName(NameId name_id);
+
+  /// @brief Returns the id of the exact type of the node, recorded when it was created by MakeChild or added by AddChild through a pointer to its exact type.
+  /// @return The TypeId of the node's type, or kNoTypeId if it was not recorded.
+  [[nodiscard]] TypeId GetTypeId() const;
 
   /// @brief Returns the App instance associated with this node.
   /// @return A pointer to the App instance. This pointer is never null after construction.
@@ -65,37 +128,76 @@ class Node {
   void SetLayer(Layer layer);
 
   /// @brief Adds a new child node to this node. Ownership of the child is transferred.
+  ///        If T is the exact type of the child, it is recorded as with MakeChild, see GetTypeId. A child held through a pointer to one of its base classes keeps kNoTypeId.
+  /// @tparam T The static type of the child, must derive from Node.
   /// @param new_child A unique pointer to the Node to be added. This pointer must not be null.
-  void AddChild(std::unique_ptr<Node> new_child);
+  template <Derived<Node> T>
+  void AddChild(std::unique_ptr<T> new_child) {
+    assert(new_child);
+    // Final types need no RTTI to know that T is the exact type.
+    if (std::is_final_v<T> || typeid(*new_child) == typeid(T)) {
+      new_child->type_id_ = TypeIdOf<T>();
+      new_child->has_update_ = OverridesUpdate<T>();
+    }
+    AttachChild(std::move(new_child));
+  }
 
-  /// @brief Creates and adds a new child node of the specified type to this node.
+  /// @brief Creates and adds a new child node of the specified type to this node. The type of the child is recorded, see GetTypeId.
+  ///        The child is allocated from the NodeArena of the scene the node was created in, if any, as are the nodes created by its constructor. Over-aligned children are allocated on the heap.
   /// @tparam T The type of the Node to create, must derive from Node.
   /// @tparam Args The constructor arguments for the Node type T.
   /// @param args The arguments to forward to the constructor of T.
   /// @return A reference to the newly created and added Node.
   template <Derived<Node> T, typename... Args>
   T& MakeChild(Args&&... args) {
-    auto child = std::make_unique<T>(app_, std::forward<Args>(args)...);
+    std::unique_ptr<T> child;
+    {
+      // Constructors may touch state shared by the whole scene and App.
+      std::unique_lock<std::recursive_mutex> lock = LockSceneSharedState();
+      child = NewNode<T>(std::forward<Args>(args)...);
+    }
     T& ref = *child;
-    AddChild(std::move(child));
+    // Only MakeChild knows the exact type of the node.
+    child->type_id_ = TypeIdOf<T>();
+    child->has_update_ = OverridesUpdate<T>();
+    AttachChild(std::move(child));
     return ref;
   }
 
-  /// @brief Schedules a child node for destruction. The actual removal happens at the beginning of the next frame.
+  /// @brief Schedules a child node for destruction in constant time. The actual removal happens at the beginning of the next frame, in a single pass over the children.
+  ///        No-op if the node is not a child of this node yet or is already scheduled.
   /// @param child_to_destroy A constant reference to the child Node to be destroyed.
   void DestroyChild(const Node& child_to_destroy);
 
   /// @brief Schedules this node for destruction. The actual removal happens at the beginning of the next frame by its parent.
   void Destroy();
 
+  /// @brief Marks the subtree of this node as independent, so the scene can update it at the same time as the other independent subtrees. Only used when the scene has a thread pool, see Scene::SetThreadPool.
+  ///        Independent subtrees are updated after the rest of the tree. They may freely change and move their own nodes, create nodes with MakeChild, and destroy nodes; additions and destructions are applied once every subtree is updated, in the same order whatever the number of threads.
+  ///        Anything shared with the rest of the scene, such as physics queries, components, or other nodes, must be accessed under Scene::LockSharedState.
+  /// @param enabled True to update the subtree in parallel, false to update it in tree order (default).
+  void SetParallelUpdate(bool enabled);
+
   /// @brief Returns the local transformation of this node.
   /// @return A constant reference to the local SFML Transformable.
   [[nodiscard]] const sf::Transformable& GetLocalTransform() const;
 
-  /// @brief Returns the global transformation of this node, taking into account its parent's transformations.
-  ///        This is calculated lazily and cached until the local transform changes.
-  /// @return A constant reference to the global SFML Transformable.
-  [[nodiscard]] const sf::Transformable& GetGlobalTransform() const;
+  /// @brief Returns the global transformation matrix of this node, taking into account its parent's transformations.
+  ///        This is calculated lazily and cached until the local transform of the node or of one of its ancestors changes.
+  /// @return A constant reference to the global SFML Transform.
+  [[nodiscard]] const sf::Transform& GetGlobalTransform() const;
+
+  /// @brief Returns the world-space position of this node, read from its global transform.
+  /// @return The global position.
+  [[nodiscard]] sf::Vector2f GetGlobalPosition() const;
+
+  /// @brief Returns the world-space rotation of this node, derived from its global transform when called.
+  /// @return The global rotation.
+  [[nodiscard]] sf::Angle GetGlobalRotation() const;
+
+  /// @brief Returns the world-space scale of this node, derived from its global transform when called. Both components are positive, mirroring cannot be told apart from a rotation.
+  /// @return The global scale.
+  [[nodiscard]] sf::Vector2f GetGlobalScale() const;
 
   /// @brief Sets the local position of the node.
   /// @param position The new local position.
@@ -113,11 +215,68 @@ class Node {
   /// @param delta The translation vector.
   void Translate(sf::Vector2f delta);
 
-  /// @brief Returns the first child node of a specific type.
-  /// @tparam T The type of the child Node to retrieve, must derive from Node.
+  /// @brief Returns the entity holding the components of this node in its scene's ComponentStore.
+  /// @return The entity of the node, or kNoEntity if no component was ever added to it.
+  [[nodiscard]] Entity GetEntity() const;
+
+  /// @brief Adds a component to this node, stored in the packed arrays of its scene's ComponentStore. The node must be part of a scene and must not have a component of this type already.
+  ///        The components are destroyed with the node.
+  /// @tparam T The type of the component.
+  /// @tparam Args The constructor arguments for T.
+  /// @param args The arguments to forward to the constructor of T.
+  /// @return A reference to the new component, valid until the next structural change of T in the store.
+  template <typename T, typename... Args>
+  T& AddComponent(Args&&... args) {
+    ComponentStore& components = GetComponentStore();
+    if (!components.IsAlive(entity_)) {
+      entity_ = components.CreateEntity();
+    }
+    return components.Add<T>(entity_, std::forward<Args>(args)...);
+  }
+
+  /// @brief Returns a component of this node.
+  /// @tparam T The type of the component.
+  /// @return A pointer to the component, or nullptr if the node has no component of this type.
+  template <typename T>
+  [[nodiscard]] T* GetComponent() const {
+    if (scene_ == nullptr) {
+      return nullptr;
+    }
+    return GetComponentStore().Get<T>(entity_);
+  }
+
+  /// @brief Removes a component from this node. No-op if the node has no component of this type.
+  /// @tparam T The type of the component.
+  template <typename T>
+  void RemoveComponent() {
+    if (scene_ != nullptr) {
+      GetComponentStore().Remove<T>(entity_);
+    }
+  }
+
+  /// @brief Returns the first child node whose exact type is T, like Scene::FindFirst. Only children whose type is recorded are known by type, see GetTypeId, and subclasses of T do not match; see GetChildDynamicCast.
+  ///        This is a behaviour change: GetChild used to dynamic_cast every child, so it also matched subclasses and children of unknown type. Abstract types, which no node has as its exact type, are rejected at compile time.
+  /// @tparam T The type of the child Node to retrieve, must derive from Node and must not be abstract.
   /// @return A pointer to the first child of type T, or nullptr if no such child exists.
   template <Derived<Node> T>
   [[nodiscard]] T* GetChild() {
+    static_assert(!std::is_abstract_v<T>,
+                  "GetChild matches the exact type only, so it never finds an "
+                  "abstract type: use GetChildDynamicCast");
+    TypeId type_id = TypeIdOf<T>();
+    for (const auto& child : children_) {
+      if (child->type_id_ == type_id) {
+        return static_cast<T*>(child.get());
+      }
+    }
+    return nullptr;
+  }
+
+  /// @brief Returns the first child node that is a T or a subclass of T, whether or not its type is recorded. Uses a dynamic_cast per child, so prefer GetChild when the exact type is known.
+  /// @tparam T The type of the child Node to retrieve, must derive from Node.
+  /// @return A pointer to the first child convertible to T, or nullptr if no such child exists.
+  template <Derived<Node> T>
+  [[nodiscard]] T* GetChildDynamicCast() {
     for (const auto& child : children_) {
       T* c = dynamic_cast<T*>(child.get());
       if (c != nullptr) {
@@ -130,25 +289,142 @@ class Node {
  protected:
   /// @brief Called when the node is added to a scene graph.
   virtual void OnAdd();
-  /// @brief Called during the update phase of the game loop.
+  /// @brief Called during the update phase of the game loop, in hierarchy order. Nodes created with MakeChild whose type does not override it are never called.
   virtual void Update();
   /// @brief Called during the draw phase of the game loop.
   /// @param target The SFML RenderTarget to draw to.
   virtual void Draw(sf::RenderTarget& target);
   /// @brief Called when the node is about to be destroyed or removed from the scene graph.
   virtual void OnDestroy();
+  /// @brief Called when the global transform of the node is invalidated, either by a local change or by a change of one of its ancestors.
+  virtual void OnGlobalTransformDirty();
+  /// @brief Called by the physics step when one of the node's child colliders starts overlapping another collider.
+  /// @param collider The child Collider of this node.
+  /// @param other The Collider it overlaps with.
+  virtual void OnCollisionEnter(const Collider& collider, const Collider& other);
+  /// @brief Called by every following physics step while one of the node's child colliders keeps overlapping another collider.
+  /// @param collider The child Collider of this node.
+  /// @param other The Collider it overlaps with.
+  virtual void OnCollisionStay(const Collider& collider, const Collider& other);
+  /// @brief Called by the physics step when one of the node's child colliders stops overlapping another collider.
+  ///        Not called when either collider is removed from the scene.
+  /// @param collider The child Collider of this node.
+  /// @param other The Collider it no longer overlaps with.
+  virtual void OnCollisionExit(const Collider& collider, const Collider& other);
 
  private:
-  /// @brief Removes children that were scheduled for destruction in the previous frame.
+  /// @brief The transform root index of a node that is not queued by its scene.
+  static constexpr size_t kNotQueued = std::numeric_limits<size_t>::max();
+  /// @brief The name index of a node that is not in its scene's name index.
+  static constexpr uint32_t kNotInNameIndex =
+      std::numeric_limits<uint32_t>::max();
+  /// @brief The index in its parent's children of a node that is not among them.
+  static constexpr size_t kNotInChildren = std::numeric_limits<size_t>::max();
+  /// @brief The update list index of a node that is not in its scene's update list.
+  static constexpr size_t kNotInUpdateList = std::numeric_limits<size_t>::max();
+
+  /// @brief A child addition or destruction made by a parallel update, applied once every parallel subtree is updated.
+  struct DeferredChange {
+    // The node the child is added to or destroyed from.
+    Node* parent = nullptr;
+    // The child to add, or null for a destruction.
+    std::unique_ptr<Node> child_to_add;
+    // The child to destroy, or null for an addition.
+    const Node* child_to_destroy = nullptr;
+  };
+
+  /// @brief Constructs a node in an arena: while it lives, the nodes constructed on the calling thread are created in that arena. The previous arena is restored when it ends, even if the constructor threw, in which case the memory of the node is given back to the arena.
+  class ArenaConstructionScope {
+   public:
+    /// @brief Starts constructing a node in an arena.
+    /// @param arena The NodeArena the node is allocated from. This pointer must not be null.
+    /// @param memory The memory of the node, allocated from the arena.
+    /// @param size The size passed to NodeArena::Allocate.
+    ArenaConstructionScope(NodeArena* arena, void* memory, size_t size);
+    ~ArenaConstructionScope();
+
+    ArenaConstructionScope(const ArenaConstructionScope& other) = delete;
+    ArenaConstructionScope& operator=(const ArenaConstructionScope& other) =
+        delete;
+    ArenaConstructionScope(ArenaConstructionScope&& other) = delete;
+    ArenaConstructionScope& operator=(ArenaConstructionScope&& other) = delete;
+
+    /// @brief Marks the node as constructed, so its memory is kept when the scope ends.
+    void Commit();
+
+   private:
+    // The arena the node is allocated from. Never null.
+    NodeArena* arena_ = nullptr;
+    // The memory of the node, or null once the node is constructed.
+    void* memory_ = nullptr;
+    // The size of the memory of the node.
+    size_t size_ = 0;
+    // The arena of the nodes constructed on the thread before the scope started.
+    NodeArena* previous_arena_ = nullptr;
+  };
+
+  /// @brief Destroys a node and frees its memory. Shared by the destroying deletes.
+  /// @param node A pointer to the Node to delete. This pointer must not be null.
+  /// @param alignment The alignment the node was allocated with on the heap, or std::nullopt for the default alignment of operator new.
+  static void DestroyAndFree(Node* node,
+                             std::optional<std::align_val_t> alignment);
+
+  /// @brief Checks at compile time if a node type overrides Update.
+  /// @tparam T The type of the node.
+  /// @return True if T or one of its bases other than Node overrides Update. An override that is not public cannot be named from Node, which also means it exists.
+  template <Derived<Node> T>
+  static consteval bool OverridesUpdate() {
+    if constexpr (requires { &T::Update; }) {
+      return !std::is_same_v<decltype(&T::Update), void (Node::*)()>;
+    } else {
+      return true;
+    }
+  }
+
+  /// @brief Constructs a node in the arena of this node, or on the heap if it has none or T is over-aligned.
+  /// @tparam T The type of the Node to construct.
+  /// @tparam Args The constructor arguments for the Node type T.
+  /// @param args The arguments to forward to the constructor of T.
+  /// @return A unique pointer to the new node. Deleting it frees the memory the right way.
+  template <Derived<Node> T, typename... Args>
+  std::unique_ptr<T> NewNode(Args&&... args) {
+    // The arena only provides its own alignment.
+    if (arena_ == nullptr || alignof(T) > NodeArena::kAlignment) {
+      return std::make_unique<T>(app_, std::forward<Args>(args)...);
+    }
+
+    void* memory = arena_->Allocate(sizeof(T));
+    ArenaConstructionScope scope(arena_, memory, sizeof(T));
+    // Node's own operator new hides the global placement new.
+    std::unique_ptr<T> node(
+        ::new (memory) T(app_, std::forward<Args>(args)...));
+    scope.Commit();
+    node->allocation_size_ = sizeof(T);
+    return node;
+  }
+
+  /// @brief Removes children that were scheduled for destruction in the previous frame, keeping the order of the others.
   void EraseDestroyedChildren();
   /// @brief Adds children that were queued to be added in the previous frame.
   void AddQueuedChildren();
+  /// @brief Queues a child to be added to this node, keeping its recorded type. Shared by AddChild and MakeChild.
+  /// @param new_child A unique pointer to the Node to be added. This pointer must not be null.
+  void AttachChild(std::unique_ptr<Node> new_child);
 
   /// @brief Internal method called when the node is added to a scene. Notifies the node and its children.
   /// @param scene A pointer to the Scene this node is being added to. This pointer must not be null.
   void InternalOnAdd(Scene* scene);
-  /// @brief Internal method called during the update phase. Updates the node and its children.
-  void InternalUpdate();
+  /// @brief Internal method called at the beginning of the update phase for the nodes queued by QueueChildrenChanges. Erases the destroyed children, then adds the queued ones.
+  void InternalApplyQueuedChildren();
+  /// @brief Internal method called by a thread of the scene's pool to update the nodes of a parallel subtree. Children added or destroyed meanwhile are recorded instead of queued.
+  /// @param nodes The nodes to update, in hierarchy order.
+  /// @param deferred_changes The list the changes are appended to.
+  static void InternalParallelUpdate(
+      std::span<Node* const> nodes,
+      std::vector<DeferredChange>& deferred_changes);
+  /// @brief Queues recorded additions and destructions on their parent, in the order they were recorded.
+  /// @param deferred_changes The recorded changes. Cleared afterwards.
+  static void ApplyDeferredChanges(std::vector<DeferredChange>& deferred_changes);
   /// @brief Internal method called during the draw phase. Draws the node and its children if they belong to the camera's render layers.
   /// @param camera The Camera used for rendering.
   /// @param target The SFML RenderTarget to draw to.
@@ -156,20 +432,70 @@ class Node {
   /// @brief Internal method called when the node is about to be destroyed. Notifies the node and its children.
   void InternalOnDestroy();
 
+  /// @brief Asks the scene to apply the queued children changes of the node at the beginning of the next update. No-op if the node is not part of a scene or is queued already.
+  void QueueChildrenChanges();
+
+  /// @brief Recomputes the root of the parallel subtree the node and its descendants belong to, see SetParallelUpdate.
+  void RefreshParallelRoot();
+
+  /// @brief Locks the shared state of the node's scene while it runs parallel updates. See Scene::LockSharedState.
+  /// @return The lock, which owns nothing if the node is not part of a scene or no parallel update is running.
+  [[nodiscard]] std::unique_lock<std::recursive_mutex> LockSceneSharedState() const;
+  /// @brief Locks the shared state of the scene whose parallel update runs on this thread, for the work a node does before it knows its scene, such as taking and releasing its NodeSlotTable slot.
+  /// @return The lock, which owns nothing if no parallel update runs on this thread.
+  [[nodiscard]] static std::unique_lock<std::recursive_mutex> LockParallelScene();
+
+  /// @brief Returns the ComponentStore of the node's scene. The node must be part of a scene.
+  /// @return A reference to the ComponentStore.
+  [[nodiscard]] ComponentStore& GetComponentStore() const;
+
   /// @brief Marks the global transform as dirty, forcing a recalculation on the next GetGlobalTransform call and propagating the dirty flag to children.
   void DirtyGlobalTransform();
 
-  // The name of the node.
-  std::string name_;
+  // The interned name of the node.
+  NameId name_ = kNoName;
+  // The id of the exact type of the node. kNoTypeId if it was not recorded, see GetTypeId.
+  TypeId type_id_ = kNoTypeId;
   // The local transformation of the node.
   sf::Transformable local_transform_;
-  // The cached global transformation of the node. Mutable for lazy evaluation.
-  mutable sf::Transformable global_transform_;
+  // The cached global transformation matrix of the node. Mutable for lazy evaluation.
+  mutable sf::Transform global_transform_;
   // Flag indicating if the global transform needs to be recalculated. Mutable for lazy evaluation.
   mutable bool is_global_transform_dirty_ = false;
 
   // Pointer to the App instance. Never null after construction.
   App* app_ = nullptr;
+  // The slot of the node in the App's NodeSlotTable, or NodeSlotTable::kNoSlot once the node is destroyed.
+  uint32_t slot_index_ = NodeSlotTable::kNoSlot;
+  // The arena the children of the node are created in. Null if the node was not created in a scene's arena, in which case its children are created on the heap.
+  NodeArena* arena_ = nullptr;
+  // The number of bytes allocated for the node from arena_, or zero if it was created on the heap.
+  size_t allocation_size_ = 0;
+
+  // The index of the node in the scene's queue of dirty transform subtrees, or kNotQueued. Mutable because reading a transform may queue nodes.
+  mutable size_t transform_root_index_ = kNotQueued;
+
+  // The entity holding the components of the node, or kNoEntity if it has none.
+  Entity entity_ = kNoEntity;
+
+  // The index of the node in its parent's children_, or kNotInChildren. Lets DestroyChild find the node without a search.
+  size_t index_in_parent_ = kNotInChildren;
+  // The index of the node in its scene's index of nodes with its name, or kNotInNameIndex.
+  uint32_t name_index_ = kNotInNameIndex;
+  // The index of the node in its scene's registry of nodes of its type. Only meaningful while the node is registered.
+  size_t type_registry_index_ = 0;
+  // The index of the node in its scene's update list, or kNotInUpdateList.
+  size_t update_index_ = kNotInUpdateList;
+  // The index of the node in its scene's queue of nodes with children changes, or kNotQueued.
+  size_t children_changes_index_ = kNotQueued;
+  // The outermost ancestor, or the node itself, whose subtree is updated in parallel. Null if the node is updated serially. Only meaningful while the node is in a scene.
+  Node* parallel_root_ = nullptr;
+  // Whether the node is called by the update phase. False for nodes whose recorded type does not override Update.
+  bool has_update_ = true;
+  // Whether the subtree of the node is updated in parallel with other such subtrees.
+  bool is_parallel_update_ = false;
+  // Whether the node is scheduled to be erased by its parent.
+  bool is_destruction_scheduled_ = false;
 
   // Pointer to the parent node in the scene graph. Can be null for the root.
   Node* parent_ = nullptr;
@@ -178,12 +504,17 @@ class Node {
 
   // Vector of child nodes. Ownership is managed by this node.
   std::vector<std::unique_ptr<Node>> children_;
-  // Indices of children to be erased in the next update cycle.
-  std::vector<size_t> children_to_erase_;
+  // Children to be erased in the next update cycle.
+  std::vector<Node*> children_to_erase_;
   // Vector of children to be added in the next update cycle.
   std::vector<std::unique_ptr<Node>> children_to_add_;
   // The rendering layer of this node.
   Layer layer_ = Layer::kDefault;
+
+  // The changes recorded by the parallel update running on this thread, or null outside of parallel updates.
+  static thread_local std::vector<DeferredChange>* deferred_changes_;
+  // The scene whose parallel update runs on this thread, or null outside of parallel updates.
+  static thread_local Scene* parallel_scene_;
 };
 
 }  // namespace ng
\ No newline at end of file
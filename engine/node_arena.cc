@@ -0,0 +1,61 @@
+#include "node_arena.h"
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace ng {
+
+void* NodeArena::Allocate(size_t size) {
+  assert(size > 0);
+  if (size > kMaxPooledSize) {
+    return ::operator new(size);
+  }
+
+  size_t size_class = GetSizeClass(size);
+  FreeSlot* slot = free_lists_[size_class];
+  if (slot != nullptr) {
+    free_lists_[size_class] = slot->next;
+    return slot;
+  }
+
+  size_t rounded_size = (size_class + 1) * kAlignment;
+  if (current_offset_ + rounded_size > kBlockSize) {
+    // Blocks kept by Reset are used again before new ones are allocated.
+    if (used_block_count_ == blocks_.size()) {
+      blocks_.push_back(
+          std::make_unique_for_overwrite<std::byte[]>(kBlockSize));
+    }
+    ++used_block_count_;
+    current_offset_ = 0;
+  }
+
+  std::byte* memory = &blocks_[used_block_count_ - 1][current_offset_];
+  current_offset_ += rounded_size;
+  return memory;
+}
+
+void NodeArena::Deallocate(void* memory, size_t size) {
+  assert(memory);
+  if (size > kMaxPooledSize) {
+    ::operator delete(memory);
+    return;
+  }
+
+  size_t size_class = GetSizeClass(size);
+  free_lists_[size_class] = new (memory) FreeSlot{free_lists_[size_class]};
+}
+
+void NodeArena::Reset() {
+  used_block_count_ = 0;
+  current_offset_ = kBlockSize;
+  free_lists_ = {};
+}
+
+size_t NodeArena::GetSizeClass(size_t size) {
+  assert(size <= kMaxPooledSize);
+  return (size - 1) / kAlignment;
+}
+
+}  // namespace ng
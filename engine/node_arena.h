@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ng {
+
+/// @brief Provides the memory of the nodes of a scene.
+///        Small allocations are rounded up to a size class and carved from large blocks one after another, so nodes created together sit next to each other in memory.
+///        Freed memory goes to a free list of its size class and is reused by the next node of that size. The blocks themselves are only released when the arena is destroyed, and Reset makes them available again without touching the heap.
+class NodeArena {
+ public:
+  /// @brief The alignment of every allocation. Types with a stricter alignment cannot be allocated from the arena.
+  static constexpr size_t kAlignment = alignof(std::max_align_t);
+  /// @brief The size of the largest allocation carved from the blocks. Larger ones go to the general-purpose heap.
+  static constexpr size_t kMaxPooledSize = 4096;
+
+  NodeArena() = default;
+
+  NodeArena(const NodeArena& other) = delete;
+  NodeArena& operator=(const NodeArena& other) = delete;
+  NodeArena(NodeArena&& other) = delete;
+  NodeArena& operator=(NodeArena&& other) = delete;
+
+  /// @brief Allocates uninitialized memory.
+  /// @param size The number of bytes to allocate. Must be greater than zero.
+  /// @return A pointer to the memory, aligned to kAlignment. Never null.
+  [[nodiscard]] void* Allocate(size_t size);
+
+  /// @brief Returns memory to the arena so it can be reused.
+  /// @param memory A pointer returned by Allocate. This pointer must not be null.
+  /// @param size The size passed to Allocate.
+  void Deallocate(void* memory, size_t size);
+
+  /// @brief Makes the whole arena available again, keeping its blocks for the next allocations. Every allocation must have been deallocated.
+  void Reset();
+
+ private:
+  /// @brief The number of bytes of each block.
+  static constexpr size_t kBlockSize = size_t{64} * 1024;
+  /// @brief The number of size classes, one per multiple of kAlignment up to kMaxPooledSize.
+  static constexpr size_t kSizeClassCount = kMaxPooledSize / kAlignment;
+
+  /// @brief A freed allocation, linked to the next free allocation of the same size class.
+  struct FreeSlot {
+    FreeSlot* next = nullptr;
+  };
+
+  /// @brief Returns the size class of an allocation.
+  /// @param size The size of the allocation. Must not be greater than kMaxPooledSize.
+  /// @return The index of the size class. Allocations of size class i are (i + 1) * kAlignment bytes.
+  [[nodiscard]] static size_t GetSizeClass(size_t size);
+
+  // The blocks the allocations are carved from, in the order they are used.
+  std::vector<std::unique_ptr<std::byte[]>> blocks_;
+  // The number of blocks in use. The last one in use is being carved.
+  size_t used_block_count_ = 0;
+  // The number of bytes already carved from the last block in use.
+  size_t current_offset_ = kBlockSize;
+  // The first free allocation of each size class, or null.
+  std::array<FreeSlot*, kSizeClassCount> free_lists_ = {};
+};
+
+}  // namespace ng
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "app.h"
+#include "node.h"
+#include "node_slot_table.h"
+
+namespace ng {
+
+/// @brief A weak reference to a node that knows when the node is destroyed, unlike a raw pointer whose address may be reused by a new node.
+///        Resolving is an index and generation check, with no hashing and no allocation.
+/// @tparam T The type of the node, must derive from Node.
+template <typename T = Node>
+class NodeHandle {
+  static_assert(std::is_base_of_v<Node, T>, "T must derive from Node.");
+
+ public:
+  /// @brief Constructs a handle that never resolves.
+  NodeHandle() = default;
+
+  /// @brief Constructs a handle to a node. The handle resolves until the node is destroyed.
+  /// @param node The Node to refer to.
+  explicit NodeHandle(T& node)
+      : slots_(&node.GetApp()->GetNodeSlots()),
+        index_(node.slot_index_),
+        generation_(index_ == NodeSlotTable::kNoSlot
+                        ? 0
+                        : slots_->GetGeneration(index_)) {}
+
+  /// @brief Returns the node if it has not been destroyed yet.
+  /// @return A pointer to the Node, or nullptr if it was destroyed or the handle is empty.
+  [[nodiscard]] T* Resolve() const {
+    if (slots_ == nullptr || index_ == NodeSlotTable::kNoSlot) {
+      return nullptr;
+    }
+    return static_cast<T*>(slots_->Find(index_, generation_));
+  }
+
+  /// @brief Checks if the node has not been destroyed yet.
+  /// @return True if Resolve returns a node, false otherwise.
+  [[nodiscard]] bool IsValid() const {
+    return Resolve() != nullptr;
+  }
+
+ private:
+  // The table the slot belongs to. Null for an empty handle.
+  const NodeSlotTable* slots_ = nullptr;
+  // The slot of the node.
+  uint32_t index_ = NodeSlotTable::kNoSlot;
+  // The generation of the slot when the handle was made.
+  uint32_t generation_ = 0;
+};
+
+}  // namespace ng
@@ -0,0 +1,41 @@
+#include "node_slot_table.h"
+
+#include <cassert>
+#include <cstdint>
+
+#include "node.h"
+
+namespace ng {
+
+uint32_t NodeSlotTable::Acquire(Node* node) {
+  assert(node);
+  if (!free_indices_.empty()) {
+    uint32_t index = free_indices_.back();
+    free_indices_.pop_back();
+    slots_[index].node = node;
+    return index;
+  }
+
+  slots_.push_back({.node = node, .generation = 0});
+  return static_cast<uint32_t>(slots_.size() - 1);
+}
+
+void NodeSlotTable::Release(uint32_t index) {
+  slots_[index].node = nullptr;
+  // Handles made before this point no longer match the slot.
+  ++slots_[index].generation;
+  free_indices_.push_back(index);
+}
+
+uint32_t NodeSlotTable::GetGeneration(uint32_t index) const {
+  return slots_[index].generation;
+}
+
+Node* NodeSlotTable::Find(uint32_t index, uint32_t generation) const {
+  if (index >= slots_.size() || slots_[index].generation != generation) {
+    return nullptr;
+  }
+  return slots_[index].node;
+}
+
+}  // namespace ng
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ng {
+
+class Node;
+
+/// @brief A table of slots, one per live node, that NodeHandle resolves through. Owned by the App.
+///        Each slot counts its generation: freeing a slot bumps it, so handles to the previous node of a reused slot no longer resolve.
+class NodeSlotTable {
+ public:
+  /// @brief The slot index of a node that holds no slot.
+  static constexpr uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+
+  NodeSlotTable() = default;
+
+  NodeSlotTable(const NodeSlotTable& other) = delete;
+  NodeSlotTable& operator=(const NodeSlotTable& other) = delete;
+  NodeSlotTable(NodeSlotTable&& other) = delete;
+  NodeSlotTable& operator=(NodeSlotTable&& other) = delete;
+
+  /// @brief Gives a node a slot, reusing a freed one if possible.
+  /// @param node A pointer to the Node. This pointer must not be null.
+  /// @return The index of the slot.
+  uint32_t Acquire(Node* node);
+
+  /// @brief Frees a slot, invalidating every handle to its node.
+  /// @param index The index of the slot.
+  void Release(uint32_t index);
+
+  /// @brief Returns the current generation of a slot.
+  /// @param index The index of the slot.
+  /// @return The generation of the slot.
+  [[nodiscard]] uint32_t GetGeneration(uint32_t index) const;
+
+  /// @brief Returns the node of a slot if the slot was not freed since the given generation.
+  /// @param index The index of the slot.
+  /// @param generation The generation of the slot when the handle was made.
+  /// @return A pointer to the Node, or nullptr if it was destroyed.
+  [[nodiscard]] Node* Find(uint32_t index, uint32_t generation) const;
+
+ private:
+  /// @brief A node and the number of times its slot was freed before.
+  struct Slot {
+    Node* node = nullptr;
+    uint32_t generation = 0;
+  };
+
+  // The slots, indexed by slot index.
+  std::vector<Slot> slots_;
+  // The indices of the freed slots, reused before new ones.
+  std::vector<uint32_t> free_indices_;
+};
+
+}  // namespace ng
@@ -1,36 +1,686 @@
 #include "physics.h"
 
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <bit>
 #include <cassert>
-#include <unordered_set>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
 #include <vector>
 
+#include "broadphase.h"
 #include "collider.h"
+#include "collider_cache.h"
+#include "collision_filter.h"
+#include "dynamic_aabb_tree.h"
+#include "raycast_hit.h"
+#include "thread_pool.h"
 
 namespace ng {
 
+namespace {
+
+/// @brief An overlap visitor that writes the colliders it is called with to a caller-provided buffer, stopping once it is full.
+struct SpanWriter {
+  bool operator()(const Collider& collider) {
+    hits[count++] = &collider;
+    return count < hits.size();
+  }
+
+  std::span<const Collider*> hits;
+  size_t count = 0;
+};
+
+}  // namespace
+
 std::vector<const Collider*> Physics::Overlap(const Collider& collider) const {
   std::vector<const Collider*> collisions;
-  for (const auto* other : colliders_) {
-    if (other == &collider) {
-      continue;
+  Overlap(collider, [&collisions](const Collider& other) -> bool {
+    collisions.push_back(&other);
+    return true;
+  });
+  return collisions;
+}
+
+bool Physics::Overlap(const Collider& collider, OverlapVisitor visitor) const {
+  SyncColliders();
+  const ColliderCache& cache = GetCache(&collider);
+  const size_t* index = cache.FindIndex(&collider);
+  if (index == nullptr) {
+    // The collider is not part of the physics world, so it is not cached.
+    return VisitOverlaps(ColliderCache::GetShape(collider),
+                         collider.GetBounds(), collider.GetCollisionFilter(),
+                         &collider, visitor);
+  }
+
+  return VisitOverlaps(cache.GetShape(*index), cache.GetBounds(*index),
+                       cache.GetFilter(*index), &collider, visitor);
+}
+
+size_t Physics::Overlap(const Collider& collider,
+                        std::span<const Collider*> hits) const {
+  if (hits.empty()) {
+    return 0;
+  }
+
+  SpanWriter writer{.hits = hits};
+  Overlap(collider, writer);
+  return writer.count;
+}
+
+std::vector<const Collider*> Physics::OverlapRect(const sf::FloatRect& rect,
+                                                  uint32_t mask) const {
+  std::vector<const Collider*> collisions;
+  OverlapRect(
+      rect,
+      [&collisions](const Collider& other) -> bool {
+        collisions.push_back(&other);
+        return true;
+      },
+      mask);
+  return collisions;
+}
+
+bool Physics::OverlapRect(const sf::FloatRect& rect, OverlapVisitor visitor,
+                          uint32_t mask) const {
+  SyncColliders();
+  // The query belongs to every category, so only its own mask matters.
+  return VisitOverlaps(ColliderShape::kRectangle, rect,
+                       {.category = ~0U, .mask = mask}, nullptr, visitor);
+}
+
+size_t Physics::OverlapRect(const sf::FloatRect& rect,
+                            std::span<const Collider*> hits,
+                            uint32_t mask) const {
+  if (hits.empty()) {
+    return 0;
+  }
+
+  SpanWriter writer{.hits = hits};
+  OverlapRect(rect, writer, mask);
+  return writer.count;
+}
+
+std::vector<const Collider*> Physics::OverlapPoint(sf::Vector2f point,
+                                                   uint32_t mask) const {
+  return OverlapRect({point, {0, 0}}, mask);
+}
+
+bool Physics::OverlapPoint(sf::Vector2f point, OverlapVisitor visitor,
+                           uint32_t mask) const {
+  return OverlapRect({point, {0, 0}}, visitor, mask);
+}
+
+size_t Physics::OverlapPoint(sf::Vector2f point,
+                             std::span<const Collider*> hits,
+                             uint32_t mask) const {
+  return OverlapRect({point, {0, 0}}, hits, mask);
+}
+
+std::optional<RaycastHit> Physics::Raycast(sf::Vector2f origin,
+                                           sf::Vector2f direction,
+                                           float max_distance,
+                                           uint32_t mask) const {
+  return ShapeCast(ColliderShape::kRectangle, {origin, {0, 0}}, direction,
+                   max_distance, mask);
+}
+
+std::vector<RaycastHit> Physics::RaycastAll(sf::Vector2f origin,
+                                            sf::Vector2f direction,
+                                            float max_distance,
+                                            uint32_t mask) const {
+  assert(direction != sf::Vector2f());
+  SyncColliders();
+  std::vector<RaycastHit> hits;
+  VisitCastHits(
+      ColliderShape::kRectangle, {origin, {0, 0}}, direction.normalized(),
+      max_distance, {.category = ~0U, .mask = mask}, nullptr,
+      [&hits](const RaycastHit& hit) -> void { hits.push_back(hit); });
+  std::ranges::sort(hits, {}, &RaycastHit::distance);
+  return hits;
+}
+
+std::optional<RaycastHit> Physics::ShapeCast(ColliderShape shape,
+                                             const sf::FloatRect& bounds,
+                                             sf::Vector2f direction,
+                                             float max_distance,
+                                             uint32_t mask) const {
+  SyncColliders();
+  // The cast belongs to every category, so only its own mask matters.
+  return CastClosest(shape, bounds, direction, max_distance,
+                     {.category = ~0U, .mask = mask}, nullptr);
+}
+
+std::optional<RaycastHit> Physics::ShapeCast(const Collider& collider,
+                                             sf::Vector2f direction,
+                                             float max_distance) const {
+  SyncColliders();
+  const ColliderCache& cache = GetCache(&collider);
+  const size_t* index = cache.FindIndex(&collider);
+  if (index == nullptr) {
+    // The collider is not part of the physics world, so it is not cached.
+    return CastClosest(ColliderCache::GetShape(collider), collider.GetBounds(),
+                       direction, max_distance, collider.GetCollisionFilter(),
+                       &collider);
+  }
+
+  return CastClosest(cache.GetShape(*index), cache.GetBounds(*index),
+                     direction, max_distance, cache.GetFilter(*index),
+                     &collider);
+}
+
+void Physics::SetThreadPool(ThreadPool* thread_pool) {
+  thread_pool_ = thread_pool;
+}
+
+bool Physics::IsAsleep(const Collider& collider) const {
+  // A collider that moved since the last query is awake.
+  SyncColliders();
+  const size_t* index = cache_.FindIndex(&collider);
+  return index != nullptr && *index >= cache_.GetAwakeCount();
+}
+
+void Physics::SetBroadphase(std::unique_ptr<Broadphase> broadphase) {
+  SyncColliders();
+  broadphase_ = std::move(broadphase);
+  if (broadphase_ == nullptr) {
+    return;
+  }
+
+  for (size_t i = 0; i < cache_.GetSize(); ++i) {
+    broadphase_->Insert(cache_.GetId(i), cache_.GetBounds(i),
+                        cache_.GetFilter(i));
+  }
+}
+
+void Physics::Step() {
+  PurgeRemovedPairs();
+  FindOverlappingPairs();
+
+  // Both pair lists are sorted, so a single merge pass tells which pairs
+  // started, continued, or stopped overlapping.
+  auto old_it = pairs_.begin();
+  auto new_it = new_pairs_.begin();
+  while (old_it != pairs_.end() || new_it != new_pairs_.end()) {
+    if (new_it == new_pairs_.end() ||
+        (old_it != pairs_.end() && *old_it < *new_it)) {
+      old_it->first->GetParent()->OnCollisionExit(*old_it->first,
+                                                  *old_it->second);
+      old_it->second->GetParent()->OnCollisionExit(*old_it->second,
+                                                   *old_it->first);
+      ++old_it;
+    } else if (old_it == pairs_.end() || *new_it < *old_it) {
+      new_it->first->GetParent()->OnCollisionEnter(*new_it->first,
+                                                   *new_it->second);
+      new_it->second->GetParent()->OnCollisionEnter(*new_it->second,
+                                                    *new_it->first);
+      ++new_it;
+    } else {
+      new_it->first->GetParent()->OnCollisionStay(*new_it->first,
+                                                  *new_it->second);
+      new_it->second->GetParent()->OnCollisionStay(*new_it->second,
+                                                   *new_it->first);
+      ++old_it;
+      ++new_it;
     }
+  }
+
+  std::swap(pairs_, new_pairs_);
+  UpdateSleep();
+}
+
+void Physics::PurgeRemovedPairs() {
+  if (removed_ids_.empty()) {
+    return;
+  }
 
-    if (collider.Collides(*other)) {
-      collisions.push_back(other);
+  // The removed colliders may already be freed, so they are only known by
+  // their ids.
+  std::ranges::sort(removed_ids_);
+  std::erase_if(pairs_, [this](const ContactPair& pair) -> bool {
+    return std::ranges::binary_search(removed_ids_, pair.first_id) ||
+           std::ranges::binary_search(removed_ids_, pair.second_id);
+  });
+  removed_ids_.clear();
+}
+
+void Physics::FindOverlappingPairs() {
+  new_pairs_.clear();
+  SyncColliders();
+
+  // Colliders that are asleep or static did not move, so the pairs between
+  // them still hold. Static colliders never collide with each other.
+  for (const ContactPair& pair : pairs_) {
+    if (!IsAwake(pair.first) && !IsAwake(pair.second) &&
+        !(pair.first->IsStatic() && pair.second->IsStatic())) {
+      new_pairs_.push_back(pair);
     }
   }
 
-  return collisions;
+  size_t awake_count = cache_.GetAwakeCount();
+  candidate_pairs_.clear();
+  bool use_pair_query =
+      broadphase_ != nullptr && awake_count == cache_.GetSize();
+  if (use_pair_query) {
+    // Finding every candidate pair at once is faster than querying the
+    // broadphase once per collider, but it cannot leave out sleeping ones.
+    broadphase_->QueryPairs(candidate_pairs_);
+  }
+
+  // The chunks do not depend on the number of threads and the pairs are
+  // sorted below, so the result is the same whatever the thread count.
+  size_t chunk_count =
+      (std::max(awake_count, candidate_pairs_.size()) + kPairChunkSize - 1) /
+      kPairChunkSize;
+  if (pair_buffers_.size() < chunk_count) {
+    pair_buffers_.resize(chunk_count);
+  }
+
+  auto find_chunk_pairs = [this, awake_count,
+                           use_pair_query](size_t chunk) -> void {
+    PairBuffer& buffer = pair_buffers_[chunk];
+    buffer.pairs.clear();
+    size_t begin = chunk * kPairChunkSize;
+    size_t end = std::min(begin + kPairChunkSize, awake_count);
+    if (use_pair_query) {
+      size_t pair_end =
+          std::min(begin + kPairChunkSize, candidate_pairs_.size());
+      for (size_t k = begin; k < pair_end; ++k) {
+        size_t i = cache_.GetIndex(candidate_pairs_[k].first);
+        size_t j = cache_.GetIndex(candidate_pairs_[k].second);
+        if (cache_.Collides(i, j)) {
+          buffer.pairs.push_back(
+              MakeContactPair(cache_.GetCollider(i), cache_.GetCollider(j)));
+        }
+      }
+    } else {
+      FindDynamicPairsOf(begin, end, buffer.pairs, buffer.candidates);
+    }
+
+    FindStaticPairsOf(begin, end, buffer.pairs, buffer.candidates);
+  };
+
+  if (thread_pool_ != nullptr) {
+    thread_pool_->ParallelFor(chunk_count, find_chunk_pairs);
+  } else {
+    for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+      find_chunk_pairs(chunk);
+    }
+  }
+
+  for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+    const std::vector<ContactPair>& pairs = pair_buffers_[chunk].pairs;
+    new_pairs_.insert(new_pairs_.end(), pairs.begin(), pairs.end());
+  }
+
+  // Sorting by registration id keeps the callbacks in the same order from run
+  // to run, wherever the allocator placed the colliders.
+  std::ranges::sort(new_pairs_, std::less<>());
+}
+
+Physics::ContactPair Physics::MakeContactPair(const Collider* a,
+                                              const Collider* b) {
+  uint64_t a_id = a->GetRegistrationId();
+  uint64_t b_id = b->GetRegistrationId();
+  if (b_id < a_id) {
+    return {b_id, a_id, b, a};
+  }
+  return {a_id, b_id, a, b};
+}
+
+void Physics::FindDynamicPairsOf(size_t begin, size_t end,
+                                 std::vector<ContactPair>& pairs,
+                                 std::vector<ColliderId>& candidates) const {
+  size_t awake_count = cache_.GetAwakeCount();
+  if (broadphase_ == nullptr) {
+    // Awake colliders come first, so each awake collider is tested against
+    // the colliders after it, asleep or not.
+    for (size_t i = begin; i < end; ++i) {
+      for (size_t first = i + 1; first < cache_.GetSize();
+           first += ColliderCache::kBatchSize) {
+        for (uint32_t hits = cache_.CollidesBatch(first, i); hits != 0;
+             hits &= hits - 1) {
+          size_t j = first + std::countr_zero(hits);
+          pairs.push_back(
+              MakeContactPair(cache_.GetCollider(i), cache_.GetCollider(j)));
+        }
+      }
+    }
+  } else {
+    for (size_t i = begin; i < end; ++i) {
+      candidates.clear();
+      broadphase_->Query(cache_.GetBounds(i), cache_.GetFilter(i), candidates);
+      for (ColliderId other : candidates) {
+        size_t j = cache_.GetIndex(other);
+        // Pairs of awake colliders are found from both sides, keep only one.
+        if (j == i || (j < awake_count && j < i)) {
+          continue;
+        }
+
+        if (cache_.Collides(i, j)) {
+          pairs.push_back(
+              MakeContactPair(cache_.GetCollider(i), cache_.GetCollider(j)));
+        }
+      }
+    }
+  }
+}
+
+void Physics::FindStaticPairsOf(size_t begin, size_t end,
+                                std::vector<ContactPair>& pairs,
+                                std::vector<ColliderId>& candidates) const {
+  for (size_t i = begin; i < end; ++i) {
+    candidates.clear();
+    static_tree_.Query(cache_.GetBounds(i), cache_.GetFilter(i), candidates);
+    for (ColliderId other : candidates) {
+      size_t j = static_cache_.GetIndex(other);
+      if (static_cache_.Collides(j, cache_.GetShape(i), cache_.GetBounds(i),
+                                 cache_.GetFilter(i))) {
+        pairs.push_back(MakeContactPair(cache_.GetCollider(i),
+                                        static_cache_.GetCollider(j)));
+      }
+    }
+  }
 }
 
-void Physics::AddCollider(const Collider* collider) {
+void Physics::UpdateSleep() {
+  // Iterating backwards keeps the indices left to visit stable when a
+  // collider falls asleep and swaps with the last awake one.
+  for (size_t i = cache_.GetAwakeCount(); i-- > 0;) {
+    if (cache_.AddIdleTick(i) >= kTicksBeforeSleep) {
+      cache_.Sleep(i);
+    }
+  }
+}
+
+bool Physics::IsAwake(const Collider* collider) const {
+  const size_t* index = cache_.FindIndex(collider);
+  return index != nullptr && *index < cache_.GetAwakeCount();
+}
+
+ColliderCache& Physics::GetCache(const Collider* collider) const {
   assert(collider);
-  colliders_.insert(collider);
+  return collider->IsStatic() ? static_cache_ : cache_;
+}
+
+bool Physics::VisitOverlaps(ColliderShape shape, const sf::FloatRect& bounds,
+                            CollisionFilter filter, const Collider* ignored,
+                            OverlapVisitor visitor) const {
+  if (broadphase_ == nullptr) {
+    for (size_t first = 0; first < cache_.GetSize();
+         first += ColliderCache::kBatchSize) {
+      for (uint32_t hits = cache_.CollidesBatch(first, shape, bounds, filter);
+           hits != 0; hits &= hits - 1) {
+        const Collider* other =
+            cache_.GetCollider(first + std::countr_zero(hits));
+        if (other != ignored && !visitor(*other)) {
+          return false;
+        }
+      }
+    }
+  } else if (!VisitCandidates(*broadphase_, cache_, shape, bounds, filter,
+                              ignored, visitor)) {
+    return false;
+  }
+
+  return VisitCandidates(static_tree_, static_cache_, shape, bounds, filter,
+                         ignored, visitor);
+}
+
+std::vector<ColliderId> Physics::BorrowCandidates() const {
+  if (query_depth_ == candidate_buffers_.size()) {
+    candidate_buffers_.emplace_back();
+  }
+  // The buffer is moved out, so growing the list of buffers for a deeper
+  // query does not move it.
+  std::vector<ColliderId> candidates =
+      std::move(candidate_buffers_[query_depth_++]);
+  candidates.clear();
+  return candidates;
+}
+
+void Physics::ReturnCandidates(std::vector<ColliderId> candidates) const {
+  assert(query_depth_ > 0);
+  candidate_buffers_[--query_depth_] = std::move(candidates);
+}
+
+bool Physics::VisitCandidates(const Broadphase& broadphase,
+                              const ColliderCache& cache, ColliderShape shape,
+                              const sf::FloatRect& bounds,
+                              CollisionFilter filter, const Collider* ignored,
+                              OverlapVisitor visitor) const {
+  std::vector<ColliderId> candidates = BorrowCandidates();
+  broadphase.Query(bounds, filter, candidates);
+  bool completed = true;
+  for (ColliderId id : candidates) {
+    size_t index = cache.GetIndex(id);
+    const Collider* other = cache.GetCollider(index);
+    if (other != ignored && cache.Collides(index, shape, bounds, filter) &&
+        !visitor(*other)) {
+      completed = false;
+      break;
+    }
+  }
+
+  ReturnCandidates(std::move(candidates));
+  return completed;
+}
+
+void Physics::VisitCastHits(
+    ColliderShape shape, const sf::FloatRect& bounds, sf::Vector2f direction,
+    float max_distance, CollisionFilter filter, const Collider* ignored,
+    FunctionRef<void(const RaycastHit&)> visitor) const {
+  if (broadphase_ == nullptr) {
+    for (size_t i = 0; i < cache_.GetSize(); ++i) {
+      if (cache_.GetCollider(i) == ignored) {
+        continue;
+      }
+
+      if (auto hit =
+              cache_.Cast(i, shape, bounds, filter, direction, max_distance)) {
+        visitor(*hit);
+      }
+    }
+  } else {
+    VisitCastCandidates(*broadphase_, cache_, shape, bounds, direction,
+                        max_distance, filter, ignored, visitor);
+  }
+
+  VisitCastCandidates(static_tree_, static_cache_, shape, bounds, direction,
+                      max_distance, filter, ignored, visitor);
+}
+
+void Physics::VisitCastCandidates(
+    const Broadphase& broadphase, const ColliderCache& cache,
+    ColliderShape shape, const sf::FloatRect& bounds, sf::Vector2f direction,
+    float max_distance, CollisionFilter filter, const Collider* ignored,
+    FunctionRef<void(const RaycastHit&)> visitor) const {
+  std::vector<ColliderId> candidates = BorrowCandidates();
+  broadphase.QueryCast(bounds, direction * max_distance, filter, candidates);
+  for (ColliderId id : candidates) {
+    size_t index = cache.GetIndex(id);
+    if (cache.GetCollider(index) == ignored) {
+      continue;
+    }
+
+    if (auto hit = cache.Cast(index, shape, bounds, filter, direction,
+                              max_distance)) {
+      visitor(*hit);
+    }
+  }
+
+  ReturnCandidates(std::move(candidates));
+}
+
+std::optional<RaycastHit> Physics::CastClosest(
+    ColliderShape shape, const sf::FloatRect& bounds, sf::Vector2f direction,
+    float max_distance, CollisionFilter filter,
+    const Collider* ignored) const {
+  assert(direction != sf::Vector2f());
+  std::optional<RaycastHit> closest;
+  VisitCastHits(shape, bounds, direction.normalized(), max_distance, filter,
+                ignored, [&closest](const RaycastHit& hit) -> void {
+                  if (!closest || hit.distance < closest->distance) {
+                    closest = hit;
+                  }
+                });
+  return closest;
+}
+
+uint64_t Physics::AddCollider(const Collider* collider) {
+  InsertCollider(collider);
+  return next_registration_id_++;
 }
 
 void Physics::RemoveCollider(const Collider* collider) {
   assert(collider);
-  colliders_.erase(collider);
+  EraseCollider(collider, collider->IsStatic());
+
+  // The collisions of the collider are forgotten at the next step, so that
+  // destroying many colliders at once costs a single pass over the pairs.
+  if (!pairs_.empty()) {
+    removed_ids_.push_back(collider->GetRegistrationId());
+  }
+}
+
+void Physics::RefreshCollisionFilter(const Collider* collider) {
+  assert(collider);
+  ColliderCache& cache = GetCache(collider);
+  if (cache.FindId(collider) == nullptr) {
+    return;
+  }
+
+  SyncColliders();
+  ColliderId id = *cache.FindId(collider);
+  size_t index = cache.GetIndex(id);
+  cache.RefreshFilter(index);
+  // Filters rarely change, so the structure entry is simply rebuilt. The
+  // collisions with sleeping colliders must be found again.
+  if (collider->IsStatic()) {
+    static_tree_.Remove(id);
+    static_tree_.Insert(id, cache.GetBounds(index), cache.GetFilter(index));
+    WakeDynamicColliders(cache.GetBounds(index));
+    return;
+  }
+
+  if (broadphase_ != nullptr) {
+    broadphase_->Remove(id);
+    broadphase_->Insert(id, cache.GetBounds(index), cache.GetFilter(index));
+  }
+  cache.Wake(index);
+}
+
+void Physics::RefreshStatic(const Collider* collider) {
+  assert(collider);
+  bool was_static = !collider->IsStatic();
+  if ((was_static ? static_cache_ : cache_).FindIndex(collider) == nullptr) {
+    return;
+  }
+
+  SyncColliders();
+  // The collisions of the collider are kept. A collider that becomes dynamic
+  // is awake and finds them again, one that becomes static keeps them.
+  EraseCollider(collider, was_static);
+  InsertCollider(collider);
+}
+
+void Physics::InsertCollider(const Collider* collider) {
+  assert(collider);
+  if (collider->IsStatic()) {
+    ColliderId id = static_cache_.Add(collider);
+    size_t index = static_cache_.GetIndex(id);
+    static_tree_.Insert(id, static_cache_.GetBounds(index),
+                        static_cache_.GetFilter(index));
+    return;
+  }
+
+  ColliderId id = cache_.Add(collider);
+  if (broadphase_ != nullptr) {
+    size_t index = cache_.GetIndex(id);
+    broadphase_->Insert(id, cache_.GetBounds(index), cache_.GetFilter(index));
+  }
+}
+
+void Physics::EraseCollider(const Collider* collider, bool is_static) {
+  assert(collider);
+  ColliderCache& cache = is_static ? static_cache_ : cache_;
+  const ColliderId* id = cache.FindId(collider);
+  if (id == nullptr) {
+    return;
+  }
+
+  // The cache frees the id for the next collider added, so the structure
+  // entry is removed first.
+  if (is_static) {
+    static_tree_.Remove(*id);
+  } else if (broadphase_ != nullptr) {
+    broadphase_->Remove(*id);
+  }
+  cache.Remove(collider);
+}
+
+void Physics::MarkDirty(const Collider* collider) {
+  assert(collider);
+  dirty_colliders_.push_back(collider);
+}
+
+void Physics::WakeDynamicColliders(const sf::FloatRect& bounds) const {
+  if (broadphase_ == nullptr) {
+    // Waking a collider swaps it with the first sleeping one, which was
+    // already visited, so the sleeping ones are visited in order.
+    for (size_t i = cache_.GetAwakeCount(); i < cache_.GetSize(); ++i) {
+      if (Overlaps(cache_.GetBounds(i), bounds)) {
+        cache_.Wake(i);
+      }
+    }
+    return;
+  }
+
+  // The query belongs to every category, so a collider changing its filter
+  // also wakes the colliders it stops colliding with.
+  std::vector<ColliderId> candidates = BorrowCandidates();
+  broadphase_->Query(bounds, {.category = ~0U, .mask = ~0U}, candidates);
+  for (ColliderId id : candidates) {
+    size_t index = cache_.GetIndex(id);
+    if (index >= cache_.GetAwakeCount() &&
+        Overlaps(cache_.GetBounds(index), bounds)) {
+      cache_.Wake(index);
+    }
+  }
+  ReturnCandidates(std::move(candidates));
+}
+
+void Physics::SyncColliders() const {
+  for (const auto* collider : dirty_colliders_) {
+    // The collider may have been removed after being marked as dirty, so it
+    // is only looked up and never dereferenced.
+    if (const ColliderId* id = cache_.FindId(collider); id != nullptr) {
+      size_t index = cache_.GetIndex(*id);
+      cache_.Refresh(index);
+      if (broadphase_ != nullptr) {
+        broadphase_->Update(*id, cache_.GetBounds(index));
+      }
+      cache_.Wake(index);
+    } else if (const ColliderId* static_id = static_cache_.FindId(collider);
+               static_id != nullptr) {
+      size_t index = static_cache_.GetIndex(*static_id);
+      sf::FloatRect old_bounds = static_cache_.GetBounds(index);
+      static_cache_.Refresh(index);
+      static_tree_.Update(*static_id, static_cache_.GetBounds(index));
+      // The sleeping colliders it left must end their collisions with it, and
+      // the ones it reached must start them.
+      WakeDynamicColliders(old_bounds);
+      WakeDynamicColliders(static_cache_.GetBounds(index));
+    }
+  }
+
+  dirty_colliders_.clear();
 }
 
-}  // namespace ng
\ No newline at end of file
+}  // namespace ng
@@ -1,35 +1,417 @@
 #pragma once
 
-#include <unordered_set>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 
+#include "broadphase.h"
 #include "collider.h"
+#include "collider_cache.h"
+#include "collision_filter.h"
+#include "derived.h"
+#include "dynamic_aabb_tree.h"
+#include "function_ref.h"
+#include "node.h"
+#include "raycast_hit.h"
+#include "thread_pool.h"
+#include "type_id.h"
 
 namespace ng {
 
 /// @brief Manages the physics simulation within a scene, primarily handling collision detection.
+///        Static colliders live in their own bounding volume hierarchy and are never tested against each other. Dynamic colliders that stay still long enough fall asleep and stop looking for collisions until they move again.
 class Physics {
-  // Collider needs to be able to call AddCollider, and RemoveCollider.
+  // Collider needs to be able to call AddCollider, RemoveCollider, RefreshCollisionFilter, RefreshStatic, and MarkDirty.
   friend class Collider;
+  // Scene needs to be able to call Step.
+  friend class Scene;
 
  public:
-  /// @brief Checks if a given collider overlaps with any other collider currently in the physics world.
+  /// @brief The number of ticks a dynamic collider must stay still before it falls asleep.
+  static constexpr uint32_t kTicksBeforeSleep = 60;
+
+  /// @brief A function called for each collider found by a query. Returning false stops the query.
+  using OverlapVisitor = FunctionRef<bool(const Collider&)>;
+
+  /// @brief Checks if a given collider overlaps with any other collider currently in the physics world. Colliders whose filters cannot collide with the given collider's are ignored.
   /// @param collider The Collider to check for overlaps.
   /// @return A vector of pointers to the Colliders that overlaps with the given collider, empty if no overlap is found.
   [[nodiscard]] std::vector<const Collider*> Overlap(
       const Collider& collider) const;
 
+  /// @brief Calls a visitor for every collider that overlaps with a given collider. Does not allocate.
+  /// @param collider The Collider to check for overlaps.
+  /// @param visitor Called once per overlapping Collider. Returning false stops the query.
+  /// @return False if the visitor stopped the query, true otherwise.
+  bool Overlap(const Collider& collider, OverlapVisitor visitor) const;
+
+  /// @brief Writes the colliders that overlap with a given collider to a caller-provided buffer. Does not allocate.
+  /// @param collider The Collider to check for overlaps.
+  /// @param hits The buffer the overlapping Colliders are written to. The query stops once it is full.
+  /// @return The number of Colliders written to hits.
+  size_t Overlap(const Collider& collider,
+                 std::span<const Collider*> hits) const;
+
+  /// @brief Returns the owners of exactly a given type of every collider that overlaps with a given collider. Filtering by type is an integer compare on each hit, without RTTI.
+  /// @tparam T The type of the owners to look for, must derive from Node.
+  /// @param collider The Collider to check for overlaps.
+  /// @return A vector of pointers to the owners of the overlapping Colliders, once per Collider, empty if no overlap is found.
+  template <Derived<Node> T>
+  [[nodiscard]] std::vector<T*> OverlapOwners(const Collider& collider) const {
+    std::vector<T*> owners;
+    OverlapOwners<T>(collider, [&owners](T& owner) -> bool {
+      owners.push_back(&owner);
+      return true;
+    });
+    return owners;
+  }
+
+  /// @brief Calls a visitor with the owner of every collider that overlaps with a given collider, if the owner is exactly of a given type. Does not allocate.
+  /// @tparam T The type of the owners to look for, must derive from Node.
+  /// @param collider The Collider to check for overlaps.
+  /// @param visitor Called once per overlapping Collider whose owner is of type T. Returning false stops the query.
+  /// @return False if the visitor stopped the query, true otherwise.
+  template <Derived<Node> T>
+  bool OverlapOwners(const Collider& collider,
+                     FunctionRef<bool(T&)> visitor) const {
+    TypeId type_id = TypeIdOf<T>();
+    return Overlap(collider, [type_id, visitor](const Collider& other) -> bool {
+      // An owner of unknown type would be missed even if it is a T.
+      assert(other.IsOwnerTypeKnown());
+      return other.GetOwnerTypeId() != type_id ||
+             visitor(*static_cast<T*>(other.GetParent()));
+    });
+  }
+
+  /// @brief Returns every collider that overlaps a world-space axis-aligned rectangle.
+  /// @param rect The rectangle to check for overlaps.
+  /// @param mask The collision categories to look for. Every category by default.
+  /// @return A vector of pointers to the Colliders that overlap with the rectangle, empty if no overlap is found.
+  [[nodiscard]] std::vector<const Collider*> OverlapRect(
+      const sf::FloatRect& rect, uint32_t mask = ~0U) const;
+
+  /// @brief Calls a visitor for every collider that overlaps a world-space axis-aligned rectangle. Does not allocate.
+  /// @param rect The rectangle to check for overlaps.
+  /// @param visitor Called once per overlapping Collider. Returning false stops the query.
+  /// @param mask The collision categories to look for. Every category by default.
+  /// @return False if the visitor stopped the query, true otherwise.
+  bool OverlapRect(const sf::FloatRect& rect, OverlapVisitor visitor,
+                   uint32_t mask = ~0U) const;
+
+  /// @brief Writes the colliders that overlap a world-space axis-aligned rectangle to a caller-provided buffer. Does not allocate.
+  /// @param rect The rectangle to check for overlaps.
+  /// @param hits The buffer the overlapping Colliders are written to. The query stops once it is full.
+  /// @param mask The collision categories to look for. Every category by default.
+  /// @return The number of Colliders written to hits.
+  size_t OverlapRect(const sf::FloatRect& rect,
+                     std::span<const Collider*> hits,
+                     uint32_t mask = ~0U) const;
+
+  /// @brief Returns every collider that contains a world-space point.
+  /// @param point The point to check.
+  /// @param mask The collision categories to look for. Every category by default.
+  /// @return A vector of pointers to the Colliders that contain the point, empty if none is found.
+  [[nodiscard]] std::vector<const Collider*> OverlapPoint(
+      sf::Vector2f point, uint32_t mask = ~0U) const;
+
+  /// @brief Calls a visitor for every collider that contains a world-space point. Does not allocate.
+  /// @param point The point to check.
+  /// @param visitor Called once per Collider containing the point. Returning false stops the query.
+  /// @param mask The collision categories to look for. Every category by default.
+  /// @return False if the visitor stopped the query, true otherwise.
+  bool OverlapPoint(sf::Vector2f point, OverlapVisitor visitor,
+                    uint32_t mask = ~0U) const;
+
+  /// @brief Writes the colliders that contain a world-space point to a caller-provided buffer. Does not allocate.
+  /// @param point The point to check.
+  /// @param hits The buffer the Colliders are written to. The query stops once it is full.
+  /// @param mask The collision categories to look for. Every category by default.
+  /// @return The number of Colliders written to hits.
+  size_t OverlapPoint(sf::Vector2f point, std::span<const Collider*> hits,
+                      uint32_t mask = ~0U) const;
+
+  /// @brief Casts a ray and returns the first collider it touches.
+  /// @param origin The world-space start of the ray.
+  /// @param direction The direction of the ray. Must not be zero.
+  /// @param max_distance The length of the ray.
+  /// @param mask The collision categories to look for. Every category by default.
+  /// @return The closest hit, or std::nullopt if the ray touches nothing.
+  [[nodiscard]] std::optional<RaycastHit> Raycast(sf::Vector2f origin,
+                                                  sf::Vector2f direction,
+                                                  float max_distance,
+                                                  uint32_t mask = ~0U) const;
+
+  /// @brief Casts a ray and returns every collider it touches.
+  /// @param origin The world-space start of the ray.
+  /// @param direction The direction of the ray. Must not be zero.
+  /// @param max_distance The length of the ray.
+  /// @param mask The collision categories to look for. Every category by default.
+  /// @return The hits, sorted from the closest to the farthest.
+  [[nodiscard]] std::vector<RaycastHit> RaycastAll(sf::Vector2f origin,
+                                                   sf::Vector2f direction,
+                                                   float max_distance,
+                                                   uint32_t mask = ~0U) const;
+
+  /// @brief Moves a circle or a rectangle along a direction and returns the first collider it touches.
+  /// @param shape The shape to move.
+  /// @param bounds The world-space bounding box of the shape at the start of the motion.
+  /// @param direction The direction of the motion. Must not be zero.
+  /// @param max_distance The length of the motion.
+  /// @param mask The collision categories to look for. Every category by default.
+  /// @return The closest hit, or std::nullopt if the shape touches nothing.
+  [[nodiscard]] std::optional<RaycastHit> ShapeCast(ColliderShape shape,
+                                                    const sf::FloatRect& bounds,
+                                                    sf::Vector2f direction,
+                                                    float max_distance,
+                                                    uint32_t mask = ~0U) const;
+
+  /// @brief Moves the shape of a collider along a direction and returns the first other collider it touches. Colliders whose filters cannot collide with the given collider's are ignored.
+  /// @param collider The Collider whose shape to move. The Collider itself does not move.
+  /// @param direction The direction of the motion. Must not be zero.
+  /// @param max_distance The length of the motion.
+  /// @return The closest hit, or std::nullopt if the shape touches nothing.
+  [[nodiscard]] std::optional<RaycastHit> ShapeCast(const Collider& collider,
+                                                    sf::Vector2f direction,
+                                                    float max_distance) const;
+
+  /// @brief Checks if a dynamic collider fell asleep, see kTicksBeforeSleep. A sleeping collider still gets OnCollisionStay for the collisions it had when it fell asleep.
+  /// @param collider The Collider to check.
+  /// @return True if the collider is dynamic, part of the physics world, and asleep, false otherwise.
+  [[nodiscard]] bool IsAsleep(const Collider& collider) const;
+
+  /// @brief Sets the broadphase used to cull dynamic collision candidates. Dynamic colliders already in the physics world are moved into it. Static colliders always use their own structure.
+  /// @param broadphase A unique pointer to the Broadphase to use. Ownership is transferred to the Physics. Can be null to test every collider (default).
+  void SetBroadphase(std::unique_ptr<Broadphase> broadphase);
+
+  /// @brief Sets the thread pool the search for overlapping pairs is spread over. The collision callbacks are still called on the stepping thread, in the same order whatever the number of threads.
+  /// @param thread_pool A pointer to the ThreadPool to use. The Physics does not own it, so it must outlive the Physics or be unset first. Can be null to search on the stepping thread only (default).
+  void SetThreadPool(ThreadPool* thread_pool);
+
  private:
+  /// @brief The number of awake colliders, or of broadphase candidate pairs, handled by a single task of the pair search.
+  static constexpr size_t kPairChunkSize = 128;
+
+  /// @brief A pair of overlapping colliders keyed by their registration ids, so sorting pairs compares integers and does not depend on where the colliders sit in memory.
+  struct ContactPair {
+    // The lower registration id of the two colliders.
+    uint64_t first_id = 0;
+    // The higher registration id of the two colliders.
+    uint64_t second_id = 0;
+    // The collider with the lower registration id.
+    const Collider* first = nullptr;
+    // The collider with the higher registration id.
+    const Collider* second = nullptr;
+
+    /// @brief Orders pairs by the id of their first collider, then by the id of their second collider.
+    /// @param other The pair to compare with.
+    /// @return True if this pair comes before the other pair.
+    bool operator<(const ContactPair& other) const {
+      return first_id != other.first_id ? first_id < other.first_id
+                                        : second_id < other.second_id;
+    }
+  };
+
+  /// @brief Keys a pair found by the pair search with the registration ids of its colliders.
+  /// @param a A pointer to one of the overlapping colliders. This pointer must not be null.
+  /// @param b A pointer to the other overlapping collider. This pointer must not be null.
+  /// @return The pair, with the collider added first in first place.
+  [[nodiscard]] static ContactPair MakeContactPair(const Collider* a,
+                                                   const Collider* b);
+
+  /// @brief The buffers used by a single task of the pair search. Kept across steps to reuse their storage.
+  struct PairBuffer {
+    std::vector<ContactPair> pairs;
+    std::vector<ColliderId> candidates;
+  };
+
+  /// @brief Finds every pair of overlapping colliders and notifies their owning nodes of the collisions that started, continued, or ended since the previous step.
+  ///        The callbacks follow the order the colliders were added in, see Collider::GetRegistrationId, so they are the same from run to run. Called by Scene once per tick.
+  void Step();
+
+  /// @brief Forgets the pairs of the colliders removed since the last step, in a single pass over the pairs, without notifying anyone.
+  void PurgeRemovedPairs();
+
+  /// @brief Fills new_pairs_ with every pair of overlapping colliders, sorted. Pairs without an awake collider are carried over from the previous step.
+  void FindOverlappingPairs();
+
+  /// @brief Finds the pairs that a range of awake dynamic colliders form with the other dynamic colliders. Each pair is found only once, from the collider with the lowest index. Safe to call from several threads at once.
+  /// @param begin The index of the first awake collider of the range.
+  /// @param end The index past the last awake collider of the range.
+  /// @param pairs The buffer the pairs are appended to, unsorted.
+  /// @param candidates The buffer used for the broadphase candidates.
+  void FindDynamicPairsOf(size_t begin, size_t end,
+                          std::vector<ContactPair>& pairs,
+                          std::vector<ColliderId>& candidates) const;
+
+  /// @brief Finds the pairs that a range of awake dynamic colliders form with the static colliders. Safe to call from several threads at once.
+  /// @param begin The index of the first awake collider of the range.
+  /// @param end The index past the last awake collider of the range.
+  /// @param pairs The buffer the pairs are appended to, unsorted.
+  /// @param candidates The buffer used for the broadphase candidates.
+  void FindStaticPairsOf(size_t begin, size_t end,
+                         std::vector<ContactPair>& pairs,
+                         std::vector<ColliderId>& candidates) const;
+
+  /// @brief Counts one more idle tick for every awake dynamic collider and puts the ones that stayed still long enough to sleep.
+  void UpdateSleep();
+
+  /// @brief Checks if a collider is dynamic and awake.
+  /// @param collider The Collider to check.
+  /// @return True if the collider is awake, false if it is asleep, static, or not part of the physics world.
+  [[nodiscard]] bool IsAwake(const Collider* collider) const;
+
+  /// @brief Returns the table a collider belongs to, depending on whether it is static.
+  /// @param collider The Collider. Must not be null.
+  /// @return A reference to the table of static or dynamic colliders.
+  [[nodiscard]] ColliderCache& GetCache(const Collider* collider) const;
+
+  /// @brief Calls a visitor for every collider that overlaps a shape. Does not allocate once the candidate buffer has grown.
+  /// @param shape The shape to check for overlaps.
+  /// @param bounds The world-space bounding box of the shape.
+  /// @param filter The collision filter of the shape.
+  /// @param ignored A collider to leave out of the result, usually the one the shape belongs to. Can be null.
+  /// @param visitor Called once per overlapping Collider. Returning false stops the query.
+  /// @return False if the visitor stopped the query, true otherwise.
+  bool VisitOverlaps(ColliderShape shape, const sf::FloatRect& bounds,
+                     CollisionFilter filter, const Collider* ignored,
+                     OverlapVisitor visitor) const;
+
+  /// @brief Takes the candidate buffer of the next nesting level of queries, so a visitor that runs another query does not clobber the buffer of the running one. Does not allocate once every level has been reached before.
+  /// @return The buffer, empty. Must be given back with ReturnCandidates before the query returns.
+  [[nodiscard]] std::vector<ColliderId> BorrowCandidates() const;
+
+  /// @brief Gives back the buffer taken by the last BorrowCandidates, keeping its storage for the next query at that level.
+  /// @param candidates The buffer returned by BorrowCandidates.
+  void ReturnCandidates(std::vector<ColliderId> candidates) const;
+
+  /// @brief Calls a visitor for every collider of a table that overlaps a shape, using a broadphase holding the same colliders to cull the candidates.
+  /// @param broadphase The Broadphase holding the colliders of the table.
+  /// @param cache The table to test.
+  /// @param shape The shape to check for overlaps.
+  /// @param bounds The world-space bounding box of the shape.
+  /// @param filter The collision filter of the shape.
+  /// @param ignored A collider to leave out of the result. Can be null.
+  /// @param visitor Called once per overlapping Collider. Returning false stops the query.
+  /// @return False if the visitor stopped the query, true otherwise.
+  bool VisitCandidates(const Broadphase& broadphase, const ColliderCache& cache,
+                       ColliderShape shape, const sf::FloatRect& bounds,
+                       CollisionFilter filter, const Collider* ignored,
+                       OverlapVisitor visitor) const;
+
+  /// @brief Calls a visitor for every collider touched by a shape moving along a direction, in no particular order. Does not allocate once the candidate buffer has grown.
+  /// @param shape The shape to move.
+  /// @param bounds The world-space bounding box of the shape at the start of the motion.
+  /// @param direction The unit direction of the motion.
+  /// @param max_distance The length of the motion.
+  /// @param filter The collision filter of the shape.
+  /// @param ignored A collider to leave out of the result, usually the one the shape belongs to. Can be null.
+  /// @param visitor Called once per hit.
+  void VisitCastHits(ColliderShape shape, const sf::FloatRect& bounds,
+                     sf::Vector2f direction, float max_distance,
+                     CollisionFilter filter, const Collider* ignored,
+                     FunctionRef<void(const RaycastHit&)> visitor) const;
+
+  /// @brief Calls a visitor for every collider of a table touched by a moving shape, using a broadphase holding the same colliders to cull the candidates.
+  /// @param broadphase The Broadphase holding the colliders of the table.
+  /// @param cache The table to test.
+  /// @param shape The shape to move.
+  /// @param bounds The world-space bounding box of the shape at the start of the motion.
+  /// @param direction The unit direction of the motion.
+  /// @param max_distance The length of the motion.
+  /// @param filter The collision filter of the shape.
+  /// @param ignored A collider to leave out of the result. Can be null.
+  /// @param visitor Called once per hit.
+  void VisitCastCandidates(const Broadphase& broadphase,
+                           const ColliderCache& cache, ColliderShape shape,
+                           const sf::FloatRect& bounds, sf::Vector2f direction,
+                           float max_distance, CollisionFilter filter,
+                           const Collider* ignored,
+                           FunctionRef<void(const RaycastHit&)> visitor) const;
+
+  /// @brief Finds the closest collider touched by a shape moving along a direction.
+  /// @param shape The shape to move.
+  /// @param bounds The world-space bounding box of the shape at the start of the motion.
+  /// @param direction The direction of the motion. Must not be zero.
+  /// @param max_distance The length of the motion.
+  /// @param filter The collision filter of the shape.
+  /// @param ignored A collider to leave out of the result. Can be null.
+  /// @return The closest hit, or std::nullopt if the shape touches nothing.
+  [[nodiscard]] std::optional<RaycastHit> CastClosest(
+      ColliderShape shape, const sf::FloatRect& bounds, sf::Vector2f direction,
+      float max_distance, CollisionFilter filter,
+      const Collider* ignored) const;
+
   /// @brief Adds a collider to the physics world for collision detection. Called by Collider during its addition to a scene.
   /// @param collider A pointer to the Collider to add. This pointer must not be null and the Collider's lifetime should be managed externally to this class.
-  void AddCollider(const Collider* collider);
+  /// @return The registration id of the collider, see Collider::GetRegistrationId.
+  [[nodiscard]] uint64_t AddCollider(const Collider* collider);
 
   /// @brief Removes a collider from the physics world. Called by Collider during its removal from a scene.
   /// @param collider A pointer to the Collider to remove. This pointer must not be null and the Collider's lifetime should be managed externally to this class.
   void RemoveCollider(const Collider* collider);
 
-  // A set containing pointers to all colliders in the physics world. The Physics class does not own these pointers.
-  std::unordered_set<const Collider*> colliders_;
+  /// @brief Picks up the new collision filter of a collider. Called by Collider when its filter changes.
+  /// @param collider A pointer to the Collider whose filter changed. This pointer must not be null.
+  void RefreshCollisionFilter(const Collider* collider);
+
+  /// @brief Moves a collider between the static and the dynamic colliders, keeping its current collisions. Called by Collider when it becomes static or dynamic.
+  /// @param collider A pointer to the Collider that changed. This pointer must not be null.
+  void RefreshStatic(const Collider* collider);
+
+  /// @brief Adds a collider to the table and the structure matching whether it is static.
+  /// @param collider A pointer to the Collider to add. This pointer must not be null.
+  void InsertCollider(const Collider* collider);
+
+  /// @brief Removes a collider from its table and structure, without touching its collisions.
+  /// @param collider A pointer to the Collider to remove. This pointer must not be null.
+  /// @param is_static Whether the collider is currently stored with the static colliders.
+  void EraseCollider(const Collider* collider, bool is_static);
+
+  /// @brief Schedules a collider's cached geometry to be refreshed before the next query. Called by Collider when its global transform changes.
+  /// @param collider A pointer to the Collider that moved. This pointer must not be null.
+  void MarkDirty(const Collider* collider);
+
+  /// @brief Wakes the sleeping dynamic colliders touching an area, so the next step finds their collisions with a static collider that changed there. The others stay asleep.
+  /// @param bounds The world-space area, usually the old or new bounding box of the static collider.
+  void WakeDynamicColliders(const sf::FloatRect& bounds) const;
+
+  /// @brief Refreshes the cached geometry and the structure entries of all the colliders that moved since the last query, and wakes them up, along with the sleeping colliders a moved static collider left or reached.
+  void SyncColliders() const;
+
+  // The geometry of the dynamic colliders in the physics world, awake ones first. The Physics class does not own the colliders. Mutable for lazy synchronization.
+  mutable ColliderCache cache_;
+  // The geometry of the static colliders in the physics world. Mutable for lazy synchronization.
+  mutable ColliderCache static_cache_;
+  // The structure culling the static collision candidates. Only changes when static colliders are added, removed, or moved. Mutable for lazy synchronization.
+  mutable DynamicAabbTree static_tree_;
+  // The broadphase used to cull collision candidates. Can be null, in which case every collider is tested. Mutable for lazy synchronization.
+  mutable std::unique_ptr<Broadphase> broadphase_;
+  // The thread pool the pair search is spread over. Can be null. Not owned by the Physics.
+  ThreadPool* thread_pool_ = nullptr;
+  // The candidate pairs found by the broadphase when every dynamic collider is awake, as ids of cache_. Kept as a member to reuse its storage.
+  std::vector<ColliderPair> candidate_pairs_;
+  // The buffers of the pair search tasks, one per chunk.
+  std::vector<PairBuffer> pair_buffers_;
+  // The registration id given to the next collider added.
+  uint64_t next_registration_id_ = 1;
+  // The pairs of colliders that overlapped during the last step, sorted. Persistent across steps.
+  std::vector<ContactPair> pairs_;
+  // The pairs of colliders found by the current step, sorted. Kept as a member to reuse its storage.
+  std::vector<ContactPair> new_pairs_;
+  // The registration ids of the colliders removed since the last step, whose pairs are purged at the beginning of the next one. Ids are never reused, unlike the addresses of the colliders.
+  std::vector<uint64_t> removed_ids_;
+  // The broadphase candidates of the running queries, one buffer per level of queries nested in visitors. Kept as a member to reuse their storage. Mutable because queries are const.
+  mutable std::vector<std::vector<ColliderId>> candidate_buffers_;
+  // The number of running queries, each one nested in the visitor of the previous one. Mutable because queries are const.
+  mutable size_t query_depth_ = 0;
+  // Colliders whose cached geometry is out of date. May contain duplicates and colliders that were removed since. Mutable for lazy synchronization.
+  mutable std::vector<const Collider*> dirty_colliders_;
 };
 
-}  // namespace ng
\ No newline at end of file
+}  // namespace ng
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+namespace ng {
+
+class Collider;
+
+/// @brief Describes where a ray or a moving shape first touched a collider.
+struct RaycastHit {
+  // The collider that was hit.
+  const Collider* collider = nullptr;
+  // The distance travelled along the cast direction before the hit. Zero if the cast started inside the collider.
+  float distance = 0;
+  // The unit surface normal of the collider at the hit, pointing against the cast. The reverse of the cast direction if it started inside the collider.
+  sf::Vector2f normal;
+};
+
+}  // namespace ng
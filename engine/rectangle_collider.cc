@@ -4,9 +4,12 @@
 #include <SFML/Graphics/RectangleShape.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 #endif
+#include <SFML/Graphics/Rect.hpp>
 #include <SFML/System/Vector2.hpp>
+#include <cmath>
 
 #include "app.h"
+#include "broadphase.h"
 #include "circle_collider.h"
 #include "collider.h"
 
@@ -31,22 +34,19 @@ bool RectangleCollider::Collides(const CircleCollider& other) const {
 }
 
 bool RectangleCollider::Collides(const RectangleCollider& other) const {
-  sf::Vector2f pos = GetGlobalTransform().getPosition();
-  sf::Vector2f otherPos = other.GetGlobalTransform().getPosition();
-  // Calculate the extents of both rectangles in world space.
-  sf::Vector2f halfSize =
-      size_.componentWiseMul(GetGlobalTransform().getScale()) / 2.F;
-  sf::Vector2f otherHalfSize =
-      other.size_.componentWiseMul(other.GetGlobalTransform().getScale()) / 2.F;
+  // Both rectangles are axis-aligned, so they are their own bounding boxes.
+  return Overlaps(GetBounds(), other.GetBounds());
+}
 
-  // Check for non-overlapping conditions on both x and y axes.
-  bool AisToTheRightOfB = pos.x - halfSize.x > otherPos.x + otherHalfSize.x;
-  bool AisToTheLeftOfB = pos.x + halfSize.x < otherPos.x - otherHalfSize.x;
-  bool AisBelowB = pos.y - halfSize.y > otherPos.y + otherHalfSize.y;
-  bool AisAboveB = pos.y + halfSize.y < otherPos.y - otherHalfSize.y;
+bool RectangleCollider::Collides(const sf::FloatRect& rect) const {
+  return Overlaps(GetBounds(), rect);
+}
 
-  // If any of the non-overlapping conditions are true, then they are not colliding.
-  return !(AisToTheRightOfB || AisToTheLeftOfB || AisAboveB || AisBelowB);
+sf::FloatRect RectangleCollider::ComputeBounds() const {
+  sf::Vector2f scale = GetGlobalScale();
+  sf::Vector2f size =
+      size_.componentWiseMul({std::abs(scale.x), std::abs(scale.y)});
+  return {GetGlobalPosition() - (size / 2.F), size};
 }
 
 #ifndef NDEBUG
@@ -56,7 +56,7 @@ void RectangleCollider::Draw(sf::RenderTarget& target) {
   shape.setOutlineThickness(2);
   shape.setFillColor(sf::Color::Transparent);
   shape.setOrigin(size_ / 2.F);
-  target.draw(shape, GetGlobalTransform().getTransform());
+  target.draw(shape, GetGlobalTransform());
 }
 #endif
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/System/Vector2.hpp>
 
@@ -34,7 +35,14 @@ class RectangleCollider : public Collider {
   /// @return True if a collision occurs, false otherwise.
   [[nodiscard]] bool Collides(const RectangleCollider& other) const override;
 
+  /// @brief Checks for collision with a world-space axis-aligned rectangle.
+  /// @param rect The rectangle to check against.
+  /// @return True if a collision occurs, false otherwise.
+  [[nodiscard]] bool Collides(const sf::FloatRect& rect) const override;
+
  protected:
+  [[nodiscard]] sf::FloatRect ComputeBounds() const override;
+
 #ifndef NDEBUG
   /// @brief Draw the collider's bounds for debugging purposes.
   /// @param target The SFML RenderTarget to draw to.
@@ -1,26 +1,51 @@
 #include "scene.h"
 
 #include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Transform.hpp>
 #include <SFML/System/Vector2.hpp>
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #include "app.h"
 #include "camera.h"
 #include "camera_manager.h"
+#include "component_store.h"
 #include "layer.h"
+#include "name_table.h"
 #include "node.h"
+#include "node_arena.h"
 #include "physics.h"
+#include "thread_pool.h"
+#include "type_id.h"
 
 namespace ng {
 
-Scene::Scene(App* app) : root_(std::make_unique<Node>(app)) {
+Scene::Scene(App* app)
+    : app_(app),
+      node_arena_(app->TakeNodeArena()),
+      root_(std::make_unique<Node>(app)) {
   assert(app);
   root_->SetName("SceneRoot");
   // Render all layers by default on the root node.
   root_->SetLayer(static_cast<Layer>(~0ULL));
+  // The root has nothing to update.
+  root_->has_update_ = false;
+  root_->arena_ = node_arena_.get();
+}
+
+Scene::~Scene() {
+  // Every node must give its memory back before the arena is recycled.
+  root_ = nullptr;
+  app_->RecycleNodeArena(std::move(node_arena_));
 }
 
 const std::string& Scene::GetName() const {
@@ -43,12 +68,53 @@ Physics& Scene::GetMutablePhysics() {
   return physics_;
 }
 
-void Scene::AddChild(std::unique_ptr<Node> new_child) {
-  root_->AddChild(std::move(new_child));
+const ComponentStore& Scene::GetComponents() const {
+  return components_;
+}
+
+ComponentStore& Scene::GetMutableComponents() {
+  return components_;
+}
+
+Scene::AffineTransform Scene::ToAffine(const sf::Transform& transform) {
+  auto matrix = std::span(transform.getMatrix(), 16);
+  return {.a00 = matrix[0],
+          .a01 = matrix[4],
+          .a02 = matrix[12],
+          .a10 = matrix[1],
+          .a11 = matrix[5],
+          .a12 = matrix[13]};
+}
+
+Scene::AffineTransform Scene::Combine(const AffineTransform& parent,
+                                      const AffineTransform& local) {
+  return {.a00 = (parent.a00 * local.a00) + (parent.a01 * local.a10),
+          .a01 = (parent.a00 * local.a01) + (parent.a01 * local.a11),
+          .a02 = (parent.a00 * local.a02) + (parent.a01 * local.a12) +
+                 parent.a02,
+          .a10 = (parent.a10 * local.a00) + (parent.a11 * local.a10),
+          .a11 = (parent.a10 * local.a01) + (parent.a11 * local.a11),
+          .a12 = (parent.a10 * local.a02) + (parent.a11 * local.a12) +
+                 parent.a12};
 }
 
-bool Scene::IsValid(const Node* node) const {
-  return scene_nodes_.contains(node);
+void Scene::SetBatchedTransforms(bool enabled) {
+  bool was_queueing = IsQueueingTransformRoots();
+  is_batching_transforms_ = enabled;
+  RefreshTransformQueue(was_queueing);
+}
+
+void Scene::SetThreadPool(ThreadPool* thread_pool) {
+  bool was_queueing = IsQueueingTransformRoots();
+  thread_pool_ = thread_pool;
+  RefreshTransformQueue(was_queueing);
+}
+
+std::unique_lock<std::recursive_mutex> Scene::LockSharedState() {
+  if (!is_updating_in_parallel_) {
+    return {};
+  }
+  return std::unique_lock(shared_state_mutex_);
 }
 
 void Scene::OnWindowResize(sf::Vector2u size) {
@@ -60,10 +126,15 @@ void Scene::InternalOnAdd() {
 }
 
 void Scene::InternalUpdate() {
-  root_->InternalUpdate();
+  ApplyChildrenChanges();
+  UpdateListedNodes();
+  UpdateParallelSubtrees();
+  PropagateTransforms();
+  physics_.Step();
 }
 
 void Scene::InternalDraw(sf::RenderTarget& target) {
+  PropagateTransforms();
   for (const Camera* camera : camera_manager_.GetCameras()) {
     target.setView(camera->GetView());
     root_->InternalDraw(*camera, target);
@@ -74,14 +145,364 @@ void Scene::InternalOnDestroy() {
   root_->InternalOnDestroy();
 }
 
-void Scene::RegisterNode(const Node* node) {
+Node* Scene::FindByName(NameId name_id) const {
+  auto it = nodes_by_name_.find(name_id);
+  if (it == nodes_by_name_.end() || it->second.empty()) {
+    return nullptr;
+  }
+  return it->second.front();
+}
+
+Node* Scene::FindByName(std::string_view name) const {
+  return FindByName(HashName(name));
+}
+
+void Scene::RegisterNode(Node* node) {
+  assert(node);
+  IndexName(node);
+  if (node->has_update_) {
+    ListUpdate(node);
+  }
+  TypeId type_id = node->GetTypeId();
+  if (type_id == kNoTypeId) {
+    return;
+  }
+
+  if (type_id >= nodes_by_type_.size()) {
+    nodes_by_type_.resize(type_id + 1);
+  }
+  std::vector<Node*>& nodes = nodes_by_type_[type_id];
+  node->type_registry_index_ = nodes.size();
+  nodes.push_back(node);
+}
+
+void Scene::UnregisterNode(Node* node) {
+  assert(node);
+  UnindexName(node);
+  if (node->update_index_ != Node::kNotInUpdateList) {
+    update_list_[node->update_index_] = nullptr;
+    node->update_index_ = Node::kNotInUpdateList;
+    ++update_list_hole_count_;
+  }
+  TypeId type_id = node->GetTypeId();
+  if (type_id == kNoTypeId) {
+    return;
+  }
+
+  // Swaps the node with the last one of its type, so removal is O(1).
+  std::vector<Node*>& nodes = nodes_by_type_[type_id];
+  Node* last = nodes.back();
+  nodes[node->type_registry_index_] = last;
+  last->type_registry_index_ = node->type_registry_index_;
+  nodes.pop_back();
+}
+
+void Scene::IndexName(Node* node) {
+  assert(node);
+  if (node->name_ == kNoName) {
+    return;
+  }
+
+  std::vector<Node*>& nodes = nodes_by_name_[node->name_];
+  node->name_index_ = static_cast<uint32_t>(nodes.size());
+  nodes.push_back(node);
+}
+
+void Scene::UnindexName(Node* node) {
+  assert(node);
+  if (node->name_index_ == Node::kNotInNameIndex) {
+    return;
+  }
+
+  // Swaps the node with the last one of its name, so removal is O(1).
+  std::vector<Node*>& nodes = nodes_by_name_[node->name_];
+  Node* last = nodes.back();
+  nodes[node->name_index_] = last;
+  last->name_index_ = node->name_index_;
+  nodes.pop_back();
+  node->name_index_ = Node::kNotInNameIndex;
+}
+
+const std::vector<Node*>* Scene::FindNodesOfType(TypeId type_id) const {
+  if (type_id >= nodes_by_type_.size()) {
+    return nullptr;
+  }
+  return &nodes_by_type_[type_id];
+}
+
+bool Scene::IsQueueingTransformRoots() const {
+  return is_batching_transforms_ || thread_pool_ != nullptr;
+}
+
+void Scene::RefreshTransformQueue(bool was_queueing) {
+  if (IsQueueingTransformRoots()) {
+    // Subtrees dirtied while the queue was off were not recorded.
+    if (!was_queueing) {
+      QueueDirtySubtrees(root_.get());
+    }
+    return;
+  }
+
+  for (const Node* node : transform_roots_) {
+    if (node != nullptr) {
+      node->transform_root_index_ = Node::kNotQueued;
+    }
+  }
+  transform_roots_.clear();
+}
+
+void Scene::QueueDirtySubtrees(const Node* node) {
+  assert(node);
+  if (node->is_global_transform_dirty_) {
+    QueueTransformRoot(node);
+    return;
+  }
+  for (const auto& child : node->children_) {
+    QueueDirtySubtrees(child.get());
+  }
+}
+
+void Scene::QueueTransformRoot(const Node* node) {
+  assert(node);
+  std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+  // A node read since it was queued may be dirtied again before the pass.
+  if (!IsQueueingTransformRoots() ||
+      node->transform_root_index_ != Node::kNotQueued) {
+    return;
+  }
+
+  node->transform_root_index_ = transform_roots_.size();
+  transform_roots_.push_back(node);
+}
+
+void Scene::QueueTransformChildren(const Node* node) {
   assert(node);
-  scene_nodes_.insert(node);
+  if (!IsQueueingTransformRoots()) {
+    return;
+  }
+
+  std::unique_lock<std::recursive_mutex> lock = LockSharedState();
+  for (const auto& child : node->children_) {
+    QueueTransformRoot(child.get());
+  }
 }
 
-void Scene::UnregisterNode(const Node* node) {
+void Scene::UnqueueTransformRoot(const Node* node) {
   assert(node);
-  scene_nodes_.erase(node);
+  if (node->transform_root_index_ == Node::kNotQueued) {
+    return;
+  }
+
+  transform_roots_[node->transform_root_index_] = nullptr;
+  node->transform_root_index_ = Node::kNotQueued;
+}
+
+void Scene::ListUpdate(Node* node) {
+  assert(node);
+  node->update_index_ = update_list_.size();
+  update_list_.push_back(node);
+  // The node has no children yet, so it is last in hierarchy order when it
+  // and each of its ancestors are the last children of their parents, which
+  // is the common case of nodes spawned under the scene root. Otherwise its
+  // place is found by the next rebuild.
+  for (const Node* ancestor = node;
+       ancestor->parent_ != nullptr && !is_update_list_unordered_;
+       ancestor = ancestor->parent_) {
+    if (ancestor->index_in_parent_ + 1 != ancestor->parent_->children_.size()) {
+      is_update_list_unordered_ = true;
+    }
+  }
+}
+
+void Scene::RebuildUpdateList() {
+  update_list_.clear();
+  update_list_hole_count_ = 0;
+  is_update_list_unordered_ = false;
+
+  // An explicit stack, so deep hierarchies cannot overflow the call stack.
+  // Children are pushed last to first so they are popped in order.
+  update_list_stack_.assign(1, root_.get());
+  while (!update_list_stack_.empty()) {
+    Node* node = update_list_stack_.back();
+    update_list_stack_.pop_back();
+    if (node->update_index_ != Node::kNotInUpdateList) {
+      node->update_index_ = update_list_.size();
+      update_list_.push_back(node);
+    }
+    for (auto it = node->children_.rbegin(); it != node->children_.rend();
+         ++it) {
+      update_list_stack_.push_back(it->get());
+    }
+  }
+}
+
+void Scene::CompactUpdateList() {
+  if (update_list_hole_count_ == 0) {
+    return;
+  }
+
+  size_t kept = 0;
+  for (Node* node : update_list_) {
+    if (node == nullptr) {
+      continue;
+    }
+    node->update_index_ = kept;
+    update_list_[kept] = node;
+    ++kept;
+  }
+  update_list_.resize(kept);
+  update_list_hole_count_ = 0;
+}
+
+void Scene::QueueChildrenChanges(Node* node) {
+  assert(node);
+  if (node->children_changes_index_ != Node::kNotQueued) {
+    return;
+  }
+
+  node->children_changes_index_ = children_changes_.size();
+  children_changes_.push_back(node);
+}
+
+void Scene::UnqueueChildrenChanges(Node* node) {
+  assert(node);
+  if (node->children_changes_index_ == Node::kNotQueued) {
+    return;
+  }
+
+  children_changes_[node->children_changes_index_] = nullptr;
+  node->children_changes_index_ = Node::kNotQueued;
+}
+
+void Scene::ApplyChildrenChanges() {
+  // Added nodes queue their own children, and destroyed or added nodes may
+  // queue more changes, so the queue may grow during the loop.
+  for (size_t i = 0; i < children_changes_.size(); ++i) {
+    Node* node = children_changes_[i];
+    if (node == nullptr) {
+      continue;
+    }
+    node->children_changes_index_ = Node::kNotQueued;
+    node->InternalApplyQueuedChildren();
+  }
+  children_changes_.clear();
+}
+
+void Scene::UpdateListedNodes() {
+  if (is_update_list_unordered_) {
+    RebuildUpdateList();
+  } else {
+    CompactUpdateList();
+  }
+  // Nodes added or destroyed by an update are only queued, so the list does
+  // not change during the loop.
+  for (size_t i = 0; i < update_list_.size(); ++i) {
+    Node* node = update_list_[i];
+    const Node* parallel_root =
+        thread_pool_ != nullptr ? node->parallel_root_ : nullptr;
+    if (parallel_root == nullptr) {
+      node->Update();
+      continue;
+    }
+
+    // The nodes of a subtree are next to each other in hierarchy order.
+    if (parallel_subtrees_.empty() ||
+        parallel_subtrees_.back().root != parallel_root) {
+      parallel_subtrees_.push_back(
+          {.root = parallel_root, .begin = i, .end = i + 1});
+    } else {
+      parallel_subtrees_.back().end = i + 1;
+    }
+  }
+}
+
+void Scene::UpdateParallelSubtrees() {
+  if (parallel_subtrees_.empty()) {
+    return;
+  }
+
+  // The serial pass may have moved any node, such as the parents of the
+  // subtrees or a tilemap they collide with. Computing every dirty global
+  // transform now means the subtrees only ever read the ones outside of
+  // themselves, instead of computing and writing them on demand.
+  PropagateTransforms();
+
+  size_t chunk_count =
+      (parallel_subtrees_.size() + kParallelUpdateChunkSize - 1) /
+      kParallelUpdateChunkSize;
+  if (deferred_changes_.size() < chunk_count) {
+    deferred_changes_.resize(chunk_count);
+  }
+
+  auto update_chunk = [this](size_t chunk) -> void {
+    size_t begin = chunk * kParallelUpdateChunkSize;
+    size_t end =
+        std::min(begin + kParallelUpdateChunkSize, parallel_subtrees_.size());
+    for (size_t i = begin; i < end; ++i) {
+      const ParallelSubtree& subtree = parallel_subtrees_[i];
+      Node::InternalParallelUpdate(
+          std::span(update_list_)
+              .subspan(subtree.begin, subtree.end - subtree.begin),
+          deferred_changes_[chunk]);
+    }
+  };
+
+  is_updating_in_parallel_ = true;
+  thread_pool_->ParallelFor(chunk_count, update_chunk);
+  is_updating_in_parallel_ = false;
+
+  // Applying the changes chunk by chunk keeps their order independent of
+  // which thread ran which chunk.
+  for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+    Node::ApplyDeferredChanges(deferred_changes_[chunk]);
+  }
+  parallel_subtrees_.clear();
+}
+
+void Scene::PropagateTransforms() {
+  // Computing a dirty ancestor on demand below queues more roots, so the
+  // queue may grow during the loop.
+  for (size_t r = 0; r < transform_roots_.size(); ++r) {
+    const Node* root = transform_roots_[r];
+    if (root == nullptr) {
+      continue;
+    }
+    root->transform_root_index_ = Node::kNotQueued;
+
+    AffineTransform root_global = ToAffine(root->global_transform_);
+    if (root->is_global_transform_dirty_) {
+      root_global = ToAffine(root->GetLocalTransform().getTransform());
+      if (root->parent_ != nullptr) {
+        root_global =
+            Combine(ToAffine(root->parent_->GetGlobalTransform()), root_global);
+      }
+    }
+
+    transform_order_.assign(1, root);
+    global_transforms_.assign(1, root_global);
+
+    // Children of a dirty node are always dirty, so stopping at clean nodes
+    // still reaches every dirty node of the subtree. Parents come before
+    // their children, so each global transform is final once computed.
+    for (size_t i = 0; i < transform_order_.size(); ++i) {
+      const AffineTransform& global = global_transforms_[i];
+      const Node* node = transform_order_[i];
+      node->global_transform_ = sf::Transform(global.a00, global.a01,
+                                              global.a02, global.a10,
+                                              global.a11, global.a12, 0, 0, 1);
+      node->is_global_transform_dirty_ = false;
+      for (const auto& child : node->children_) {
+        if (child->is_global_transform_dirty_) {
+          transform_order_.push_back(child.get());
+          global_transforms_.push_back(
+              Combine(global_transforms_[i],
+                      ToAffine(child->GetLocalTransform().getTransform())));
+        }
+      }
+    }
+  }
+
+  transform_roots_.clear();
 }
 
 }  // namespace ng
@@ -1,14 +1,26 @@
 #pragma once
 
 #include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Transform.hpp>
+#include <cstddef>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <unordered_set>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 #include "camera_manager.h"
+#include "component_store.h"
 #include "derived.h"
+#include "function_ref.h"
+#include "name_table.h"
 #include "node.h"
+#include "node_arena.h"
 #include "physics.h"
+#include "thread_pool.h"
+#include "type_id.h"
 
 namespace ng {
 
@@ -20,12 +32,21 @@ class Scene {
   // App needs to be able to call InternalOnAdd, InternalUpdate,
   // InternalDraw, and InternalOnDestroy.
   friend class App;
-  // Node needs to be able to call RegisterNode, and UnregisterNode.
+  // Node needs to be able to call RegisterNode, UnregisterNode, IndexName,
+  // UnindexName, QueueTransformRoot, QueueTransformChildren,
+  // UnqueueTransformRoot, QueueChildrenChanges, and UnqueueChildrenChanges.
   friend class Node;
 
   /// @brief Constructs a Scene associated with a specific App instance.
   /// @param app A pointer to the App instance this scene belongs to. This pointer must not be null.
   explicit Scene(App* app);
+  /// @brief Destroys the nodes of the scene and hands its NodeArena back to the App for the next scene.
+  ~Scene();
+
+  Scene(const Scene& other) = delete;
+  Scene& operator=(const Scene& other) = delete;
+  Scene(Scene&& other) = delete;
+  Scene& operator=(Scene&& other) = delete;
 
   /// @brief Returns the name of the scene.
   /// @return A constant reference to the scene's name.
@@ -47,9 +68,21 @@ class Scene {
   /// @return A mutable reference to the Physics engine.
   [[nodiscard]] Physics& GetMutablePhysics();
 
-  /// @brief Adds a new child node to the root of the scene. Ownership of the node is transferred to the scene.
+  /// @brief Returns a constant reference to the ComponentStore holding the components of the scene's entities.
+  /// @return A constant reference to the ComponentStore.
+  [[nodiscard]] const ComponentStore& GetComponents() const;
+
+  /// @brief Returns a mutable reference to the ComponentStore holding the components of the scene's entities. Systems iterate its packed arrays, and nodes add their components to it with Node::AddComponent.
+  /// @return A mutable reference to the ComponentStore.
+  [[nodiscard]] ComponentStore& GetMutableComponents();
+
+  /// @brief Adds a new child node to the root of the scene. Ownership of the node is transferred to the scene. Its type is recorded as by Node::AddChild.
+  /// @tparam T The static type of the node, must derive from Node.
   /// @param new_child A unique pointer to the Node to be added. This pointer must not be null.
-  void AddChild(std::unique_ptr<Node> new_child);
+  template <Derived<Node> T>
+  void AddChild(std::unique_ptr<T> new_child) {
+    root_->AddChild(std::move(new_child));
+  }
 
   /// @brief Creates and adds a new child node of the specified type to the root of the scene.
   /// @tparam T The type of the Node to create, must derive from Node.
@@ -61,15 +94,66 @@ class Scene {
     return root_->MakeChild<T>(std::forward<Args>(args)...);
   }
 
-  /// @brief Checks if a given Node pointer is currently registered within this scene.
-  /// @param node A pointer to the Node to check. Can be null (no-op).
-  /// @return True if the Node is valid and belongs to this scene, false otherwise.
-  bool IsValid(const Node* node) const;
+  /// @brief Calls a function for every node of the scene whose exact type is T, in no particular order. No RTTI is involved, and nodes of other types are never visited.
+  ///        Only nodes whose type is recorded are known by type, see Node::GetTypeId. Nodes added or destroyed by the function are only taken into account from the next tick.
+  /// @tparam T The type of the nodes, must derive from Node.
+  /// @param func The function to call with each node.
+  template <Derived<Node> T>
+  void ForEach(std::type_identity_t<FunctionRef<void(T&)>> func) const {
+    const std::vector<Node*>* nodes = FindNodesOfType(TypeIdOf<T>());
+    if (nodes == nullptr) {
+      return;
+    }
+    for (Node* node : *nodes) {
+      func(*static_cast<T*>(node));
+    }
+  }
+
+  /// @brief Returns a node of the scene whose exact type is T. Only nodes whose type is recorded are known by type, see Node::GetTypeId.
+  /// @tparam T The type of the node, must derive from Node.
+  /// @return A pointer to the first node of type T in the registry, or nullptr if the scene has none. Which node comes first may change as nodes are destroyed.
+  template <Derived<Node> T>
+  [[nodiscard]] T* FindFirst() const {
+    const std::vector<Node*>* nodes = FindNodesOfType(TypeIdOf<T>());
+    if (nodes == nullptr || nodes->empty()) {
+      return nullptr;
+    }
+    return static_cast<T*>(nodes->front());
+  }
+
+  /// @brief Finds a node of the scene by name with a single hash lookup.
+  /// @param name_id The id of the name, e.g. HashName("Player").
+  /// @return A pointer to a node with this name, or nullptr if the scene has none. Which node is returned among several with the same name may change as nodes are destroyed.
+  [[nodiscard]] Node* FindByName(NameId name_id) const;
+
+  /// @brief Finds a node of the scene by name with a single hash lookup.
+  /// @param name The name of the node.
+  /// @return A pointer to a node with this name, or nullptr if the scene has none.
+  [[nodiscard]] Node* FindByName(std::string_view name) const;
+
+  /// @brief Enables or disables the batched transform pass. When enabled, the global transforms of every node moved during a tick are computed once, in hierarchy order, before the physics step and before drawing.
+  ///        Nodes that are read before the pass still compute their global transform on demand, so the results are the same either way.
+  ///        The pass also runs while a thread pool is set, see SetThreadPool.
+  /// @param enabled True to run the pass, false to compute every global transform on demand (default).
+  void SetBatchedTransforms(bool enabled);
+
+  /// @brief Sets the thread pool the independent subtrees are updated over, see Node::SetParallelUpdate. Each thread claims the next few subtrees as soon as it is done with its previous ones, so uneven subtrees still keep every thread busy.
+  ///        While a pool is set, the batched transform pass runs before the subtrees are updated too, so they never compute the global transform of a node outside of themselves.
+  /// @param thread_pool A pointer to the ThreadPool to use. The Scene does not own it, so it must outlive the Scene or be unset first. Can be null to update every node on the calling thread, in tree order (default).
+  void SetThreadPool(ThreadPool* thread_pool);
+
+  /// @brief Locks the state shared by the subtrees updated in parallel, such as the physics world, the components, and nodes outside of the calling subtree.
+  ///        The engine takes this lock itself when a parallel update creates or renames nodes, or moves a collider.
+  /// @return A lock to keep while the shared state is accessed. It owns nothing outside of parallel updates, so taking it costs nothing on a single thread.
+  [[nodiscard]] std::unique_lock<std::recursive_mutex> LockSharedState();
 
  private:
+  /// @brief The number of independent subtrees updated by a single task of the parallel update.
+  static constexpr size_t kParallelUpdateChunkSize = 16;
+
   /// @brief Internal method called when the scene is added to the App. Notifies the root node.
   void InternalOnAdd();
-  /// @brief Internal method called during the game loop to update the scene's logic. Updates the root node.
+  /// @brief Internal method called during the game loop to update the scene's logic. Applies the queued children changes, updates the nodes of the update list, then the independent subtrees in parallel, propagates the transforms if batched, then steps the physics.
   void InternalUpdate();
   /// @brief Internal method called during the game loop to draw the scene. Draws the root node through each camera.
   /// @param target The SFML RenderTarget to draw to.
@@ -77,17 +161,71 @@ class Scene {
   /// @brief Internal method called when the scene is about to be destroyed or unloaded. Notifies the root node.
   void InternalOnDestroy();
 
-  /// @brief Registers a Node with the scene, allowing for quick validation. Called by Node during its addition to the hierarchy.
+  /// @brief Adds a Node to the registry of its type and, if it has an Update, to the update list. Called by Node during its addition to the hierarchy.
   /// @param node A pointer to the Node being registered. This pointer must not be null.
-  void RegisterNode(const Node* node);
-  /// @brief Unregisters a Node from the scene. Called by Node during its removal from the hierarchy.
+  void RegisterNode(Node* node);
+  /// @brief Removes a Node from the registry of its type and from the update list. Called by Node during its removal from the hierarchy.
   /// @param node A pointer to the Node being unregistered. This pointer must not be null.
-  void UnregisterNode(const Node* node);
+  void UnregisterNode(Node* node);
+  /// @brief Adds a registered Node to the index entry of its name. No-op for nodes without a name. Called by Node when it is registered or renamed.
+  /// @param node A pointer to the Node. This pointer must not be null.
+  void IndexName(Node* node);
+  /// @brief Removes a Node from the index entry of its name. No-op if the node is not indexed. Called by Node when it is unregistered or renamed.
+  /// @param node A pointer to the Node. This pointer must not be null.
+  void UnindexName(Node* node);
+  /// @brief Returns the registered nodes of a type.
+  /// @param type_id The TypeId of the nodes.
+  /// @return A pointer to the nodes, or nullptr if no node of this type was ever registered.
+  [[nodiscard]] const std::vector<Node*>* FindNodesOfType(TypeId type_id) const;
+
+  /// @brief Returns whether moved subtrees are queued for the batched transform pass, which runs when it is enabled or a thread pool is set.
+  /// @return True if the pass runs.
+  [[nodiscard]] bool IsQueueingTransformRoots() const;
+  /// @brief Starts or stops queueing moved subtrees after SetBatchedTransforms or SetThreadPool. Queues the subtrees that became dirty while the queue was off, or forgets the queue once it is off.
+  /// @param was_queueing Whether moved subtrees were queued before the change.
+  void RefreshTransformQueue(bool was_queueing);
+  /// @brief Queues the top node of every dirty subtree of a subtree.
+  /// @param node A pointer to the root of the subtree. This pointer must not be null.
+  void QueueDirtySubtrees(const Node* node);
+  /// @brief Records a node whose global transform became dirty while its parent's did not, so that the batched transform pass visits its subtree. No-op if the pass is disabled or the node is queued already. Called by Node.
+  /// @param node A pointer to the Node whose subtree is dirty. This pointer must not be null.
+  void QueueTransformRoot(const Node* node);
+  /// @brief Records the children of a node whose global transform was computed on demand, as they are now the tops of dirty subtrees. No-op if the pass is disabled. Called by Node.
+  /// @param node A pointer to the Node that was computed. This pointer must not be null.
+  void QueueTransformChildren(const Node* node);
+  /// @brief Forgets a queued node. Called by Node when it is destroyed.
+  /// @param node A pointer to the Node. This pointer must not be null.
+  void UnqueueTransformRoot(const Node* node);
+  /// @brief Computes the global transforms of the dirty subtrees of every queued node, parents before children, and clears the queue.
+  void PropagateTransforms();
+
+  /// @brief Appends a Node to the update list. Unless the node is last in hierarchy order, marks the list for a rebuild, which puts the node at its place. Called when the node is registered.
+  /// @param node A pointer to the Node. This pointer must not be null.
+  void ListUpdate(Node* node);
+  /// @brief Rebuilds the update list in hierarchy order with a single walk of the scene, dropping the null entries left by destroyed nodes.
+  void RebuildUpdateList();
+  /// @brief Removes the null entries left by destroyed nodes from the update list in a single pass, keeping the order of the others.
+  void CompactUpdateList();
+  /// @brief Records a node whose children must be erased or added at the beginning of the next update. No-op if the node is queued already. Called by Node.
+  /// @param node A pointer to the Node. This pointer must not be null.
+  void QueueChildrenChanges(Node* node);
+  /// @brief Forgets a queued node. Called by Node when it is destroyed.
+  /// @param node A pointer to the Node. This pointer must not be null.
+  void UnqueueChildrenChanges(Node* node);
+  /// @brief Erases and adds the queued children of every queued node, including the nodes queued meanwhile, and clears the queue.
+  void ApplyChildrenChanges();
+  /// @brief Updates the nodes of the update list in order, after rebuilding the list if nodes were listed since the last update. With a thread pool, the nodes of the independent subtrees are set aside for UpdateParallelSubtrees instead.
+  void UpdateListedNodes();
+  /// @brief Updates the independent subtrees set aside by UpdateListedNodes over the thread pool, then applies the nodes they added or destroyed, subtree by subtree.
+  void UpdateParallelSubtrees();
 
   /// @brief Called when the game window is resized. Notifies the CameraManager to update its cameras.
   /// @param new_size The new size of the window.
   void OnWindowResize(sf::Vector2u new_size);
 
+  // Pointer to the App instance. Never null after construction.
+  App* app_ = nullptr;
+
   // The name of the scene.
   std::string name_;
 
@@ -95,9 +233,81 @@ class Scene {
   CameraManager camera_manager_;
   // Handles the physics simulation for the scene.
   Physics physics_;
+  // Holds the components of the scene's entities, including the ones owned by nodes.
+  ComponentStore components_;
+
+  /// @brief The six meaningful coefficients of a 2D affine transformation matrix, row by row.
+  struct AffineTransform {
+    float a00 = 1;
+    float a01 = 0;
+    float a02 = 0;
+    float a10 = 0;
+    float a11 = 1;
+    float a12 = 0;
+  };
+
+  /// @brief Extracts the affine part of a transformation matrix.
+  /// @param transform The transformation matrix.
+  /// @return The coefficients of the affine transformation.
+  [[nodiscard]] static AffineTransform ToAffine(const sf::Transform& transform);
+
+  /// @brief Combines two affine transformations, the equivalent of multiplying their 3x3 matrices.
+  /// @param parent The transformation applied last.
+  /// @param local The transformation applied first.
+  /// @return The combined transformation.
+  [[nodiscard]] static AffineTransform Combine(const AffineTransform& parent,
+                                               const AffineTransform& local);
+
+  // Whether the batched transform pass was enabled by SetBatchedTransforms.
+  bool is_batching_transforms_ = false;
+  // The nodes whose subtree became dirty since the last pass. Destroyed nodes are replaced by null.
+  std::vector<const Node*> transform_roots_;
+  // The dirty nodes of the subtree being propagated, parents before children. Kept as a member to reuse its storage.
+  std::vector<const Node*> transform_order_;
+  // The global transform of each node of transform_order_. Kept as a member to reuse its storage.
+  std::vector<AffineTransform> global_transforms_;
+
+  // The registered nodes of each type, indexed by TypeId. Each node knows its index in the vector of its type.
+  std::vector<std::vector<Node*>> nodes_by_type_;
+
+  // The registered nodes with each name. Each node knows its index in the vector of its name.
+  std::unordered_map<NameId, std::vector<Node*>> nodes_by_name_;
+
+  // The nodes called by the update phase, in hierarchy order. Destroyed nodes are replaced by null until the next compaction.
+  std::vector<Node*> update_list_;
+  // The number of null entries in update_list_.
+  size_t update_list_hole_count_ = 0;
+  // Whether nodes were appended to update_list_ since its last rebuild, so it may not be in hierarchy order.
+  bool is_update_list_unordered_ = false;
+  // The nodes left to visit by RebuildUpdateList. Kept as a member to reuse its storage.
+  std::vector<Node*> update_list_stack_;
+  // The nodes whose children must be erased or added at the beginning of the next update. Destroyed nodes are replaced by null.
+  std::vector<Node*> children_changes_;
+
+  /// @brief The nodes of an independent subtree, a contiguous range of the update list.
+  struct ParallelSubtree {
+    // The root of the subtree.
+    const Node* root = nullptr;
+    // The index in the update list of the first node of the subtree.
+    size_t begin = 0;
+    // The index in the update list past the last node of the subtree.
+    size_t end = 0;
+  };
+
+  // The thread pool the independent subtrees are updated over. Not owned, can be null.
+  ThreadPool* thread_pool_ = nullptr;
+  // The independent subtrees to update after the serial pass, in hierarchy order.
+  std::vector<ParallelSubtree> parallel_subtrees_;
+  // The nodes added or destroyed by each task of the parallel update. Kept as a member to reuse its storage.
+  std::vector<std::vector<Node::DeferredChange>> deferred_changes_;
+  // Whether the independent subtrees are being updated.
+  bool is_updating_in_parallel_ = false;
+  // Guards the state shared by the subtrees while they are updated.
+  std::recursive_mutex shared_state_mutex_;
 
-  // A set containing all Nodes currently registered in the scene for fast lookup.
-  std::unordered_set<const Node*> scene_nodes_;
+  // The memory of the nodes created with MakeChild, released in bulk when the scene is destroyed. Declared before root_ so it outlives the nodes.
+  // This pointer is never null until the scene is destroyed.
+  std::unique_ptr<NodeArena> node_arena_;
 
   // The root node of the scene graph. All entities in the scene are descendants of this node.
   // Ownership is managed by the Scene. This pointer is never null after construction.
@@ -0,0 +1,231 @@
+#include "spatial_grid.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "broadphase.h"
+#include "collision_filter.h"
+
+namespace ng {
+
+SpatialGrid::SpatialGrid(sf::Vector2f cell_size) : cell_size_(cell_size) {
+  assert(cell_size_.x > 0 && cell_size_.y > 0);
+}
+
+sf::Vector2f SpatialGrid::GetCellSize() const {
+  return cell_size_;
+}
+
+void SpatialGrid::Insert(ColliderId id, sf::FloatRect bounds,
+                         CollisionFilter filter) {
+  if (id >= entries_.size()) {
+    entries_.resize(id + 1);
+  }
+  assert(!entries_[id].is_used);
+  entries_[id] = Entry{.is_used = true,
+                       .bounds = bounds,
+                       .filter = filter,
+                       .cells = ToCellRange(bounds)};
+  AddToCells(id);
+}
+
+void SpatialGrid::Update(ColliderId id, sf::FloatRect bounds) {
+  assert(id < entries_.size() && entries_[id].is_used);
+  Entry& entry = entries_[id];
+  entry.bounds = bounds;
+
+  CellRange cells = ToCellRange(bounds);
+  if (cells.min == entry.cells.min && cells.max == entry.cells.max) {
+    return;
+  }
+
+  RemoveFromCells(id);
+  entry.cells = cells;
+  AddToCells(id);
+}
+
+void SpatialGrid::Remove(ColliderId id) {
+  if (id >= entries_.size() || !entries_[id].is_used) {
+    return;
+  }
+
+  RemoveFromCells(id);
+  entries_[id] = Entry{};
+}
+
+void SpatialGrid::Query(sf::FloatRect bounds, CollisionFilter filter,
+                        std::vector<ColliderId>& candidates) const {
+  CellRange range = ToCellRange(bounds);
+  for (int32_t y = range.min.y; y <= range.max.y; ++y) {
+    for (int32_t x = range.min.x; x <= range.max.x; ++x) {
+      auto it = cells_.find(CellKey(x, y));
+      if (it == cells_.end() || (it->second.categories & filter.mask) == 0) {
+        continue;
+      }
+
+      for (ColliderId id : it->second.ids) {
+        const Entry& entry = entries_[id];
+        // A collider spanning several cells is only reported from the first
+        // cell it shares with the query, so no deduplication pass is needed.
+        if (x != std::max(range.min.x, entry.cells.min.x) ||
+            y != std::max(range.min.y, entry.cells.min.y)) {
+          continue;
+        }
+
+        if (filter.CanCollide(entry.filter) && Overlaps(bounds, entry.bounds)) {
+          candidates.push_back(id);
+        }
+      }
+    }
+  }
+}
+
+void SpatialGrid::QueryCast(sf::FloatRect bounds, sf::Vector2f displacement,
+                            CollisionFilter filter,
+                            std::vector<ColliderId>& candidates) const {
+  size_t first = candidates.size();
+  CellRange range = ToCellRange(GetCastBounds(bounds, displacement));
+  for (int32_t y = range.min.y; y <= range.max.y; ++y) {
+    for (int32_t x = range.min.x; x <= range.max.x; ++x) {
+      // Long diagonal casts only cross a thin band of the cells around them.
+      sf::FloatRect cell_bounds(
+          {static_cast<float>(x) * cell_size_.x,
+           static_cast<float>(y) * cell_size_.y},
+          cell_size_);
+      if (!CastOverlaps(bounds, displacement, cell_bounds)) {
+        continue;
+      }
+
+      auto it = cells_.find(CellKey(x, y));
+      if (it == cells_.end() || (it->second.categories & filter.mask) == 0) {
+        continue;
+      }
+
+      for (ColliderId id : it->second.ids) {
+        const Entry& entry = entries_[id];
+        if (filter.CanCollide(entry.filter) &&
+            CastOverlaps(bounds, displacement, entry.bounds)) {
+          candidates.push_back(id);
+        }
+      }
+    }
+  }
+
+  // Skipped cells break the first shared cell rule of Query, so colliders
+  // spanning several crossed cells are deduplicated afterwards instead.
+  auto begin = candidates.begin() + static_cast<int64_t>(first);
+  std::sort(begin, candidates.end());
+  candidates.erase(std::unique(begin, candidates.end()), candidates.end());
+}
+
+void SpatialGrid::QueryPairs(std::vector<ColliderPair>& pairs) const {
+  for (const auto& [key, cell] : cells_) {
+    sf::Vector2i coords = CellFromKey(key);
+    for (size_t i = 0; i < cell.ids.size(); ++i) {
+      const Entry& a = entries_[cell.ids[i]];
+      for (size_t j = i + 1; j < cell.ids.size(); ++j) {
+        const Entry& b = entries_[cell.ids[j]];
+        // Two colliders may share several cells, only the first shared cell
+        // reports the pair.
+        if (coords.x != std::max(a.cells.min.x, b.cells.min.x) ||
+            coords.y != std::max(a.cells.min.y, b.cells.min.y)) {
+          continue;
+        }
+
+        if (a.filter.CanCollide(b.filter) && Overlaps(a.bounds, b.bounds)) {
+          pairs.push_back(MakeColliderPair(cell.ids[i], cell.ids[j]));
+        }
+      }
+    }
+  }
+}
+
+SpatialGrid::CellRange SpatialGrid::ToCellRange(sf::FloatRect bounds) const {
+  sf::Vector2f min = bounds.position.componentWiseDiv(cell_size_);
+  sf::Vector2f max =
+      (bounds.position + bounds.size).componentWiseDiv(cell_size_);
+  return {
+      .min = {static_cast<int32_t>(std::floor(min.x)),
+              static_cast<int32_t>(std::floor(min.y))},
+      .max = {static_cast<int32_t>(std::floor(max.x)),
+              static_cast<int32_t>(std::floor(max.y))},
+  };
+}
+
+SpatialGrid::CellMap::iterator SpatialGrid::AddCell(uint64_t key) {
+  if (spare_cells_.empty()) {
+    auto it = cells_.try_emplace(key).first;
+    // Room for a few entries, so that a spare cell rarely has to grow when
+    // it is reused for a more crowded spot.
+    it->second.ids.reserve(kMinCellCapacity);
+    return it;
+  }
+
+  CellMap::node_type node = std::move(spare_cells_.back());
+  spare_cells_.pop_back();
+  node.key() = key;
+  node.mapped().categories = 0;
+  return cells_.insert(std::move(node)).position;
+}
+
+void SpatialGrid::AddToCells(ColliderId id) {
+  const Entry& entry = entries_[id];
+  for (int32_t y = entry.cells.min.y; y <= entry.cells.max.y; ++y) {
+    for (int32_t x = entry.cells.min.x; x <= entry.cells.max.x; ++x) {
+      uint64_t key = CellKey(x, y);
+      auto it = cells_.find(key);
+      if (it == cells_.end()) {
+        it = AddCell(key);
+      }
+
+      it->second.ids.push_back(id);
+      it->second.categories |= entry.filter.category;
+    }
+  }
+}
+
+void SpatialGrid::RemoveFromCells(ColliderId id) {
+  const Entry& entry = entries_[id];
+  for (int32_t y = entry.cells.min.y; y <= entry.cells.max.y; ++y) {
+    for (int32_t x = entry.cells.min.x; x <= entry.cells.max.x; ++x) {
+      auto it = cells_.find(CellKey(x, y));
+      assert(it != cells_.end());
+
+      Cell& cell = it->second;
+      auto id_it = std::ranges::find(cell.ids, id);
+      assert(id_it != cell.ids.end());
+      // The order inside a cell is irrelevant, so swap and pop.
+      *id_it = cell.ids.back();
+      cell.ids.pop_back();
+
+      if (cell.ids.empty()) {
+        spare_cells_.push_back(cells_.extract(it));
+        continue;
+      }
+
+      cell.categories = 0;
+      for (ColliderId other : cell.ids) {
+        cell.categories |= entries_[other].filter.category;
+      }
+    }
+  }
+}
+
+uint64_t SpatialGrid::CellKey(int32_t x, int32_t y) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32U) |
+         static_cast<uint64_t>(static_cast<uint32_t>(y));
+}
+
+sf::Vector2i SpatialGrid::CellFromKey(uint64_t key) {
+  return {static_cast<int32_t>(static_cast<uint32_t>(key >> 32U)),
+          static_cast<int32_t>(static_cast<uint32_t>(key))};
+}
+
+}  // namespace ng
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "broadphase.h"
+#include "collision_filter.h"
+
+namespace ng {
+
+/// @brief A broadphase that hashes colliders into a uniform grid of fixed-size cells.
+///        Works best when most colliders are about as large as a cell (e.g. the tile size of the level).
+class SpatialGrid : public Broadphase {
+ public:
+  /// @brief Constructs a SpatialGrid with the specified cell size.
+  /// @param cell_size The size of each grid cell in world units. Both components must be greater than zero.
+  explicit SpatialGrid(sf::Vector2f cell_size);
+
+  /// @brief Returns the size of the grid cells.
+  /// @return The cell size in world units.
+  [[nodiscard]] sf::Vector2f GetCellSize() const;
+
+  void Insert(ColliderId id, sf::FloatRect bounds,
+              CollisionFilter filter) override;
+  void Update(ColliderId id, sf::FloatRect bounds) override;
+  void Remove(ColliderId id) override;
+  void Query(sf::FloatRect bounds, CollisionFilter filter,
+             std::vector<ColliderId>& candidates) const override;
+  void QueryCast(sf::FloatRect bounds, sf::Vector2f displacement,
+                 CollisionFilter filter,
+                 std::vector<ColliderId>& candidates) const override;
+  void QueryPairs(std::vector<ColliderPair>& pairs) const override;
+
+ private:
+  /// @brief An inclusive range of grid cells.
+  struct CellRange {
+    sf::Vector2i min;
+    sf::Vector2i max;
+  };
+
+  /// @brief The bookkeeping data of a collider stored in the grid.
+  struct Entry {
+    // Whether a collider with the id of the entry is in the grid.
+    bool is_used = false;
+    sf::FloatRect bounds;
+    CollisionFilter filter;
+    CellRange cells;
+  };
+
+  /// @brief A non-empty grid cell.
+  struct Cell {
+    // The ids of the entries overlapping the cell.
+    std::vector<ColliderId> ids;
+    // The union of the categories of the entries, used to skip the cell when no entry can match a query.
+    uint32_t categories = 0;
+  };
+
+  // The number of entries every new cell has room for.
+  static constexpr size_t kMinCellCapacity = 4;
+
+  // The non-empty cells, indexed by their packed coordinates.
+  using CellMap = std::unordered_map<uint64_t, Cell>;
+
+  /// @brief Computes the range of cells covered by the given bounds.
+  /// @param bounds The world-space bounding box.
+  /// @return The inclusive range of covered cells.
+  [[nodiscard]] CellRange ToCellRange(sf::FloatRect bounds) const;
+
+  /// @brief Adds an empty cell, reusing a spare cell and its storage if there is one.
+  /// @param key The key of the cell, which must not be in cells_.
+  /// @return An iterator to the new cell.
+  CellMap::iterator AddCell(uint64_t key);
+
+  /// @brief Adds an entry to every cell in its cell range.
+  /// @param id The id of the entry to add.
+  void AddToCells(ColliderId id);
+
+  /// @brief Removes an entry from every cell in its cell range.
+  /// @param id The id of the entry to remove.
+  void RemoveFromCells(ColliderId id);
+
+  /// @brief Packs cell coordinates into a single hash key.
+  /// @param x The x coordinate of the cell.
+  /// @param y The y coordinate of the cell.
+  /// @return The key of the cell.
+  [[nodiscard]] static uint64_t CellKey(int32_t x, int32_t y);
+
+  /// @brief Unpacks the cell coordinates of a hash key.
+  /// @param key The key of the cell.
+  /// @return The coordinates of the cell.
+  [[nodiscard]] static sf::Vector2i CellFromKey(uint64_t key);
+
+  // The size of each grid cell in world units.
+  sf::Vector2f cell_size_;
+  // The entries of all colliders in the grid, indexed by their id.
+  std::vector<Entry> entries_;
+  // The non-empty cells of the grid, indexed by their packed coordinates.
+  CellMap cells_;
+  // The cells that became empty, extracted from cells_ with their storage so that colliders moving into new cells do not allocate.
+  std::vector<CellMap::node_type> spare_cells_;
+};
+
+}  // namespace ng
@@ -0,0 +1,223 @@
+#include "sweep_and_prune.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "broadphase.h"
+#include "collision_filter.h"
+
+namespace ng {
+
+void SweepAndPrune::Insert(ColliderId id, sf::FloatRect bounds,
+                           CollisionFilter filter) {
+  assert(id != kNoProxy);
+  if (id >= proxies_.size()) {
+    proxies_.resize(id + 1);
+  }
+  assert(!proxies_[id].is_used);
+  proxies_[id] = Proxy{.is_used = true, .bounds = bounds, .filter = filter};
+
+  endpoints_.push_back(
+      {.value = bounds.position.x, .proxy = id, .is_min = true});
+  Relink(endpoints_.size() - 1);
+  SortEndpoint(endpoints_.size() - 1);
+
+  endpoints_.push_back({.value = bounds.position.x + bounds.size.x,
+                        .proxy = id,
+                        .is_min = false});
+  Relink(endpoints_.size() - 1);
+  SortEndpoint(endpoints_.size() - 1);
+  GrowMaxExtent(proxies_[id]);
+}
+
+void SweepAndPrune::Update(ColliderId id, sf::FloatRect bounds) {
+  assert(id < proxies_.size() && proxies_[id].is_used);
+  Proxy& proxy = proxies_[id];
+  bool is_moving_right = bounds.position.x > proxy.bounds.position.x;
+  proxy.bounds = bounds;
+  endpoints_[proxy.min_endpoint].value = bounds.position.x;
+  endpoints_[proxy.max_endpoint].value = bounds.position.x + bounds.size.x;
+  // The leading endpoint is sorted first. Otherwise, a proxy moving further
+  // than its width would stop its trailing endpoint at the stale position of
+  // the leading one.
+  if (is_moving_right) {
+    SortEndpoint(proxy.max_endpoint);
+    SortEndpoint(proxy.min_endpoint);
+  } else {
+    SortEndpoint(proxy.min_endpoint);
+    SortEndpoint(proxy.max_endpoint);
+  }
+  GrowMaxExtent(proxy);
+}
+
+void SweepAndPrune::Remove(ColliderId id) {
+  if (id >= proxies_.size() || !proxies_[id].is_used) {
+    return;
+  }
+
+  // Erasing the endpoints would shift and relink every later endpoint, so
+  // they are only marked as dead and erased in batches.
+  endpoints_[proxies_[id].min_endpoint].proxy = kNoProxy;
+  endpoints_[proxies_[id].max_endpoint].proxy = kNoProxy;
+  dead_endpoint_count_ += 2;
+  proxies_[id] = Proxy{};
+
+  if (dead_endpoint_count_ * 2 > endpoints_.size()) {
+    Compact();
+  }
+}
+
+void SweepAndPrune::Query(sf::FloatRect bounds, CollisionFilter filter,
+                          std::vector<ColliderId>& candidates) const {
+  float max_x = bounds.position.x + bounds.size.x;
+  for (size_t i = FindFirstCandidate(bounds.position.x); i < endpoints_.size();
+       ++i) {
+    const Endpoint& endpoint = endpoints_[i];
+    // Every later extent starts to the right of the query.
+    if (endpoint.value > max_x) {
+      break;
+    }
+
+    if (endpoint.is_min && endpoint.proxy != kNoProxy) {
+      const Proxy& proxy = proxies_[endpoint.proxy];
+      if (filter.CanCollide(proxy.filter) && Overlaps(proxy.bounds, bounds)) {
+        candidates.push_back(endpoint.proxy);
+      }
+    }
+  }
+}
+
+void SweepAndPrune::QueryCast(sf::FloatRect bounds, sf::Vector2f displacement,
+                              CollisionFilter filter,
+                              std::vector<ColliderId>& candidates) const {
+  sf::FloatRect cast_bounds = GetCastBounds(bounds, displacement);
+  float max_x = cast_bounds.position.x + cast_bounds.size.x;
+  for (size_t i = FindFirstCandidate(cast_bounds.position.x);
+       i < endpoints_.size(); ++i) {
+    const Endpoint& endpoint = endpoints_[i];
+    // Every later extent starts to the right of the cast.
+    if (endpoint.value > max_x) {
+      break;
+    }
+
+    if (endpoint.is_min && endpoint.proxy != kNoProxy) {
+      const Proxy& proxy = proxies_[endpoint.proxy];
+      if (filter.CanCollide(proxy.filter) &&
+          CastOverlaps(bounds, displacement, proxy.bounds)) {
+        candidates.push_back(endpoint.proxy);
+      }
+    }
+  }
+}
+
+void SweepAndPrune::QueryPairs(std::vector<ColliderPair>& pairs) const {
+  active_.clear();
+  max_extent_ = 0;
+  for (const Endpoint& endpoint : endpoints_) {
+    if (endpoint.proxy == kNoProxy) {
+      continue;
+    }
+
+    if (!endpoint.is_min) {
+      auto it = std::ranges::find(active_, endpoint.proxy);
+      assert(it != active_.end());
+      // The order of the active proxies is irrelevant, so swap and pop.
+      *it = active_.back();
+      active_.pop_back();
+      continue;
+    }
+
+    // Every active proxy overlaps the new one on the x axis, only the full
+    // bounding boxes remain to be checked.
+    const Proxy& proxy = proxies_[endpoint.proxy];
+    GrowMaxExtent(proxy);
+    for (uint32_t other_index : active_) {
+      const Proxy& other = proxies_[other_index];
+      if (proxy.filter.CanCollide(other.filter) &&
+          Overlaps(proxy.bounds, other.bounds)) {
+        pairs.push_back(MakeColliderPair(endpoint.proxy, other_index));
+      }
+    }
+
+    active_.push_back(endpoint.proxy);
+  }
+}
+
+bool SweepAndPrune::IsBefore(const Endpoint& a, const Endpoint& b) {
+  if (a.value != b.value) {
+    return a.value < b.value;
+  }
+  return a.is_min && !b.is_min;
+}
+
+void SweepAndPrune::SortEndpoint(size_t index) {
+  while (index > 0 && IsBefore(endpoints_[index], endpoints_[index - 1])) {
+    std::swap(endpoints_[index], endpoints_[index - 1]);
+    Relink(index);
+    Relink(index - 1);
+    --index;
+  }
+
+  while (index + 1 < endpoints_.size() &&
+         IsBefore(endpoints_[index + 1], endpoints_[index])) {
+    std::swap(endpoints_[index], endpoints_[index + 1]);
+    Relink(index);
+    Relink(index + 1);
+    ++index;
+  }
+}
+
+void SweepAndPrune::Relink(size_t index) {
+  const Endpoint& endpoint = endpoints_[index];
+  if (endpoint.proxy == kNoProxy) {
+    return;
+  }
+
+  Proxy& proxy = proxies_[endpoint.proxy];
+  if (endpoint.is_min) {
+    proxy.min_endpoint = index;
+  } else {
+    proxy.max_endpoint = index;
+  }
+}
+
+size_t SweepAndPrune::FindFirstCandidate(float min_x) const {
+  // An extent reaching min_x starts at most max_extent_ to its left. The bound
+  // is rounded down so that the subtraction never skips an extent.
+  float start = std::nextafter(min_x - max_extent_,
+                               -std::numeric_limits<float>::infinity());
+  auto it = std::ranges::lower_bound(endpoints_, start, std::less{},
+                                     &Endpoint::value);
+  return static_cast<size_t>(it - endpoints_.begin());
+}
+
+void SweepAndPrune::GrowMaxExtent(const Proxy& proxy) const {
+  // The difference of the endpoints is rounded too, so the next float above it
+  // bounds their true distance.
+  float width = endpoints_[proxy.max_endpoint].value -
+                endpoints_[proxy.min_endpoint].value;
+  max_extent_ = std::max(
+      max_extent_,
+      std::nextafter(width, std::numeric_limits<float>::infinity()));
+}
+
+void SweepAndPrune::Compact() {
+  std::erase_if(endpoints_, [](const Endpoint& endpoint) -> bool {
+    return endpoint.proxy == kNoProxy;
+  });
+  for (size_t i = 0; i < endpoints_.size(); ++i) {
+    Relink(i);
+  }
+  dead_endpoint_count_ = 0;
+}
+
+}  // namespace ng
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "broadphase.h"
+#include "collision_filter.h"
+
+namespace ng {
+
+/// @brief A broadphase that keeps the x-axis endpoints of every collider sorted and sweeps them to find overlaps.
+///        The endpoints stay sorted across ticks and are repaired with insertion sort, which is nearly linear when colliders move a little each tick.
+///        Works best for wide, horizontal levels with mostly moving colliders.
+class SweepAndPrune : public Broadphase {
+ public:
+  void Insert(ColliderId id, sf::FloatRect bounds,
+              CollisionFilter filter) override;
+  void Update(ColliderId id, sf::FloatRect bounds) override;
+  void Remove(ColliderId id) override;
+  void Query(sf::FloatRect bounds, CollisionFilter filter,
+             std::vector<ColliderId>& candidates) const override;
+  void QueryCast(sf::FloatRect bounds, sf::Vector2f displacement,
+                 CollisionFilter filter,
+                 std::vector<ColliderId>& candidates) const override;
+  void QueryPairs(std::vector<ColliderPair>& pairs) const override;
+
+ private:
+  /// @brief The bookkeeping data of a collider stored in the structure.
+  struct Proxy {
+    // Whether a collider with the id of the proxy is in the structure.
+    bool is_used = false;
+    sf::FloatRect bounds;
+    CollisionFilter filter;
+    // The positions of the min and max endpoints of the proxy in endpoints_.
+    size_t min_endpoint = 0;
+    size_t max_endpoint = 0;
+  };
+
+  // The proxy of the endpoints of removed colliders. Never a collider id.
+  static constexpr uint32_t kNoProxy = UINT32_MAX;
+
+  /// @brief The start or the end of a proxy's extent on the x axis. The endpoints of removed colliders stay in place with kNoProxy until the next compaction.
+  struct Endpoint {
+    float value = 0;
+    uint32_t proxy = 0;
+    bool is_min = false;
+  };
+
+  /// @brief Checks if an endpoint must be sorted before another one. Min endpoints go first on ties so that touching extents overlap.
+  /// @param a The first endpoint.
+  /// @param b The second endpoint.
+  /// @return True if a goes before b, false otherwise.
+  [[nodiscard]] static bool IsBefore(const Endpoint& a, const Endpoint& b);
+
+  /// @brief Moves an endpoint towards the front or the back of endpoints_ until it is sorted, keeping the proxies' endpoint positions in sync.
+  /// @param index The current position of the endpoint.
+  void SortEndpoint(size_t index);
+
+  /// @brief Stores the position of the endpoint at the given index in its proxy.
+  /// @param index The position of the endpoint.
+  void Relink(size_t index);
+
+  /// @brief Finds the first endpoint that may belong to a proxy overlapping the given extent on the x axis.
+  /// @param min_x The left edge of the extent.
+  /// @return The position of the endpoint.
+  [[nodiscard]] size_t FindFirstCandidate(float min_x) const;
+
+  /// @brief Raises max_extent_ to cover the distance between the endpoints of a proxy.
+  /// @param proxy The proxy.
+  void GrowMaxExtent(const Proxy& proxy) const;
+
+  /// @brief Erases the endpoints of removed colliders and relinks the remaining ones.
+  void Compact();
+
+  // The proxies of all colliders, indexed by their id, which is also the proxy field of their endpoints.
+  std::vector<Proxy> proxies_;
+  // The min and max endpoints of every proxy, sorted along the x axis. Persistent across updates.
+  std::vector<Endpoint> endpoints_;
+  // The number of endpoints of removed colliders in endpoints_.
+  size_t dead_endpoint_count_ = 0;
+  // An upper bound of the widths of the proxies, which limits how far to the left of a query an overlapping extent can start. Raised by Insert and Update, and tightened by QueryPairs, which visits every proxy anyway.
+  mutable float max_extent_ = 0;
+  // The proxies whose extent contains the current sweep position. Kept as a member to reuse its storage.
+  mutable std::vector<uint32_t> active_;
+};
+
+}  // namespace ng
@@ -0,0 +1,100 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+
+#include "function_ref.h"
+
+namespace ng {
+
+ThreadPool::ThreadPool(size_t thread_count) {
+  if (thread_count == 0) {
+    thread_count = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+
+  // The calling thread takes part in every job, so it needs no worker.
+  workers_.reserve(thread_count - 1);
+  for (size_t i = 1; i < thread_count; ++i) {
+    workers_.emplace_back(
+        [this](const std::stop_token& stop_token) -> void {
+          WorkerLoop(stop_token);
+        });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  for (std::jthread& worker : workers_) {
+    worker.request_stop();
+  }
+  // The workers join when workers_ is destroyed.
+}
+
+size_t ThreadPool::GetThreadCount() const {
+  return workers_.size() + 1;
+}
+
+void ThreadPool::ParallelFor(size_t count, FunctionRef<void(size_t)> task) {
+  if (workers_.empty() || count <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      task(i);
+    }
+    return;
+  }
+
+  {
+    std::scoped_lock lock(mutex_);
+    task_ = &task;
+    count_ = count;
+    next_index_.store(0, std::memory_order_relaxed);
+    busy_workers_ = workers_.size();
+    ++generation_;
+  }
+  job_started_.notify_all();
+
+  RunIndices();
+
+  // Every worker must check in, even if it ran nothing, before the task goes
+  // out of scope.
+  std::unique_lock lock(mutex_);
+  job_finished_.wait(lock, [this]() -> bool { return busy_workers_ == 0; });
+  task_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop(const std::stop_token& stop_token) {
+  uint64_t seen_generation = 0;
+  while (true) {
+    {
+      std::unique_lock lock(mutex_);
+      // Returns false only if the ThreadPool is being destroyed.
+      bool has_job = job_started_.wait(
+          lock, stop_token, [this, seen_generation]() -> bool {
+            return generation_ != seen_generation;
+          });
+      if (!has_job) {
+        return;
+      }
+      seen_generation = generation_;
+    }
+
+    RunIndices();
+
+    {
+      std::scoped_lock lock(mutex_);
+      --busy_workers_;
+    }
+    job_finished_.notify_one();
+  }
+}
+
+void ThreadPool::RunIndices() {
+  for (size_t i = next_index_.fetch_add(1, std::memory_order_relaxed);
+       i < count_; i = next_index_.fetch_add(1, std::memory_order_relaxed)) {
+    (*task_)(i);
+  }
+}
+
+}  // namespace ng
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "function_ref.h"
+
+namespace ng {
+
+/// @brief A fixed set of worker threads that run the iterations of parallel loops alongside the calling thread.
+///        Meant for short fork-join jobs run every tick, so the workers are created once and sleep between jobs.
+class ThreadPool {
+ public:
+  /// @brief Constructs a ThreadPool and starts its workers.
+  /// @param thread_count The number of threads running each job, including the calling thread. Zero uses one thread per hardware thread.
+  explicit ThreadPool(size_t thread_count = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool& other) = delete;
+  ThreadPool& operator=(const ThreadPool& other) = delete;
+  ThreadPool(ThreadPool&& other) = delete;
+  ThreadPool& operator=(ThreadPool&& other) = delete;
+
+  /// @brief Returns the number of threads running each job, including the calling thread.
+  /// @return The number of threads.
+  [[nodiscard]] size_t GetThreadCount() const;
+
+  /// @brief Calls a task once for every index in [0, count), spread over the threads in no particular order, and waits for every call to return.
+  ///        Must not be called from a task or from two threads at once.
+  /// @param count The number of indices.
+  /// @param task The function to call with each index. Must be safe to call from several threads at once.
+  void ParallelFor(size_t count, FunctionRef<void(size_t)> task);
+
+ private:
+  /// @brief The loop run by each worker: waits for a job, helps running it, then reports back.
+  /// @param stop_token Requested when the ThreadPool is destroyed.
+  void WorkerLoop(const std::stop_token& stop_token);
+
+  /// @brief Claims and runs indices of the current job until none is left.
+  void RunIndices();
+
+  // Protects the job description below and the number of busy workers.
+  std::mutex mutex_;
+  // Wakes the workers up when a job starts or the ThreadPool is destroyed.
+  std::condition_variable_any job_started_;
+  // Wakes the calling thread up once every worker is done with the job.
+  std::condition_variable job_finished_;
+  // The task of the current job. Only valid while ParallelFor runs.
+  const FunctionRef<void(size_t)>* task_ = nullptr;
+  // The number of indices of the current job.
+  size_t count_ = 0;
+  // The next index of the current job to be claimed.
+  std::atomic<size_t> next_index_ = 0;
+  // Incremented for every job, so workers can tell a new job from a spurious wakeup.
+  uint64_t generation_ = 0;
+  // The number of workers that have not finished the current job yet.
+  size_t busy_workers_ = 0;
+  // The worker threads. Declared last so they stop before the members they use are destroyed.
+  std::vector<std::jthread> workers_;
+};
+
+}  // namespace ng
@@ -1,14 +1,15 @@
 #include "tile.h"
 
 #include <SFML/Graphics/Rect.hpp>
+#include <cstdint>
 #include <optional>
 
 namespace ng {
 
-Tile::Tile(TileID id) : id_(id) {}
+Tile::Tile(TileID id, uint32_t flags) : id_(id), flags_(flags) {}
 
-Tile::Tile(TileID id, sf::IntRect texture_coords)
-    : id_(id), texture_coords_(texture_coords) {}
+Tile::Tile(TileID id, sf::IntRect texture_coords, uint32_t flags)
+    : id_(id), texture_coords_(texture_coords), flags_(flags) {}
 
 TileID Tile::GetID() const {
   return id_;
@@ -18,4 +19,8 @@ const std::optional<sf::IntRect>& Tile::GetTextureCoords() const {
   return texture_coords_;
 }
 
+uint32_t Tile::GetFlags() const {
+  return flags_;
+}
+
 }  // namespace ng
\ No newline at end of file
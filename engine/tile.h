@@ -10,17 +10,19 @@ enum class TileID : uint64_t;
 
 namespace ng {
 
-/// @brief Represents a single tile in a tilemap, containing its ID and optional texture coordinates.
+/// @brief Represents a single tile in a tilemap, containing its ID, optional texture coordinates, and flags.
 class Tile {
  public:
   /// @brief Constructs a Tile with only an ID. The texture coordinates will be empty.
   /// @param id The unique identifier for this tile.
-  explicit Tile(TileID id);
+  /// @param flags The user-defined flags of this tile (e.g. whether it is solid). None by default.
+  explicit Tile(TileID id, uint32_t flags = 0);
 
   /// @brief Constructs a Tile with an ID and its corresponding texture coordinates.
   /// @param id The unique identifier for this tile.
   /// @param texture_coords The rectangular coordinates within a texture atlas for this tile.
-  Tile(TileID id, sf::IntRect texture_coords);
+  /// @param flags The user-defined flags of this tile (e.g. whether it is solid). None by default.
+  Tile(TileID id, sf::IntRect texture_coords, uint32_t flags = 0);
 
   /// @brief Returns the unique identifier of the tile.
   /// @return The TileID of this tile.
@@ -30,11 +32,17 @@ class Tile {
   /// @return A constant reference to an optional sf::IntRect. It will contain the texture coordinates if set, or be empty otherwise.
   [[nodiscard]] const std::optional<sf::IntRect>& GetTextureCoords() const;
 
+  /// @brief Returns the user-defined flags of the tile.
+  /// @return The flags of this tile, as a bitmask.
+  [[nodiscard]] uint32_t GetFlags() const;
+
  private:
   // The unique identifier of the tile.
   TileID id_{};
   // Optional texture coordinates within a texture atlas. Empty if the tile doesn't have specific texture coordinates.
   std::optional<sf::IntRect> texture_coords_;
+  // The user-defined flags of the tile. The meaning of each bit is defined by the user of the engine.
+  uint32_t flags_ = 0;
 };
 
 }  // namespace ng
\ No newline at end of file
@@ -1,10 +1,14 @@
 #include "tilemap.h"
 
 #include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/RenderStates.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/Vertex.hpp>
 #include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <span>
@@ -28,6 +32,11 @@ Tilemap::Tilemap(App* app, sf::Vector2u size, Tileset tileset)
                                                   static_cast<size_t>(size_.y) *
                                                   kTrisInQuad) {
   tiles_.resize(static_cast<size_t>(size_.x) * static_cast<size_t>(size_.y));
+  // Unset cells hold the default TileID, so they get the flags of its tile,
+  // like GetTile would return.
+  const Tile* default_tile = tileset_.FindTile(TileID{});
+  flags_.resize(tiles_.size(),
+                default_tile != nullptr ? default_tile->GetFlags() : 0);
 
   for (uint32_t y = 0; y < size_.y; ++y) {
     for (uint32_t x = 0; x < size_.x; ++x) {
@@ -78,6 +87,7 @@ const Tile& Tilemap::GetTile(sf::Vector2u position) const {
 
 void Tilemap::SetTile(sf::Vector2u position, TileID tile_id) {
   tiles_[(position.y * size_.x) + position.x] = tile_id;
+  flags_[(position.y * size_.x) + position.x] = GetTile(position).GetFlags();
 
   std::span<sf::Vertex> triangles =
       std::span(&vertices_[(position.y * size_.x + position.x) * kTrisInQuad],
@@ -113,7 +123,7 @@ void Tilemap::SetTile(sf::Vector2u position, TileID tile_id) {
 
 bool Tilemap::IsWithinWorldBounds(sf::Vector2f world_position) const {
   sf::Vector2f tilemap_relative_position =
-      (world_position - GetGlobalTransform().getPosition());
+      (world_position - GetGlobalPosition());
 
   if (tilemap_relative_position.x < 0 || tilemap_relative_position.y < 0) {
     return false;
@@ -133,15 +143,111 @@ void Tilemap::SetWorldTile(sf::Vector2f world_position, TileID tile_id) {
   SetTile(WorldToTileSpace(world_position), tile_id);
 }
 
+uint32_t Tilemap::GetTileFlags(sf::Vector2u position) const {
+  return flags_[(position.y * size_.x) + position.x];
+}
+
+TileMoveResult Tilemap::MoveAndCollide(sf::FloatRect bounds,
+                                       sf::Vector2f velocity,
+                                       uint32_t solid_mask) const {
+  sf::Vector2f origin = GetGlobalPosition();
+  sf::Vector2f min = bounds.position - origin;
+  TileMoveResult result;
+  if (velocity.x != 0) {
+    SweepOutcome outcome =
+        SweepAxis(min, bounds.size, velocity.x, true, solid_mask);
+    result.is_out_of_bounds = outcome == SweepOutcome::kOutOfBounds;
+    result.hit_left_wall = outcome == SweepOutcome::kBlocked && velocity.x < 0;
+    result.hit_right_wall = outcome == SweepOutcome::kBlocked && velocity.x > 0;
+  }
+
+  if (velocity.y != 0 && !result.is_out_of_bounds) {
+    SweepOutcome outcome =
+        SweepAxis(min, bounds.size, velocity.y, false, solid_mask);
+    result.is_out_of_bounds = outcome == SweepOutcome::kOutOfBounds;
+    result.hit_ceiling = outcome == SweepOutcome::kBlocked && velocity.y < 0;
+    result.is_on_ground = outcome == SweepOutcome::kBlocked && velocity.y > 0;
+  }
+
+  result.position = min + origin;
+  return result;
+}
+
+Tilemap::SweepOutcome Tilemap::SweepAxis(sf::Vector2f& min, sf::Vector2f size,
+                                         float delta, bool horizontal,
+                                         uint32_t solid_mask) const {
+  assert(delta != 0);
+  // The axis of the motion and the one across it, so that both passes share
+  // the same code.
+  auto along = [horizontal](auto& vector) -> auto& {
+    return horizontal ? vector.x : vector.y;
+  };
+  auto across = [horizontal](auto& vector) -> auto& {
+    return horizontal ? vector.y : vector.x;
+  };
+  auto to_tile = [](float position, float tile_size) -> int32_t {
+    return static_cast<int32_t>(std::floor(position / tile_size));
+  };
+
+  sf::Vector2f tile_size(tileset_.GetTileSize());
+  sf::Vector2i map_size(size_);
+  // A box that only touches a tile does not overlap it, so its edges are
+  // pulled in slightly.
+  static constexpr float kEps = 0.001F;
+  int32_t first_row = to_tile(across(min) + kEps, across(tile_size));
+  int32_t last_row =
+      to_tile(across(min) + across(size) - kEps, across(tile_size));
+  // The edge of the box facing the motion.
+  float edge = delta > 0 ? along(min) + along(size) : along(min);
+  int32_t step = delta > 0 ? 1 : -1;
+  auto nudge = static_cast<float>(step) * kEps;
+  // Only the columns the box enters can stop it. The ones it already
+  // overlaps never do, so a box stuck in a solid tile can move out of it and
+  // is never pushed against its motion. A box ending its motion exactly on
+  // the edge of a column touches it, so that it lands flush on a tile.
+  int32_t first_column = to_tile(edge - nudge, along(tile_size)) + step;
+  int32_t last_column = to_tile(edge + delta + nudge, along(tile_size));
+
+  for (int32_t column = first_column; (last_column - column) * step >= 0;
+       column += step) {
+    for (int32_t row = first_row; row <= last_row; ++row) {
+      sf::Vector2i tile;
+      along(tile) = column;
+      across(tile) = row;
+      if (tile.x < 0 || tile.y < 0 || tile.x >= map_size.x ||
+          tile.y >= map_size.y) {
+        return SweepOutcome::kOutOfBounds;
+      }
+
+      if ((GetTileFlags(sf::Vector2u(tile)) & solid_mask) != 0) {
+        auto tile_start = static_cast<float>(column) * along(tile_size);
+        // The box may overlap the tile before it by less than kEps, and
+        // stays where it is then.
+        along(min) = delta > 0
+                         ? std::max(along(min), tile_start - along(size))
+                         : std::min(along(min), tile_start + along(tile_size));
+        return SweepOutcome::kBlocked;
+      }
+    }
+  }
+
+  along(min) += delta;
+  return SweepOutcome::kFree;
+}
+
 sf::Vector2u Tilemap::WorldToTileSpace(sf::Vector2f world_position) const {
   return sf::Vector2u(
-      (world_position - GetGlobalTransform().getPosition())
+      (world_position - GetGlobalPosition())
           .componentWiseDiv(sf::Vector2f(tileset_.GetTileSize())));
 }
 
 void Tilemap::Draw(sf::RenderTarget& target) {
+  if (tileset_.GetTexture() == nullptr) {
+    return;
+  }
+
   sf::RenderStates state;
-  state.transform = GetGlobalTransform().getTransform();
+  state.transform = GetGlobalTransform();
   state.texture = tileset_.GetTexture();
   target.draw(vertices_, state);
 }
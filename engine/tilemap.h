@@ -1,8 +1,10 @@
 #pragma once
 
+#include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/VertexArray.hpp>
 #include <SFML/System/Vector2.hpp>
+#include <cstdint>
 #include <vector>
 
 #include "app.h"
@@ -12,10 +14,26 @@
 
 namespace ng {
 
+/// @brief The outcome of moving a bounding box through a Tilemap.
+struct TileMoveResult {
+  // The world-space top-left corner of the bounding box after the motion.
+  sf::Vector2f position;
+  // True if a solid tile stopped the box while moving down.
+  bool is_on_ground = false;
+  // True if a solid tile stopped the box while moving up.
+  bool hit_ceiling = false;
+  // True if a solid tile stopped the box while moving left.
+  bool hit_left_wall = false;
+  // True if a solid tile stopped the box while moving right.
+  bool hit_right_wall = false;
+  // True if the motion would take the box out of the tilemap. The box stops where it was when leaving it.
+  bool is_out_of_bounds = false;
+};
+
 /// @brief Represents a grid-based map composed of tiles from a Tileset.
 class Tilemap : public Node {
  public:
-  /// @brief Constructs a Tilemap with the specified size and tileset.
+  /// @brief Constructs a Tilemap with the specified size and tileset. Every cell starts with the default TileID, and the flags of its tile if the tileset has one, or no flags otherwise.
   /// @param app A pointer to the App instance this tilemap belongs to. This pointer must not be null.
   /// @param size The dimensions of the tilemap in tiles (width and height).
   /// @param tileset The Tileset to use for rendering the tiles. Ownership is transferred to the Tilemap.
@@ -59,6 +77,22 @@ class Tilemap : public Node {
   /// @param tile_id The ID of the tile to set.
   void SetWorldTile(sf::Vector2f world_position, TileID tile_id);
 
+  /// @brief Returns the flags of the Tile at the specified tile coordinates. Faster than going through GetTile.
+  /// @param position The tile coordinates to retrieve the flags from. Must be within bounds.
+  /// @return The flags of the tile.
+  [[nodiscard]] uint32_t GetTileFlags(sf::Vector2u position) const;
+
+  /// @brief Moves a bounding box through the tilemap, first horizontally and then vertically, stopping it flush against the first solid tile on each axis.
+  ///        Only the tiles crossed by the motion are visited, so the cost depends on the size of the box and the speed, not on the size of the map.
+  ///        Only tiles the box enters can stop it: a box that already overlaps solid tiles moves freely out of them, and the box never moves against its velocity.
+  /// @param bounds The world-space bounding box to move.
+  /// @param velocity The motion of the bounding box.
+  /// @param solid_mask The tile flags that make a tile solid. A tile is solid if it has any of them.
+  /// @return The resolved position of the box and the contacts made during the motion.
+  [[nodiscard]] TileMoveResult MoveAndCollide(sf::FloatRect bounds,
+                                              sf::Vector2f velocity,
+                                              uint32_t solid_mask) const;
+
   /// @brief Converts world coordinates to tile coordinates.
   /// @param world_position The world coordinates to convert.
   /// @return The corresponding tile coordinates.
@@ -71,12 +105,32 @@ class Tilemap : public Node {
   void Draw(sf::RenderTarget& target) override;
 
  private:
+  /// @brief How the motion of a box along one axis ended.
+  enum class SweepOutcome : uint8_t {
+    kFree,
+    kBlocked,
+    kOutOfBounds,
+  };
+
+  /// @brief Moves a box along one axis, stopping it flush against the first solid tile it enters.
+  /// @param min The tilemap-space top-left corner of the box. Updated with the resolved position unless the box leaves the tilemap.
+  /// @param size The size of the box.
+  /// @param delta The motion along the axis. Must not be zero.
+  /// @param horizontal True to move along the x axis, false for the y axis.
+  /// @param solid_mask The tile flags that make a tile solid.
+  /// @return How the motion ended.
+  [[nodiscard]] SweepOutcome SweepAxis(sf::Vector2f& min, sf::Vector2f size,
+                                       float delta, bool horizontal,
+                                       uint32_t solid_mask) const;
+
   // The dimensions of the tilemap in tiles.
   sf::Vector2u size_;
   // The tileset used by this tilemap. Ownership is held by the Tilemap.
   Tileset tileset_;
   // A vector storing the TileID for each tile in the map.
   std::vector<TileID> tiles_;
+  // The flags of each tile in the map, copied from the tileset so that collision queries never look tiles up. Unset cells have the flags of the default TileID's tile.
+  std::vector<uint32_t> flags_;
   // The vertex array used for rendering the tilemap efficiently.
   sf::VertexArray vertices_;
 };
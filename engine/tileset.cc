@@ -3,6 +3,9 @@
 #include <SFML/Graphics/Texture.hpp>
 #include <SFML/System/Vector2.hpp>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
 
 #include "tile.h"
 
@@ -13,12 +16,37 @@ Tileset::Tileset(sf::Vector2u tile_size, const sf::Texture* texture)
   assert(texture);
 }
 
+Tileset::Tileset(sf::Vector2u tile_size) : tile_size_(tile_size) {}
+
 const Tile& Tileset::GetTile(TileID id) const {
-  return tiles_.at(id);
+  const Tile* tile = FindTile(id);
+  if (tile == nullptr) {
+    throw std::out_of_range("The tileset has no tile with this ID");
+  }
+
+  return *tile;
+}
+
+const Tile* Tileset::FindTile(TileID id) const {
+  auto index = static_cast<size_t>(id);
+  if (index >= tiles_.size() || !tiles_[index].has_value()) {
+    return nullptr;
+  }
+
+  return &*tiles_[index];
+}
+
+uint32_t Tileset::GetFlags(TileID id) const {
+  return GetTile(id).GetFlags();
 }
 
 void Tileset::AddTile(Tile tile) {
-  tiles_.insert({tile.GetID(), tile});
+  auto index = static_cast<size_t>(tile.GetID());
+  if (index >= tiles_.size()) {
+    tiles_.resize(index + 1);
+  }
+
+  tiles_[index] = tile;
 }
 
 sf::Vector2u Tileset::GetTileSize() const {
@@ -2,13 +2,16 @@
 
 #include <SFML/Graphics/Texture.hpp>
 #include <SFML/System/Vector2.hpp>
-#include <unordered_map>
+#include <cstdint>
+#include <optional>
+#include <vector>
 
 #include "tile.h"
 
 namespace ng {
 
 /// @brief Manages a collection of tiles and their associated texture within a texture atlas.
+///        Tiles are stored in a dense array indexed by the value of their TileID, so lookups are a single indexed load. TileID values should therefore be small and contiguous.
 class Tileset {
  public:
   /// @brief Constructs a Tileset with a specified tile size and texture.
@@ -16,11 +19,25 @@ class Tileset {
   /// @param texture A pointer to the SFML Texture containing the tiles. This pointer must not be null and the Texture's lifetime should be managed externally to Tileset.
   Tileset(sf::Vector2u tile_size, const sf::Texture* texture);
 
+  /// @brief Constructs a Tileset without a texture, for tilemaps that are only collided with and never drawn.
+  /// @param tile_size The dimensions (width and height) of each individual tile.
+  explicit Tileset(sf::Vector2u tile_size);
+
   /// @brief Retrieves a specific tile from the tileset based on its ID.
   /// @param id The TileID of the tile to retrieve.
-  /// @return A constant reference to the Tile object with the given ID.
+  /// @return A constant reference to the Tile object with the given ID. Throws std::out_of_range if the tileset has no tile with this ID.
   [[nodiscard]] const Tile& GetTile(TileID id) const;
 
+  /// @brief Looks up a specific tile from the tileset based on its ID, without throwing.
+  /// @param id The TileID of the tile to look up.
+  /// @return A pointer to the Tile object with the given ID, or nullptr if the tileset has no tile with this ID.
+  [[nodiscard]] const Tile* FindTile(TileID id) const;
+
+  /// @brief Retrieves the flags of a specific tile from the tileset based on its ID.
+  /// @param id The TileID of the tile.
+  /// @return The flags of the tile with the given ID. Throws std::out_of_range if the tileset has no tile with this ID.
+  [[nodiscard]] uint32_t GetFlags(TileID id) const;
+
   /// @brief Adds a new tile to the tileset. If a tile with the same ID already exists, it will be overwritten.
   /// @param tile The Tile object to add to the tileset.
   void AddTile(Tile tile);
@@ -30,16 +47,16 @@ class Tileset {
   [[nodiscard]] sf::Vector2u GetTileSize() const;
 
   /// @brief Returns the texture atlas associated with this tileset.
-  /// @return A constant pointer to the SFML Texture. This pointer is never null after construction.
+  /// @return A constant pointer to the SFML Texture, or null if the tileset has no texture.
   [[nodiscard]] const sf::Texture* GetTexture() const;
 
  private:
   // The dimensions of each tile in the texture atlas.
   sf::Vector2u tile_size_;
-  // Pointer to the texture atlas containing the tiles. This pointer is never null after construction.
+  // Pointer to the texture atlas containing the tiles. Null if the tileset has no texture.
   const sf::Texture* texture_ = nullptr;
-  // Stores the tiles, indexed by their unique ID.
-  std::unordered_map<TileID, Tile> tiles_;
+  // Stores the tiles, indexed by the value of their unique ID. Empty for the IDs without a tile.
+  std::vector<std::optional<Tile>> tiles_;
 };
 
 }  // namespace ng
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace ng {
+
+/// @brief A small integer identifying a type, handed out the first time the type is asked for.
+///        Comparing two ids is a single integer compare, unlike a dynamic_cast. Ids are only stable within a single run of the program.
+using TypeId = uint32_t;
+
+/// @brief The id of no type, used for nodes whose type was not recorded.
+inline constexpr TypeId kNoTypeId = 0;
+
+/// @brief Hands out a new type id on every call. Use TypeIdOf instead.
+/// @return A type id never returned before, never kNoTypeId.
+[[nodiscard]] inline TypeId NextTypeId() {
+  static std::atomic<TypeId> next_id = kNoTypeId + 1;
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// @brief Returns the id of a type. The same type always gets the same id, regardless of its cv-qualifiers.
+/// @tparam T The type.
+/// @return The id of T.
+template <typename T>
+[[nodiscard]] TypeId TypeIdOf() {
+  if constexpr (!std::is_same_v<T, std::remove_cv_t<T>>) {
+    return TypeIdOf<std::remove_cv_t<T>>();
+  } else {
+    static const TypeId kId = NextTypeId();
+    return kId;
+  }
+}
+
+}  // namespace ng
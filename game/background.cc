@@ -50,7 +50,7 @@ void Background::Update() {
 void Background::Draw(sf::RenderTarget& target) {
   sf::RenderStates state;
   state.texture = texture_;
-  state.transform = GetGlobalTransform().getTransform();
+  state.transform = GetGlobalTransform();
   target.draw(image_vertices_, state);
 }
 
@@ -6,6 +6,7 @@
 #include <memory>
 #include <utility>
 
+#include "collision_category.h"
 #include "engine/app.h"
 #include "engine/circle_collider.h"
 #include "engine/node.h"
@@ -40,7 +41,13 @@ Banana::Banana(ng::App* app)
   sprite_.setOrigin({16, 16});
   sprite_.setTextureRect(sf::IntRect({0, 0}, {32, 32}));
 
-  MakeChild<ng::CircleCollider>(16.F);
+  auto& collider = MakeChild<ng::CircleCollider>(16.F);
+  collider.SetCollisionFilter({
+      .category = std::to_underlying(CollisionCategory::kPickup),
+      .mask = std::to_underlying(CollisionCategory::kPlayer),
+  });
+  // Bananas never move.
+  collider.SetStatic(true);
 }
 
 bool Banana::GetIsCollected() const {
@@ -61,7 +68,7 @@ void Banana::Update() {
 }
 
 void Banana::Draw(sf::RenderTarget& target) {
-  target.draw(sprite_, GetGlobalTransform().getTransform());
+  target.draw(sprite_, GetGlobalTransform());
 }
 
 }  // namespace game
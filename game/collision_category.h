@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+namespace game {
+
+/// @brief The collision categories of the game's colliders, used as ng::CollisionFilter bits.
+enum class CollisionCategory : uint32_t {  // NOLINT
+  kPlayer = 1U << 0U,
+  kEnemy = 1U << 1U,
+  kProjectile = 1U << 2U,
+  kPickup = 1U << 3U,
+  kGoal = 1U << 4U,
+};
+
+}  // namespace game
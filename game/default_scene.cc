@@ -1,5 +1,6 @@
 #include "default_scene.h"
 
+#include <SFML/System/Vector2.hpp>
 #include <cstdint>
 #include <memory>
 #include <utility>
@@ -12,6 +13,7 @@
 #include "engine/layer.h"
 #include "engine/node.h"
 #include "engine/scene.h"
+#include "engine/spatial_grid.h"
 #include "engine/tile.h"
 #include "engine/tilemap.h"
 #include "engine/tileset.h"
@@ -21,6 +23,7 @@
 #include "plant.h"
 #include "player.h"
 #include "score_manager.h"
+#include "tile_flag.h"
 #include "tile_id.h"
 
 namespace game {
@@ -33,43 +36,44 @@ std::unique_ptr<ng::Scene> MakeDefaultScene(ng::App* app) {
       {32, 32}, &app->GetResourceManager().LoadTexture("Terrain (16x16).png"));
 
   {
+    static constexpr uint32_t kSolid = std::to_underlying(TileFlag::kSolid);
     tileset.AddTile(ng::Tile(TileID::kVoid));
-    tileset.AddTile(ng::Tile(TileID::kInvisibleBarrier));
+    tileset.AddTile(ng::Tile(TileID::kInvisibleBarrier, kSolid));
 
     tileset.AddTile(ng::Tile(TileID::kDirtTopLeft,
-                             sf::IntRect({6 * 16, 0 * 16}, {16, 16})));
+                             sf::IntRect({6 * 16, 0 * 16}, {16, 16}), kSolid));
     tileset.AddTile(ng::Tile(TileID::kDirtTopCenter,
-                             sf::IntRect({7 * 16, 0 * 16}, {16, 16})));
+                             sf::IntRect({7 * 16, 0 * 16}, {16, 16}), kSolid));
     tileset.AddTile(ng::Tile(TileID::kDirtTopRight,
-                             sf::IntRect({8 * 16, 0 * 16}, {16, 16})));
+                             sf::IntRect({8 * 16, 0 * 16}, {16, 16}), kSolid));
     tileset.AddTile(ng::Tile(TileID::kDirtMiddleLeft,
-                             sf::IntRect({6 * 16, 1 * 16}, {16, 16})));
+                             sf::IntRect({6 * 16, 1 * 16}, {16, 16}), kSolid));
     tileset.AddTile(ng::Tile(TileID::kDirtMiddleCenter,
-                             sf::IntRect({7 * 16, 1 * 16}, {16, 16})));
+                             sf::IntRect({7 * 16, 1 * 16}, {16, 16}), kSolid));
     tileset.AddTile(ng::Tile(TileID::kDirtMiddleRight,
-                             sf::IntRect({8 * 16, 1 * 16}, {16, 16})));
+                             sf::IntRect({8 * 16, 1 * 16}, {16, 16}), kSolid));
     tileset.AddTile(ng::Tile(TileID::kDirtBottomLeft,
-                             sf::IntRect({6 * 16, 2 * 16}, {16, 16})));
+                             sf::IntRect({6 * 16, 2 * 16}, {16, 16}), kSolid));
     tileset.AddTile(ng::Tile(TileID::kDirtBottomCenter,
-                             sf::IntRect({7 * 16, 2 * 16}, {16, 16})));
+                             sf::IntRect({7 * 16, 2 * 16}, {16, 16}), kSolid));
     tileset.AddTile(ng::Tile(TileID::kDirtBottomRight,
-                             sf::IntRect({8 * 16, 2 * 16}, {16, 16})));
+                             sf::IntRect({8 * 16, 2 * 16}, {16, 16}), kSolid));
 
     tileset.AddTile(ng::Tile(TileID::kStoneHorizontalLeft,
-                             sf::IntRect({12 * 16, 4 * 16}, {16, 16})));
+                             sf::IntRect({12 * 16, 4 * 16}, {16, 16}), kSolid));
     tileset.AddTile(ng::Tile(TileID::kStoneHorizontalCenter,
-                             sf::IntRect({13 * 16, 4 * 16}, {16, 16})));
+                             sf::IntRect({13 * 16, 4 * 16}, {16, 16}), kSolid));
     tileset.AddTile(ng::Tile(TileID::kStoneHorizontalRight,
-                             sf::IntRect({14 * 16, 4 * 16}, {16, 16})));
+                             sf::IntRect({14 * 16, 4 * 16}, {16, 16}), kSolid));
     tileset.AddTile(ng::Tile(TileID::kStoneVerticalTop,
-                             sf::IntRect({15 * 16, 4 * 16}, {16, 16})));
+                             sf::IntRect({15 * 16, 4 * 16}, {16, 16}), kSolid));
     tileset.AddTile(ng::Tile(TileID::kStoneVerticalMiddle,
-                             sf::IntRect({15 * 16, 5 * 16}, {16, 16})));
+                             sf::IntRect({15 * 16, 5 * 16}, {16, 16}), kSolid));
     tileset.AddTile(ng::Tile(TileID::kStoneVerticalBottom,
-                             sf::IntRect({15 * 16, 6 * 16}, {16, 16})));
+                             sf::IntRect({15 * 16, 6 * 16}, {16, 16}), kSolid));
 
     tileset.AddTile(ng::Tile(TileID::kPlasticBlock,
-                             sf::IntRect({12 * 16, 9 * 16}, {16, 16})));
+                             sf::IntRect({12 * 16, 9 * 16}, {16, 16}), kSolid));
   }
 
   auto tmp_tilemap =
@@ -80,6 +84,9 @@ std::unique_ptr<ng::Scene> MakeDefaultScene(ng::App* app) {
   auto& tilemap = *tmp_tilemap;
   scene->AddChild(std::move(tmp_tilemap));
 
+  scene->GetMutablePhysics().SetBroadphase(
+      std::make_unique<ng::SpatialGrid>(sf::Vector2f(tilemap.GetTileSize())));
+
   for (uint32_t i = 0; i < tilemap.GetSize().x; ++i) {
     tilemap.SetTile({i, 0}, TileID::kStoneHorizontalCenter);
   }
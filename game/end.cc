@@ -6,6 +6,7 @@
 #include <memory>
 #include <utility>
 
+#include "collision_category.h"
 #include "engine/app.h"
 #include "engine/node.h"
 #include "engine/rectangle_collider.h"
@@ -63,6 +64,12 @@ End::End(ng::App* app, GameManager* game_manager)
 
   auto& collider = MakeChild<ng::RectangleCollider>(sf::Vector2f(60, 32));
   collider.SetLocalPosition({0, -20});
+  collider.SetCollisionFilter({
+      .category = std::to_underlying(CollisionCategory::kGoal),
+      .mask = std::to_underlying(CollisionCategory::kPlayer),
+  });
+  // The end of the level never moves.
+  collider.SetStatic(true);
 
   animator_.AddState(std::make_unique<PressedState>(
       "pressed",
@@ -89,7 +96,7 @@ void End::Update() {
 }
 
 void End::Draw(sf::RenderTarget& target) {
-  target.draw(sprite_, GetGlobalTransform().getTransform());
+  target.draw(sprite_, GetGlobalTransform());
 }
 
 }  // namespace game
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "engine/app.h"
 #include "engine/node.h"
+#include "engine/node_handle.h"
 #include "engine/tilemap.h"
 #include "player.h"
 
@@ -18,7 +19,7 @@ class FollowPlayer : public ng::Node {
  private:
   void Follow();
 
-  const Player* player_ = nullptr;
+  ng::NodeHandle<const Player> player_;
   const ng::Tilemap* tilemap_ = nullptr;
 };
 
@@ -49,9 +49,9 @@ void LoseCanvas::Draw(sf::RenderTarget& target) {
   background_.setSize(sf::Vector2f(GetApp()->GetWindow().getSize()));
   background_.setOrigin(sf::Vector2f(GetApp()->GetWindow().getSize()) / 2.F);
 
-  target.draw(background_, GetGlobalTransform().getTransform());
-  target.draw(title_text_, GetGlobalTransform().getTransform());
-  target.draw(restart_text_, GetGlobalTransform().getTransform());
+  target.draw(background_, GetGlobalTransform());
+  target.draw(title_text_, GetGlobalTransform());
+  target.draw(restart_text_, GetGlobalTransform());
 }
 
 }  // namespace game
\ No newline at end of file
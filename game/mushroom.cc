@@ -4,12 +4,11 @@
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/Sprite.hpp>
 #include <SFML/System/Vector2.hpp>
-#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <utility>
-#include <vector>
 
+#include "collision_category.h"
 #include "engine/app.h"
 #include "engine/collider.h"
 #include "engine/node.h"
@@ -19,23 +18,11 @@
 #include "engine/tilemap.h"
 #include "engine/transition.h"
 #include "player.h"
-#include "tile_id.h"
+#include "tile_flag.h"
+#include "velocity.h"
 
 namespace game {
 
-namespace {
-
-bool DoesCollide(sf::Vector2f position, const ng::Tilemap& tilemap) {
-  TileID id = tilemap.GetWorldTile(position).GetID();
-  return id == TileID::kInvisibleBarrier ||
-         (id >= TileID::kDirtTopLeft && id <= TileID::kDirtBottomRight) ||
-         (id >= TileID::kStoneHorizontalLeft &&
-          id <= TileID::kStoneVerticalBottom) ||
-         id == TileID::kPlasticBlock;
-}
-
-}  // namespace
-
 static constexpr int32_t kAnimationTPF = 4;
 
 Mushroom::RunState::RunState(ng::State<Context>::ID id,
@@ -91,6 +78,12 @@ Mushroom::Mushroom(ng::App* app, const ng::Tilemap* tilemap)
 
   auto& collider = MakeChild<ng::RectangleCollider>(sf::Vector2f(32, 32));
   collider.SetLocalPosition({0, 16});
+  // Mushrooms bounce off each other.
+  collider.SetCollisionFilter({
+      .category = std::to_underlying(CollisionCategory::kEnemy),
+      .mask = std::to_underlying(CollisionCategory::kPlayer) |
+              std::to_underlying(CollisionCategory::kEnemy),
+  });
   collider_ = &collider;
 
   animator_.AddState(std::make_unique<HitState>(
@@ -115,6 +108,10 @@ void Mushroom::TakeDamage() {
   context_.is_dead = true;
 }
 
+void Mushroom::OnAdd() {
+  AddComponent<Velocity>();
+}
+
 void Mushroom::Update() {  // NOLINT
   animator_.Update();
 
@@ -123,115 +120,65 @@ void Mushroom::Update() {  // NOLINT
   }
 
   static constexpr float kMovementSpeed = 2.F;
-  velocity_.x = direction_.x * kMovementSpeed;
-  velocity_.y += 1;
-
-  sf::Vector2f old_pos = collider_->GetGlobalTransform().getPosition();
-  sf::Vector2f new_pos = old_pos + velocity_;
-
-  sf::Vector2f col_half_size = collider_->GetSize() / 2.F;
-  sf::Vector2f tilemap_size = sf::Vector2f(tilemap_->GetTileSize());
-
-  static constexpr float kEps = 0.001F;
-  sf::Vector2f top_left = {new_pos.x - (col_half_size.x - kEps),
-                           old_pos.y - (col_half_size.y - kEps)};
-  sf::Vector2f bottom_left = {new_pos.x - (col_half_size.x - kEps),
-                              old_pos.y + (col_half_size.y - kEps)};
-
-  if (!tilemap_->IsWithinWorldBounds(top_left) ||
-      !tilemap_->IsWithinWorldBounds(bottom_left)) {
+  sf::Vector2f& velocity = GetComponent<Velocity>()->value;
+  velocity.x = direction_.x * kMovementSpeed;
+  velocity.y += 1;
+
+  sf::FloatRect bounds = collider_->GetBounds();
+  ng::TileMoveResult move = tilemap_->MoveAndCollide(
+      bounds, velocity, std::to_underlying(TileFlag::kSolid));
+  if (move.is_out_of_bounds) {
     TakeDamage();
     return;
   }
 
-  if (velocity_.x < 0 && (DoesCollide(top_left, *tilemap_) ||
-                          DoesCollide(bottom_left, *tilemap_))) {
-    new_pos.x = std::ceil(top_left.x / tilemap_size.x) * tilemap_size.x +
-                col_half_size.x;
-    velocity_.x = 0;
+  // Mushrooms turn around when they run into a wall.
+  if (move.hit_left_wall) {
+    velocity.x = 0;
     direction_.x = 1;
+  } else if (move.hit_right_wall) {
+    velocity.x = 0;
+    direction_.x = -1;
   }
 
-  sf::Vector2f top_right = {new_pos.x + (col_half_size.x - kEps),
-                            old_pos.y - (col_half_size.y - kEps)};
-  sf::Vector2f bottom_right = {new_pos.x + (col_half_size.x - kEps),
-                               old_pos.y + (col_half_size.y - kEps)};
-
-  if (!tilemap_->IsWithinWorldBounds(top_right) ||
-      !tilemap_->IsWithinWorldBounds(bottom_right)) {
-    TakeDamage();
-    return;
-  }
-
-  if (velocity_.x > 0 && (DoesCollide(top_right, *tilemap_) ||
-                          DoesCollide(bottom_right, *tilemap_))) {
-    new_pos.x = std::floor(top_right.x / tilemap_size.x) * tilemap_size.x -
-                col_half_size.x;
-    velocity_.x = 0;
-    direction_.x = -1;
+  if (move.hit_ceiling || move.is_on_ground) {
+    velocity.y = 0;
   }
+  is_on_ground_ = move.is_on_ground;
 
-  top_left = {new_pos.x - (col_half_size.x - kEps),
-              new_pos.y - (col_half_size.y - kEps)};
-  top_right = {new_pos.x + (col_half_size.x - kEps),
-               new_pos.y - (col_half_size.y - kEps)};
+  sf::Vector2f new_pos = move.position + (bounds.size / 2.F);
+  SetLocalPosition(new_pos - collider_->GetLocalTransform().getPosition());
+}
 
-  if (!tilemap_->IsWithinWorldBounds(top_left) ||
-      !tilemap_->IsWithinWorldBounds(top_right)) {
-    TakeDamage();
-    return;
-  }
+void Mushroom::Draw(sf::RenderTarget& target) {
+  sprite_.setScale(sf::Vector2f{-direction_.x * 2, 2.F});
+  target.draw(sprite_, GetGlobalTransform());
+}
 
-  if (velocity_.y < 0 &&
-      (DoesCollide(top_left, *tilemap_) || DoesCollide(top_right, *tilemap_))) {
-    new_pos.y = std::ceil(top_left.y / tilemap_size.y) * tilemap_size.y +
-                col_half_size.y;
-    velocity_.y = 0;
-  }
+void Mushroom::OnCollisionEnter([[maybe_unused]] const ng::Collider& collider,
+                                const ng::Collider& other) {
+  HandleCollision(other);
+}
 
-  bottom_left = {new_pos.x - (col_half_size.x - kEps),
-                 new_pos.y + (col_half_size.y - kEps)};
-  bottom_right = {new_pos.x + (col_half_size.x - kEps),
-                  new_pos.y + (col_half_size.y - kEps)};
+void Mushroom::OnCollisionStay([[maybe_unused]] const ng::Collider& collider,
+                               const ng::Collider& other) {
+  HandleCollision(other);
+}
 
-  if (!tilemap_->IsWithinWorldBounds(bottom_left) ||
-      !tilemap_->IsWithinWorldBounds(bottom_right)) {
-    TakeDamage();
+void Mushroom::HandleCollision(const ng::Collider& other) {
+  if (context_.is_dead) {
     return;
   }
 
-  if (velocity_.y > 0 && (DoesCollide(bottom_left, *tilemap_) ||
-                          DoesCollide(bottom_right, *tilemap_))) {
-    new_pos.y = std::floor(bottom_left.y / tilemap_size.y) * tilemap_size.y -
-                col_half_size.y;
-    velocity_.y = 0;
-    is_on_ground_ = true;
-  } else {
-    is_on_ground_ = false;
-  }
-
-  SetLocalPosition(new_pos - collider_->GetLocalTransform().getPosition());
-
-  std::vector<const ng::Collider*> others =
-      GetScene()->GetPhysics().Overlap(*collider_);
-  for (const auto* other : others) {
-    if (other->GetParent()->GetName() == "Player") {
-      auto* player = dynamic_cast<Player*>(other->GetParent());
-      if (player->GetVelocity().y <= 0) {
-        player->TakeDamage();
-      }
-    } else if (other->GetParent()->GetName() == "Mushroom") {
-      auto* mushroom = dynamic_cast<Mushroom*>(other->GetParent());
-      if (!mushroom->GetIsDead()) {
-        direction_.x = -direction_.x;
-      }
+  if (auto* player = other.GetOwner<Player>(); player != nullptr) {
+    if (player->GetVelocity().y <= 0) {
+      player->TakeDamage();
+    }
+  } else if (auto* mushroom = other.GetOwner<Mushroom>(); mushroom != nullptr) {
+    if (!mushroom->GetIsDead()) {
+      direction_.x = -direction_.x;
     }
   }
 }
 
-void Mushroom::Draw(sf::RenderTarget& target) {
-  sprite_.setScale(sf::Vector2f{-direction_.x * 2, 2.F});
-  target.draw(sprite_, GetGlobalTransform().getTransform());
-}
-
 }  // namespace game
\ No newline at end of file
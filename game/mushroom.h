@@ -6,6 +6,7 @@
 #include <SFML/System/Vector2.hpp>
 
 #include "engine/app.h"
+#include "engine/collider.h"
 #include "engine/fsm.h"
 #include "engine/node.h"
 #include "engine/rectangle_collider.h"
@@ -22,8 +23,13 @@ class Mushroom : public ng::Node {
   void TakeDamage();
 
  protected:
+  void OnAdd() override;
   void Update() override;
   void Draw(sf::RenderTarget& target) override;
+  void OnCollisionEnter(const ng::Collider& collider,
+                        const ng::Collider& other) override;
+  void OnCollisionStay(const ng::Collider& collider,
+                       const ng::Collider& other) override;
 
  private:
   struct Context {
@@ -61,8 +67,9 @@ class Mushroom : public ng::Node {
     ng::Node* node_ = nullptr;
   };
 
+  void HandleCollision(const ng::Collider& other);
+
   sf::Vector2f direction_{-1, 0};
-  sf::Vector2f velocity_;
   const ng::Tilemap* tilemap_ = nullptr;
   const ng::RectangleCollider* collider_ = nullptr;
   bool is_on_ground_ = false;
@@ -7,8 +7,8 @@
 #include <cstdint>
 #include <memory>
 #include <utility>
-#include <vector>
 
+#include "collision_category.h"
 #include "engine/app.h"
 #include "engine/collider.h"
 #include "engine/node.h"
@@ -106,6 +106,12 @@ Plant::Plant(ng::App* app, const ng::Tilemap* tilemap)
 
   auto& collider = MakeChild<ng::RectangleCollider>(sf::Vector2f(40, 42));
   collider.SetLocalPosition({8, 0});
+  collider.SetCollisionFilter({
+      .category = std::to_underlying(CollisionCategory::kEnemy),
+      .mask = std::to_underlying(CollisionCategory::kPlayer),
+  });
+  // Plants never move.
+  collider.SetStatic(true);
   collider_ = &collider;
 
   animator_.AddState(std::make_unique<AttackState>(
@@ -160,22 +166,33 @@ void Plant::Update() {
     context_.is_attacking = true;
     attack_timer_ = kAttackCooldown;
   }
-
-  std::vector<const ng::Collider*> others =
-      GetScene()->GetPhysics().Overlap(*collider_);
-  for (const auto* other : others) {
-    if (other->GetParent()->GetName() == "Player") {
-      auto* player = dynamic_cast<Player*>(other->GetParent());
-      if (player->GetVelocity().y <= 0) {
-        player->TakeDamage();
-      }
-    }
-  }
 }
 
 void Plant::Draw(sf::RenderTarget& target) {
   sprite_.setScale(sf::Vector2f{-direction_.x * 2, 2.F});
-  target.draw(sprite_, GetGlobalTransform().getTransform());
+  target.draw(sprite_, GetGlobalTransform());
+}
+
+void Plant::OnCollisionEnter([[maybe_unused]] const ng::Collider& collider,
+                             const ng::Collider& other) {
+  HandleCollision(other);
+}
+
+void Plant::OnCollisionStay([[maybe_unused]] const ng::Collider& collider,
+                            const ng::Collider& other) {
+  HandleCollision(other);
+}
+
+void Plant::HandleCollision(const ng::Collider& other) {
+  if (context_.is_dead) {
+    return;
+  }
+
+  if (auto* player = other.GetOwner<Player>(); player != nullptr) {
+    if (player->GetVelocity().y <= 0) {
+      player->TakeDamage();
+    }
+  }
 }
 
 }  // namespace game
\ No newline at end of file
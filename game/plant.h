@@ -6,6 +6,7 @@
 #include <SFML/System/Vector2.hpp>
 #include <cstdint>
 
+#include "engine/collider.h"
 #include "engine/fsm.h"
 #include "engine/node.h"
 #include "engine/rectangle_collider.h"
@@ -23,6 +24,10 @@ class Plant : public ng::Node {
  protected:
   void Update() override;
   void Draw(sf::RenderTarget& target) override;
+  void OnCollisionEnter(const ng::Collider& collider,
+                        const ng::Collider& other) override;
+  void OnCollisionStay(const ng::Collider& collider,
+                       const ng::Collider& other) override;
 
  private:
   struct Context {
@@ -81,6 +86,8 @@ class Plant : public ng::Node {
     Plant* plant_ = nullptr;
   };
 
+  void HandleCollision(const ng::Collider& other);
+
   sf::Vector2f direction_{-1, 0};
   const ng::Tilemap* tilemap_ = nullptr;
   const ng::RectangleCollider* collider_ = nullptr;
@@ -2,18 +2,24 @@
 
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/System/Vector2.hpp>
-#include <vector>
+#include <utility>
 
+#include "collision_category.h"
 #include "engine/app.h"
 #include "engine/circle_collider.h"
 #include "engine/collider.h"
 #include "engine/node.h"
+#include "engine/physics.h"
+#include "engine/scene.h"
 #include "engine/tilemap.h"
 #include "player.h"
-#include "tile_id.h"
+#include "tile_flag.h"
+#include "velocity.h"
 
 namespace game {
 
+static constexpr float kMovementSpeed = 6;
+
 PlantBullet::PlantBullet(ng::App* app, const ng::Tilemap* tilemap,
                          sf::Vector2f direction)
     : ng::Node(app),
@@ -26,6 +32,11 @@ PlantBullet::PlantBullet(ng::App* app, const ng::Tilemap* tilemap,
   sprite_.setTextureRect(sf::IntRect({0, 0}, {16, 16}));
 
   auto& collider = MakeChild<ng::CircleCollider>(4.F);
+  // Bullets only ever hit the player.
+  collider.SetCollisionFilter({
+      .category = std::to_underlying(CollisionCategory::kProjectile),
+      .mask = std::to_underlying(CollisionCategory::kPlayer),
+  });
   collider_ = &collider;
 }
 
@@ -33,53 +44,44 @@ bool PlantBullet::GetIsDead() const {
   return is_dead_;
 }
 
-namespace {
-
-bool DoesCollide(sf::Vector2f position, const ng::Tilemap& tilemap) {
-  TileID id = tilemap.GetWorldTile(position).GetID();
-  return id == TileID::kInvisibleBarrier ||
-         (id >= TileID::kDirtTopLeft && id <= TileID::kDirtBottomRight) ||
-         (id >= TileID::kStoneHorizontalLeft &&
-          id <= TileID::kStoneVerticalBottom) ||
-         id == TileID::kPlasticBlock;
+void PlantBullet::OnAdd() {
+  AddComponent<Velocity>(direction_ * kMovementSpeed);
 }
 
-}  // namespace
-
 void PlantBullet::Update() {
   if (is_dead_) {
     return;
   }
 
-  sf::Vector2f pos = GetGlobalTransform().getPosition();
-  if (!tilemap_->IsWithinWorldBounds(pos)) {
-    is_dead_ = true;
-    Destroy();
-    return;
+  // Casting along the motion of this tick hits the player before the bullet
+  // moves into them, however fast it flies.
+  sf::Vector2f velocity = GetComponent<Velocity>()->value;
+  if (auto hit = GetScene()->GetPhysics().ShapeCast(*collider_, direction_,
+                                                    kMovementSpeed)) {
+    HandleHit(*hit->collider);
   }
 
-  if (DoesCollide(pos, *tilemap_)) {
+  ng::TileMoveResult move = tilemap_->MoveAndCollide(
+      collider_->GetBounds(), velocity, std::to_underlying(TileFlag::kSolid));
+  if (move.is_out_of_bounds || move.hit_left_wall || move.hit_right_wall ||
+      move.hit_ceiling || move.is_on_ground) {
     is_dead_ = true;
     Destroy();
     return;
   }
 
-  static constexpr float kMovementSpeed = 6;
-  Translate(direction_ * kMovementSpeed);
-
-  std::vector<const ng::Collider*> others =
-      GetScene()->GetPhysics().Overlap(*collider_);
-  for (const auto* other : others) {
-    if (other->GetParent()->GetName() == "Player") {
-      auto* player = dynamic_cast<Player*>(other->GetParent());
-      player->TakeDamage();
-    }
-  }
+  Translate(velocity);
 }
 
 void PlantBullet::Draw(sf::RenderTarget& target) {
   sprite_.setScale(sf::Vector2f{-direction_.x * 2, 2.F});
-  target.draw(sprite_, GetGlobalTransform().getTransform());
+  target.draw(sprite_, GetGlobalTransform());
+}
+
+void PlantBullet::HandleHit(const ng::Collider& other) {
+  if (auto* player = other.GetOwner<Player>(); player != nullptr) {
+    player->TakeDamage();
+  }
 }
 
 }  // namespace game
\ No newline at end of file
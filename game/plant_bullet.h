@@ -5,6 +5,7 @@
 #include <SFML/System/Vector2.hpp>
 
 #include "engine/circle_collider.h"
+#include "engine/collider.h"
 #include "engine/node.h"
 #include "engine/tilemap.h"
 
@@ -17,10 +18,13 @@ class PlantBullet : public ng::Node {
   bool GetIsDead() const;
 
  protected:
+  void OnAdd() override;
   void Update() override;
   void Draw(sf::RenderTarget& target) override;
 
  private:
+  void HandleHit(const ng::Collider& other);
+
   const ng::Tilemap* tilemap_ = nullptr;
   sf::Vector2f direction_{-1, 0};
   const ng::CircleCollider* collider_ = nullptr;
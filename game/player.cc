@@ -5,13 +5,12 @@
 #include <SFML/Graphics/Sprite.hpp>
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Window/Keyboard.hpp>
-#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <utility>
-#include <vector>
 
 #include "banana.h"
+#include "collision_category.h"
 #include "end.h"
 #include "engine/app.h"
 #include "engine/collider.h"
@@ -28,23 +27,11 @@
 #include "mushroom.h"
 #include "plant.h"
 #include "score_manager.h"
+#include "tile_flag.h"
 #include "tile_id.h"
 
 namespace game {
 
-namespace {
-
-bool DoesCollide(sf::Vector2f position, const ng::Tilemap& tilemap) {
-  TileID id = tilemap.GetWorldTile(position).GetID();
-  return id == TileID::kInvisibleBarrier ||
-         (id >= TileID::kDirtTopLeft && id <= TileID::kDirtBottomRight) ||
-         (id >= TileID::kStoneHorizontalLeft &&
-          id <= TileID::kStoneVerticalBottom) ||
-         id == TileID::kPlasticBlock;
-}
-
-}  // namespace
-
 static constexpr int32_t kAnimationTPF = 4;
 
 Player::IdleState::IdleState(ng::State<Context>::ID id,
@@ -146,6 +133,13 @@ Player::Player(ng::App* app, ng::Tilemap* tilemap, GameManager* game_manager,
 
   auto& collider = MakeChild<ng::RectangleCollider>(sf::Vector2f(32, 48));
   collider.SetLocalPosition({0, 8});
+  collider.SetCollisionFilter({
+      .category = std::to_underlying(CollisionCategory::kPlayer),
+      .mask = std::to_underlying(CollisionCategory::kEnemy) |
+              std::to_underlying(CollisionCategory::kProjectile) |
+              std::to_underlying(CollisionCategory::kPickup) |
+              std::to_underlying(CollisionCategory::kGoal),
+  });
   collider_ = &collider;
 
   animator_.AddState(std::make_unique<RunState>(
@@ -251,150 +245,86 @@ void Player::Update() {  // NOLINT
     context_.velocity.y -= 15;
   }
 
-  sf::Vector2f old_pos = collider_->GetGlobalTransform().getPosition();
-  sf::Vector2f new_pos = old_pos + context_.velocity;
-
-  sf::Vector2f col_half_size = collider_->GetSize() / 2.F;
-  sf::Vector2f tilemap_size = sf::Vector2f(tilemap_->GetTileSize());
-
-  static constexpr float kEps = 0.001F;
-  sf::Vector2f top_left = {new_pos.x - (col_half_size.x - kEps),
-                           old_pos.y - (col_half_size.y - kEps)};
-  sf::Vector2f middle_left = {new_pos.x + (col_half_size.x - kEps),
-                              old_pos.y + (0 - kEps)};
-  sf::Vector2f bottom_left = {new_pos.x - (col_half_size.x - kEps),
-                              old_pos.y + (col_half_size.y - kEps)};
-
-  if (!tilemap_->IsWithinWorldBounds(top_left) ||
-      !tilemap_->IsWithinWorldBounds(middle_left) ||
-      !tilemap_->IsWithinWorldBounds(bottom_left)) {
+  sf::FloatRect bounds = collider_->GetBounds();
+  ng::TileMoveResult move = tilemap_->MoveAndCollide(
+      bounds, context_.velocity, std::to_underlying(TileFlag::kSolid));
+  if (move.is_out_of_bounds) {
     TakeDamage();
     return;
   }
 
-  if (context_.velocity.x < 0 && (DoesCollide(top_left, *tilemap_) ||
-                                  DoesCollide(middle_left, *tilemap_) ||
-                                  DoesCollide(bottom_left, *tilemap_))) {
-    new_pos.x = std::ceil(top_left.x / tilemap_size.x) * tilemap_size.x +
-                col_half_size.x;
+  if (move.hit_left_wall || move.hit_right_wall) {
     context_.velocity.x = 0;
   }
 
-  sf::Vector2f top_right = {new_pos.x + (col_half_size.x - kEps),
-                            old_pos.y - (col_half_size.y - kEps)};
-  sf::Vector2f middle_right = {new_pos.x + (col_half_size.x - kEps),
-                               old_pos.y + (0 - kEps)};
-  sf::Vector2f bottom_right = {new_pos.x + (col_half_size.x - kEps),
-                               old_pos.y + (col_half_size.y - kEps)};
-
-  if (!tilemap_->IsWithinWorldBounds(top_right) ||
-      !tilemap_->IsWithinWorldBounds(middle_right) ||
-      !tilemap_->IsWithinWorldBounds(bottom_right)) {
-    TakeDamage();
-    return;
-  }
-
-  if (context_.velocity.x > 0 && (DoesCollide(top_right, *tilemap_) ||
-                                  DoesCollide(middle_right, *tilemap_) ||
-                                  DoesCollide(bottom_right, *tilemap_))) {
-    new_pos.x = std::floor(top_right.x / tilemap_size.x) * tilemap_size.x -
-                col_half_size.x;
-    context_.velocity.x = 0;
-  }
-
-  top_left = {new_pos.x - (col_half_size.x - kEps),
-              new_pos.y - (col_half_size.y - kEps)};
-  top_right = {new_pos.x + (col_half_size.x - kEps),
-               new_pos.y - (col_half_size.y - kEps)};
-
-  if (!tilemap_->IsWithinWorldBounds(top_left) ||
-      !tilemap_->IsWithinWorldBounds(top_right)) {
-    TakeDamage();
-    return;
-  }
-
-  if (context_.velocity.y < 0 &&
-      (DoesCollide(top_left, *tilemap_) || DoesCollide(top_right, *tilemap_))) {
-    {
-      if (tilemap_->GetWorldTile(top_left).GetID() == TileID::kPlasticBlock) {
-        tilemap_->SetWorldTile(top_left, TileID::kVoid);
-        plastic_block_sound_.play();
-      }
-
-      if (tilemap_->GetWorldTile(top_right).GetID() == TileID::kPlasticBlock) {
-        tilemap_->SetWorldTile(top_right, TileID::kVoid);
+  if (move.hit_ceiling) {
+    static constexpr float kEps = 0.001F;
+    // The blocks right above the corners of the head break.
+    for (sf::Vector2f corner :
+         {move.position + sf::Vector2f{kEps, -kEps},
+          move.position + sf::Vector2f{bounds.size.x - kEps, -kEps}}) {
+      if (tilemap_->GetWorldTile(corner).GetID() == TileID::kPlasticBlock) {
+        tilemap_->SetWorldTile(corner, TileID::kVoid);
         plastic_block_sound_.play();
       }
     }
 
-    new_pos.y = std::ceil(top_left.y / tilemap_size.y) * tilemap_size.y +
-                col_half_size.y;
     context_.velocity.y = 0;
   }
 
-  bottom_left = {new_pos.x - (col_half_size.x - kEps),
-                 new_pos.y + (col_half_size.y - kEps)};
-  bottom_right = {new_pos.x + (col_half_size.x - kEps),
-                  new_pos.y + (col_half_size.y - kEps)};
-
-  if (!tilemap_->IsWithinWorldBounds(bottom_left) ||
-      !tilemap_->IsWithinWorldBounds(bottom_right)) {
-    TakeDamage();
-    return;
-  }
-
-  if (context_.velocity.y > 0 && (DoesCollide(bottom_left, *tilemap_) ||
-                                  DoesCollide(bottom_right, *tilemap_))) {
-    new_pos.y = std::floor(bottom_left.y / tilemap_size.y) * tilemap_size.y -
-                col_half_size.y;
+  if (move.is_on_ground) {
     context_.velocity.y = 0;
-    context_.is_on_ground = true;
-  } else {
-    context_.is_on_ground = false;
   }
+  context_.is_on_ground = move.is_on_ground;
 
+  sf::Vector2f new_pos = move.position + (bounds.size / 2.F);
   SetLocalPosition(new_pos - collider_->GetLocalTransform().getPosition());
-
-  std::vector<const ng::Collider*> others =
-      GetScene()->GetPhysics().Overlap(*collider_);
-  for (const auto* other : others) {
-    if (other->GetParent()->GetName() == "Mushroom") {
-      if (context_.velocity.y > 0) {
-        auto* mushroom = dynamic_cast<Mushroom*>(other->GetParent());
-        if (!mushroom->GetIsDead()) {
-          mushroom->TakeDamage();
-          context_.velocity.y = -10;
-          score_manager_->AddScore(100);
-        }
-      }
-    } else if (other->GetParent()->GetName() == "Plant") {
-      if (context_.velocity.y > 0) {
-        auto* plant = dynamic_cast<Plant*>(other->GetParent());
-        if (!plant->GetIsDead()) {
-          plant->TakeDamage();
-          context_.velocity.y = -10;
-          score_manager_->AddScore(150);
-        }
-      }
-    } else if (other->GetParent()->GetName() == "Banana") {
-      auto* banana = dynamic_cast<Banana*>(other->GetParent());
-      if (!banana->GetIsCollected()) {
-        banana->Collect();
-        score_manager_->AddScore(500);
-        banana_sound_.play();
-      }
-    } else if (other->GetParent()->GetName() == "End") {
-      if (!has_won_) {
-        context_.velocity.y = -15;
-        dynamic_cast<End*>(other->GetParent())->EndGame();
-        has_won_ = true;
-      }
-    }
-  }
 }
 
 void Player::Draw(sf::RenderTarget& target) {
-  target.draw(sprite_, GetGlobalTransform().getTransform());
+  target.draw(sprite_, GetGlobalTransform());
+}
+
+void Player::OnCollisionEnter([[maybe_unused]] const ng::Collider& collider,
+                              const ng::Collider& other) {
+  HandleCollision(other);
+}
+
+void Player::OnCollisionStay([[maybe_unused]] const ng::Collider& collider,
+                             const ng::Collider& other) {
+  HandleCollision(other);
+}
+
+void Player::HandleCollision(const ng::Collider& other) {
+  if (context_.is_dead) {
+    return;
+  }
+
+  if (auto* mushroom = other.GetOwner<Mushroom>(); mushroom != nullptr) {
+    if (context_.velocity.y > 0 && !mushroom->GetIsDead()) {
+      mushroom->TakeDamage();
+      context_.velocity.y = -10;
+      score_manager_->AddScore(100);
+    }
+  } else if (auto* plant = other.GetOwner<Plant>(); plant != nullptr) {
+    if (context_.velocity.y > 0 && !plant->GetIsDead()) {
+      plant->TakeDamage();
+      context_.velocity.y = -10;
+      score_manager_->AddScore(150);
+    }
+  } else if (auto* banana = other.GetOwner<Banana>(); banana != nullptr) {
+    if (!banana->GetIsCollected()) {
+      banana->Collect();
+      score_manager_->AddScore(500);
+      banana_sound_.play();
+    }
+  } else if (auto* end = other.GetOwner<End>(); end != nullptr) {
+    if (!has_won_) {
+      context_.velocity.y = -15;
+      end->EndGame();
+      has_won_ = true;
+    }
+  }
 }
 
 }  // namespace game
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <SFML/Graphics/Text.hpp>
 #include <SFML/System/Vector2.hpp>
 
+#include "engine/collider.h"
 #include "engine/fsm.h"
 #include "engine/node.h"
 #include "engine/rectangle_collider.h"
@@ -26,6 +27,10 @@ class Player : public ng::Node {
  protected:
   void Update() override;
   void Draw(sf::RenderTarget& target) override;
+  void OnCollisionEnter(const ng::Collider& collider,
+                        const ng::Collider& other) override;
+  void OnCollisionStay(const ng::Collider& collider,
+                       const ng::Collider& other) override;
 
  private:
   struct Context {
@@ -106,6 +111,8 @@ class Player : public ng::Node {
     GameManager* game_manager_ = nullptr;
   };
 
+  void HandleCollision(const ng::Collider& other);
+
   ng::Tilemap* tilemap_ = nullptr;
   GameManager* game_manager_ = nullptr;
   ScoreManager* score_manager_ = nullptr;
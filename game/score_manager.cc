@@ -30,7 +30,7 @@ void ScoreManager::Update() {
 }
 
 void ScoreManager::Draw(sf::RenderTarget& target) {
-  target.draw(score_text_, GetGlobalTransform().getTransform());
+  target.draw(score_text_, GetGlobalTransform());
 }
 
 void ScoreManager::UpdateUI() {
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+namespace game {
+
+/// @brief The flags of the game's tiles, used as ng::Tile flag bits.
+enum class TileFlag : uint32_t {  // NOLINT
+  kSolid = 1U << 0U,
+};
+
+}  // namespace game
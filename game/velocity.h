@@ -0,0 +1,12 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+namespace game {
+
+/// @brief The velocity of a moving node in pixels per tick, stored in the packed arrays of its scene's ng::ComponentStore.
+struct Velocity {
+  sf::Vector2f value;
+};
+
+}  // namespace game
@@ -0,0 +1,151 @@
+#pragma once
+
+// Replaces every operator new of the process with one that can count the
+// allocations. Include it in exactly one source file of a test.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace ng::test {
+
+/// @brief The allocations counted since the last StartCountingAllocations.
+struct AllocationCount {
+  // The number of calls to operator new.
+  size_t count = 0;
+  // The number of bytes asked for.
+  size_t bytes = 0;
+  // The number of calls to the aligned forms of operator new.
+  size_t aligned_count = 0;
+  // The number of calls to the aligned forms of operator delete.
+  size_t aligned_free_count = 0;
+};
+
+namespace internal {
+
+inline std::atomic<bool> is_counting = false;
+inline std::atomic<size_t> allocation_count = 0;
+inline std::atomic<size_t> allocated_bytes = 0;
+inline std::atomic<size_t> aligned_allocation_count = 0;
+inline std::atomic<size_t> aligned_free_count = 0;
+
+inline void Count(size_t size) {
+  if (is_counting.load(std::memory_order_relaxed)) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+}
+
+inline void* Allocate(size_t size) {
+  Count(size);
+  if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+inline void* AllocateAligned(size_t size, std::align_val_t alignment) {
+  Count(size);
+  if (is_counting.load(std::memory_order_relaxed)) {
+    aligned_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  auto align = static_cast<size_t>(alignment);
+#if defined(_MSC_VER)
+  void* memory = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+  // aligned_alloc needs a size that is a multiple of the alignment.
+  size_t padded_size = ((size + align) / align) * align;
+  void* memory = std::aligned_alloc(align, padded_size);
+#endif
+  if (memory) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+inline void FreeAligned(void* memory) {
+  if (is_counting.load(std::memory_order_relaxed)) {
+    aligned_free_count.fetch_add(1, std::memory_order_relaxed);
+  }
+#if defined(_MSC_VER)
+  _aligned_free(memory);
+#else
+  std::free(memory);
+#endif
+}
+
+}  // namespace internal
+
+/// @brief Resets the counters and starts counting the allocations, and the aligned deallocations, of every thread.
+inline void StartCountingAllocations() {
+  internal::allocation_count = 0;
+  internal::allocated_bytes = 0;
+  internal::aligned_allocation_count = 0;
+  internal::aligned_free_count = 0;
+  internal::is_counting = true;
+}
+
+/// @brief Stops counting the allocations.
+/// @return The allocations counted since StartCountingAllocations.
+inline AllocationCount StopCountingAllocations() {
+  internal::is_counting = false;
+  return {.count = internal::allocation_count.load(),
+          .bytes = internal::allocated_bytes.load(),
+          .aligned_count = internal::aligned_allocation_count.load(),
+          .aligned_free_count = internal::aligned_free_count.load()};
+}
+
+}  // namespace ng::test
+
+// Every operator new of the process goes through the counter. The nothrow
+// versions call these ones.
+void* operator new(size_t size) {
+  return ng::test::internal::Allocate(size);
+}
+
+void* operator new[](size_t size) {
+  return ng::test::internal::Allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  return ng::test::internal::AllocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return ng::test::internal::AllocateAligned(size, alignment);
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, size_t /*size*/) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory, size_t /*size*/) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t /*alignment*/) noexcept {
+  ng::test::internal::FreeAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t /*alignment*/) noexcept {
+  ng::test::internal::FreeAligned(memory);
+}
+
+void operator delete(void* memory, size_t /*size*/,
+                     std::align_val_t /*alignment*/) noexcept {
+  ng::test::internal::FreeAligned(memory);
+}
+
+void operator delete[](void* memory, size_t /*size*/,
+                       std::align_val_t /*alignment*/) noexcept {
+  ng::test::internal::FreeAligned(memory);
+}
@@ -0,0 +1,202 @@
+#include <SFML/Graphics/Transform.hpp>
+#include <SFML/System/Angle.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "engine/app.h"
+#include "engine/node.h"
+#include "engine/scene.h"
+#include "tests/test.h"
+
+namespace {
+
+// The number of ticks of the harness, and of changes made before each tick.
+constexpr int kTickCount = 200;
+constexpr int kChangesPerTick = 10;
+// The number of nodes in the initial tree, a chain deep enough to nest
+// several dirty subtrees.
+constexpr int kInitialNodeCount = 24;
+// The largest difference allowed between the batched and lazy matrices, as
+// they multiply the same transforms in a different order.
+constexpr float kTolerance = 1e-3F;
+
+/// @brief The same node in the batched scene and in the lazy one.
+struct Twin {
+  ng::Node* batched = nullptr;
+  ng::Node* lazy = nullptr;
+  // The index of the parent twin, or -1 for a child of the scene root.
+  int parent = -1;
+  bool is_alive = true;
+};
+
+/// @brief Two scenes changed in lockstep, one with the batched transform pass and one computing every global transform on demand.
+class Harness {
+ public:
+  Harness() {
+    auto batched = std::make_unique<ng::Scene>(&batched_app_);
+    batched->SetBatchedTransforms(true);
+    batched_scene_ = batched.get();
+    batched_app_.LoadScene(std::move(batched));
+    auto lazy = std::make_unique<ng::Scene>(&lazy_app_);
+    lazy_scene_ = lazy.get();
+    lazy_app_.LoadScene(std::move(lazy));
+    Tick();
+  }
+
+  ~Harness() {
+    batched_app_.UnloadScene();
+    lazy_app_.UnloadScene();
+    Tick();
+  }
+
+  Harness(const Harness& other) = delete;
+  Harness& operator=(const Harness& other) = delete;
+  Harness(Harness&& other) = delete;
+  Harness& operator=(Harness&& other) = delete;
+
+  /// @brief Adds a child to a live twin, or to the scene root if parent is -1.
+  void Add(int parent) {
+    ng::Node& batched = parent < 0
+                            ? batched_scene_->MakeChild<ng::Node>()
+                            : twins_[parent].batched->MakeChild<ng::Node>();
+    ng::Node& lazy = parent < 0 ? lazy_scene_->MakeChild<ng::Node>()
+                                : twins_[parent].lazy->MakeChild<ng::Node>();
+    twins_.push_back({.batched = &batched, .lazy = &lazy, .parent = parent});
+  }
+
+  /// @brief Destroys a twin and marks its descendants as dead.
+  void Destroy(int index) {
+    twins_[index].batched->Destroy();
+    twins_[index].lazy->Destroy();
+    twins_[index].is_alive = false;
+    // Children always come after their parent.
+    for (Twin& twin : twins_) {
+      if (twin.parent >= 0 && !twins_[twin.parent].is_alive) {
+        twin.is_alive = false;
+      }
+    }
+  }
+
+  /// @brief Runs a tick of both apps.
+  void Tick() {
+    batched_app_.RunTicks(1);
+    lazy_app_.RunTicks(1);
+  }
+
+  /// @brief Checks that a twin has the same global transform in both scenes. Reading it computes it on demand where it is still dirty.
+  [[nodiscard]] bool Matches(const Twin& twin) const {
+    const float* batched = twin.batched->GetGlobalTransform().getMatrix();
+    const float* lazy = twin.lazy->GetGlobalTransform().getMatrix();
+    for (size_t i = 0; i < 16; ++i) {
+      float scale = std::max(1.F, std::abs(lazy[i]));
+      if (std::abs(batched[i] - lazy[i]) > kTolerance * scale) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// @brief Returns the indices of the live twins.
+  [[nodiscard]] std::vector<int> GetLiveIndices() const {
+    std::vector<int> indices;
+    for (size_t i = 0; i < twins_.size(); ++i) {
+      if (twins_[i].is_alive) {
+        indices.push_back(static_cast<int>(i));
+      }
+    }
+    return indices;
+  }
+
+  [[nodiscard]] Twin& GetTwin(int index) { return twins_[index]; }
+
+ private:
+  ng::App batched_app_{60};
+  ng::App lazy_app_{60};
+  ng::Scene* batched_scene_ = nullptr;
+  ng::Scene* lazy_scene_ = nullptr;
+  // Every twin ever added, dead ones included, so indices stay stable.
+  std::vector<Twin> twins_;
+};
+
+void TestBatchedMatchesLazy() {
+  Harness harness;
+  std::mt19937 random(1234);
+  // A chain, with a few side branches, so moves happen at many depths.
+  harness.Add(-1);
+  for (int i = 1; i < kInitialNodeCount; ++i) {
+    harness.Add(i % 4 == 0 ? (i / 2) : i - 1);
+  }
+  harness.Tick();
+
+  std::uniform_real_distribution<float> position(-50, 50);
+  std::uniform_real_distribution<float> degrees(-180, 180);
+  std::uniform_real_distribution<float> scale(0.5F, 1.5F);
+  bool does_match = true;
+  for (int tick = 0; tick < kTickCount && does_match; ++tick) {
+    for (int change = 0; change < kChangesPerTick; ++change) {
+      std::vector<int> live = harness.GetLiveIndices();
+      if (live.empty()) {
+        harness.Add(-1);
+        continue;
+      }
+      int index = live[random() % live.size()];
+      Twin& twin = harness.GetTwin(index);
+      switch (random() % 8) {
+        case 0:
+        case 1: {
+          sf::Vector2f moved(position(random), position(random));
+          twin.batched->SetLocalPosition(moved);
+          twin.lazy->SetLocalPosition(moved);
+          break;
+        }
+        case 2: {
+          sf::Angle rotation = sf::degrees(degrees(random));
+          twin.batched->SetLocalRotation(rotation);
+          twin.lazy->SetLocalRotation(rotation);
+          break;
+        }
+        case 3: {
+          sf::Vector2f scaled(scale(random), scale(random));
+          twin.batched->SetLocalScale(scaled);
+          twin.lazy->SetLocalScale(scaled);
+          break;
+        }
+        case 4:
+          // The new child joins a subtree that may be moved again before
+          // the pass.
+          harness.Add(index);
+          break;
+        case 5:
+          if (live.size() > kInitialNodeCount / 2) {
+            harness.Destroy(index);
+          }
+          break;
+        default:
+          // Reading between changes computes dirty ancestors on demand,
+          // before the pass of the next tick.
+          does_match = does_match && harness.Matches(twin);
+          break;
+      }
+    }
+    harness.Tick();
+
+    for (int index : harness.GetLiveIndices()) {
+      does_match = does_match && harness.Matches(harness.GetTwin(index));
+    }
+  }
+  ng::test::Expect(does_match,
+                   "batched global transforms to match the lazy ones");
+}
+
+}  // namespace
+
+int main() {
+  TestBatchedMatchesLazy();
+  return ng::test::GetExitCode();
+}
@@ -0,0 +1,228 @@
+#include "engine/broadphase.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "engine/collision_filter.h"
+#include "engine/dynamic_aabb_tree.h"
+#include "engine/spatial_grid.h"
+#include "engine/sweep_and_prune.h"
+#include "tests/test.h"
+
+namespace {
+
+// The number of collider ids used by the tests. The id of each collider is
+// also its index in the brute force mirror.
+constexpr size_t kColliderCount = 256;
+
+ng::ColliderId GetId(size_t index) {
+  return static_cast<ng::ColliderId>(index);
+}
+
+/// @brief A brute force mirror of the colliders stored in the broadphase.
+struct Entry {
+  sf::FloatRect bounds;
+  ng::CollisionFilter filter;
+};
+
+/// @brief Makes a broadphase to test.
+using BroadphaseFactory = std::function<std::unique_ptr<ng::Broadphase>()>;
+
+/// @brief Checks that a query result holds the expected colliders, each once. An exact broadphase must return nothing else, a conservative one may also return colliders near the query, such as the ones a DynamicAabbTree finds through their fattened bounds.
+template <typename T>
+bool Matches(std::vector<T> result, std::vector<T> expected, bool is_exact) {
+  std::sort(result.begin(), result.end());
+  std::sort(expected.begin(), expected.end());
+  if (is_exact) {
+    return result == expected;
+  }
+  return std::adjacent_find(result.begin(), result.end()) == result.end() &&
+         std::includes(result.begin(), result.end(), expected.begin(),
+                       expected.end());
+}
+
+void ExpectMatchesBruteForce(
+    const ng::Broadphase& broadphase,
+    const std::vector<std::optional<Entry>>& entries, sf::FloatRect query,
+    sf::Vector2f displacement, ng::CollisionFilter filter, bool is_exact) {
+  std::vector<ng::ColliderPair> expected_pairs;
+  std::vector<ng::ColliderId> expected_hits;
+  std::vector<ng::ColliderId> expected_cast_hits;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (!entries[i]) {
+      continue;
+    }
+
+    if (filter.CanCollide(entries[i]->filter)) {
+      if (ng::Overlaps(entries[i]->bounds, query)) {
+        expected_hits.push_back(GetId(i));
+      }
+      if (ng::CastOverlaps(query, displacement, entries[i]->bounds)) {
+        expected_cast_hits.push_back(GetId(i));
+      }
+    }
+
+    for (size_t j = i + 1; j < entries.size(); ++j) {
+      if (entries[j] && entries[i]->filter.CanCollide(entries[j]->filter) &&
+          ng::Overlaps(entries[i]->bounds, entries[j]->bounds)) {
+        expected_pairs.push_back(ng::MakeColliderPair(GetId(i), GetId(j)));
+      }
+    }
+  }
+
+  std::vector<ng::ColliderPair> pairs;
+  broadphase.QueryPairs(pairs);
+  ng::test::Expect(Matches(pairs, expected_pairs, is_exact),
+                   "QueryPairs to match");
+  // Even a conservative broadphase must respect the filters.
+  ng::test::Expect(std::ranges::all_of(
+                       pairs,
+                       [&](const ng::ColliderPair& pair) -> bool {
+                         const auto& a = entries[pair.first];
+                         const auto& b = entries[pair.second];
+                         return a && b && a->filter.CanCollide(b->filter);
+                       }),
+                   "QueryPairs to only return live colliders that can collide");
+
+  std::vector<ng::ColliderId> hits;
+  broadphase.Query(query, filter, hits);
+  ng::test::Expect(Matches(hits, expected_hits, is_exact), "Query to match");
+
+  std::vector<ng::ColliderId> cast_hits;
+  broadphase.QueryCast(query, displacement, filter, cast_hits);
+  ng::test::Expect(Matches(cast_hits, expected_cast_hits, is_exact),
+                   "QueryCast to match");
+}
+
+void TestMoveFurtherThanWidth(const BroadphaseFactory& make_broadphase,
+                              bool is_exact) {
+  std::unique_ptr<ng::Broadphase> broadphase = make_broadphase();
+  std::vector<std::optional<Entry>> entries(3);
+  entries[0] = Entry{.bounds = {{0, 0}, {10, 10}}, .filter = {}};
+  entries[1] = Entry{.bounds = {{100, 0}, {10, 10}}, .filter = {}};
+  entries[2] = Entry{.bounds = {{300, 0}, {10, 10}}, .filter = {}};
+  for (size_t i = 0; i < entries.size(); ++i) {
+    broadphase->Insert(GetId(i), entries[i]->bounds, {});
+  }
+
+  // Jumps right onto the second collider, then left past it onto nothing, then
+  // right past the second collider onto the third one.
+  for (float x : {105.F, 50.F, 305.F, -40.F}) {
+    entries[0]->bounds.position.x = x;
+    broadphase->Update(GetId(0), entries[0]->bounds);
+    for (const std::optional<Entry>& entry : entries) {
+      ExpectMatchesBruteForce(*broadphase, entries, entry->bounds, {}, {},
+                              is_exact);
+    }
+  }
+}
+
+void TestRandomOperations(const BroadphaseFactory& make_broadphase,
+                          bool is_exact) {
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> position(0, 2000);
+  std::uniform_real_distribution<float> size(1, 64);
+  std::uniform_real_distribution<float> small_step(-4, 4);
+  std::uniform_real_distribution<float> large_step(-300, 300);
+  std::uniform_int_distribution<size_t> collider(0, kColliderCount - 1);
+  std::uniform_int_distribution<int> operation(0, 9);
+  std::uniform_int_distribution<uint32_t> category(0, 2);
+
+  std::unique_ptr<ng::Broadphase> broadphase = make_broadphase();
+  std::vector<std::optional<Entry>> entries(kColliderCount);
+  auto random_bounds = [&]() -> sf::FloatRect {
+    return {{position(random), position(random) / 4},
+            {size(random), size(random)}};
+  };
+  auto random_filter = [&]() -> ng::CollisionFilter {
+    return {.category = 1U << category(random),
+            .mask = ~(1U << category(random))};
+  };
+
+  for (int step = 0; step < 5000; ++step) {
+    size_t index = collider(random);
+    std::optional<Entry>& entry = entries[index];
+    int kind = operation(random);
+    if (!entry) {
+      entry = Entry{.bounds = random_bounds(), .filter = random_filter()};
+      broadphase->Insert(GetId(index), entry->bounds, entry->filter);
+    } else if (kind == 0) {
+      broadphase->Remove(GetId(index));
+      entry.reset();
+    } else {
+      // Most moves are small, like moving bodies, but some jump further than
+      // the width of the collider, like teleports.
+      float dx = kind < 7 ? small_step(random) : large_step(random);
+      entry->bounds.position.x += dx;
+      entry->bounds.position.y += small_step(random);
+      if (kind == 9) {
+        entry->bounds.size = {size(random), size(random)};
+      }
+      broadphase->Update(GetId(index), entry->bounds);
+    }
+
+    if (step % 10 == 0) {
+      sf::Vector2f displacement{large_step(random), small_step(random)};
+      ExpectMatchesBruteForce(*broadphase, entries, random_bounds(),
+                              displacement, random_filter(), is_exact);
+    }
+  }
+}
+
+void TestTreeStaysBalanced() {
+  // Colliders inserted in order along a line would make a list of an
+  // unbalanced tree, as deep as the number of colliders.
+  ng::DynamicAabbTree tree;
+  std::vector<std::optional<Entry>> entries(kColliderCount);
+  for (size_t i = 0; i < kColliderCount; ++i) {
+    entries[i] =
+        Entry{.bounds = {{static_cast<float>(i) * 16, 0}, {16, 16}}, .filter = {}};
+    tree.Insert(GetId(i), entries[i]->bounds, {});
+  }
+  // An AVL tree of 256 leaves is less than 1.45 * log2(256) levels deep.
+  ng::test::Expect(tree.GetHeight() <= 12, "the tree to stay balanced");
+  ExpectMatchesBruteForce(tree, entries, {{0, 0}, {4096, 16}}, {0, 16}, {},
+                          false);
+
+  for (size_t i = 0; i < kColliderCount; ++i) {
+    tree.Remove(GetId(i));
+  }
+  ng::test::Expect(tree.GetHeight() == 0, "the emptied tree to have no levels");
+}
+
+}  // namespace
+
+int main() {
+  const BroadphaseFactory factories[] = {
+      []() -> std::unique_ptr<ng::Broadphase> {
+        return std::make_unique<ng::SweepAndPrune>();
+      },
+      []() -> std::unique_ptr<ng::Broadphase> {
+        return std::make_unique<ng::SpatialGrid>(sf::Vector2f(32, 32));
+      },
+      []() -> std::unique_ptr<ng::Broadphase> {
+        return std::make_unique<ng::DynamicAabbTree>(0.F);
+      },
+  };
+  for (const BroadphaseFactory& make_broadphase : factories) {
+    TestMoveFurtherThanWidth(make_broadphase, true);
+    TestRandomOperations(make_broadphase, true);
+  }
+
+  // The fattened bounds make the default tree conservative.
+  BroadphaseFactory make_fat_tree = []() -> std::unique_ptr<ng::Broadphase> {
+    return std::make_unique<ng::DynamicAabbTree>();
+  };
+  TestMoveFurtherThanWidth(make_fat_tree, false);
+  TestRandomOperations(make_fat_tree, false);
+  TestTreeStaysBalanced();
+  return ng::test::GetExitCode();
+}
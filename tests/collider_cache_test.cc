@@ -0,0 +1,144 @@
+#include "engine/collider_cache.h"
+
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "engine/app.h"
+#include "engine/circle_collider.h"
+#include "engine/collider.h"
+#include "engine/collision_filter.h"
+#include "engine/rectangle_collider.h"
+#include "engine/scene.h"
+#include "tests/test.h"
+
+namespace {
+
+/// @brief Adds the colliders of the test to a scene: a few pairs that touch exactly, then random shapes on a small integer grid, where touching is common and every coordinate is exact.
+/// @param scene The scene to add the colliders to.
+/// @return The colliders, in the order they were added.
+std::vector<ng::Collider*> MakeColliders(ng::Scene& scene) {
+  std::vector<ng::Collider*> colliders;
+  auto add_rectangle = [&](sf::Vector2f center, sf::Vector2f size) -> void {
+    colliders.push_back(&scene.MakeChild<ng::RectangleCollider>(size));
+    colliders.back()->SetLocalPosition(center);
+  };
+  auto add_circle = [&](sf::Vector2f center, float radius) -> void {
+    colliders.push_back(&scene.MakeChild<ng::CircleCollider>(radius));
+    colliders.back()->SetLocalPosition(center);
+  };
+
+  // Rectangles sharing an edge.
+  add_rectangle({0, 0}, {10, 10});
+  add_rectangle({10, 0}, {10, 10});
+  // Circles whose centers are exactly the sum of their radii apart.
+  add_circle({100, 100}, 5);
+  add_circle({106, 108}, 5);
+  // A circle touching the corner of a rectangle.
+  add_circle({200, 200}, 5);
+  add_rectangle({204, 205}, {2, 2});
+  // A circle touching the edge of a rectangle.
+  add_circle({300, 300}, 4);
+  add_rectangle({310, 300}, {12, 6});
+
+  std::mt19937 random(3);
+  std::uniform_int_distribution<int> position(0, 48);
+  std::uniform_int_distribution<int> size(1, 8);
+  std::uniform_int_distribution<int> kind(0, 3);
+  // 195 entries in total, so the last batch is partial.
+  for (int i = 0; i < 187; ++i) {
+    sf::Vector2f center(static_cast<float>(position(random)),
+                        static_cast<float>(position(random)));
+    if (kind(random) == 0) {
+      add_circle(center, static_cast<float>(size(random)));
+    } else {
+      add_rectangle(center, {static_cast<float>(2 * size(random)),
+                             static_cast<float>(2 * size(random))});
+    }
+    if (kind(random) == 0) {
+      colliders.back()->SetCollisionFilter(
+          {.category = 2U, .mask = static_cast<uint32_t>(kind(random))});
+    }
+  }
+  return colliders;
+}
+
+void TestKernel(const std::vector<ng::Collider*>& colliders,
+                ng::BatchKernel kernel) {
+  ng::ColliderCache cache;
+  for (const ng::Collider* collider : colliders) {
+    cache.Add(collider);
+  }
+  cache.SetBatchKernel(kernel);
+
+  size_t size = cache.GetSize();
+  size_t touching_count = 0;
+  for (size_t index = 0; index < size; ++index) {
+    // Every start index is tested, so batches cover every alignment and every
+    // length of the last batch.
+    for (size_t first = 0; first < size; ++first) {
+      uint32_t mask = cache.CollidesBatch(first, index);
+      uint32_t shape_mask =
+          cache.CollidesBatch(first, cache.GetShape(index),
+                              cache.GetBounds(index), cache.GetFilter(index));
+      for (size_t i = 0; i < ng::ColliderCache::kBatchSize; ++i) {
+        bool bit = ((mask >> i) & 1U) != 0;
+        bool shape_bit = ((shape_mask >> i) & 1U) != 0;
+        if (first + i >= size) {
+          ng::test::Expect(!bit && !shape_bit, "no bits past the last entry");
+          continue;
+        }
+
+        bool expected = cache.Collides(first + i, index);
+        ng::test::Expect(bit == expected, "the batch to match Collides");
+        ng::test::Expect(
+            shape_bit == cache.Collides(first + i, cache.GetShape(index),
+                                        cache.GetBounds(index),
+                                        cache.GetFilter(index)),
+            "the shape batch to match Collides");
+
+        // Checks the cached geometry against the shapes of the colliders.
+        ng::test::Expect(
+            expected == (cache.GetFilter(first + i)
+                             .CanCollide(cache.GetFilter(index)) &&
+                         ng::ColliderCache::Collides(
+                             cache.GetShape(first + i),
+                             cache.GetCollider(first + i)->GetBounds(),
+                             cache.GetShape(index),
+                             cache.GetCollider(index)->GetBounds())),
+            "Collides to match the collider shapes");
+
+        sf::FloatRect a = cache.GetBounds(first + i);
+        sf::FloatRect b = cache.GetBounds(index);
+        if (expected && (a.position.x + a.size.x == b.position.x ||
+                         a.position.y + a.size.y == b.position.y)) {
+          ++touching_count;
+        }
+      }
+    }
+  }
+
+  ng::test::Expect(touching_count > 0, "touching shapes to be tested");
+}
+
+}  // namespace
+
+int main() {
+  ng::App app(60);
+  auto scene = std::make_unique<ng::Scene>(&app);
+  std::vector<ng::Collider*> colliders = MakeColliders(*scene);
+  app.LoadScene(std::move(scene));
+  app.RunTicks(1);
+
+  for (ng::BatchKernel kernel :
+       {ng::BatchKernel::kScalar, ng::BatchKernel::kSse2,
+        ng::BatchKernel::kAvx2}) {
+    if (ng::ColliderCache::IsBatchKernelAvailable(kernel)) {
+      TestKernel(colliders, kernel);
+    }
+  }
+  return ng::test::GetExitCode();
+}
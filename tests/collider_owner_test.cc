@@ -0,0 +1,110 @@
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "engine/app.h"
+#include "engine/collider.h"
+#include "engine/node.h"
+#include "engine/physics.h"
+#include "engine/rectangle_collider.h"
+#include "engine/scene.h"
+#include "tests/test.h"
+
+namespace {
+
+/// @brief A node that owns a collider, like the characters of the game.
+class Crate : public ng::Node {
+ public:
+  Crate(ng::App* app, sf::Vector2f position)
+      : ng::Node(app),
+        collider_(&MakeChild<ng::RectangleCollider>(sf::Vector2f(16, 16))) {
+    SetLocalPosition(position);
+  }
+
+  [[nodiscard]] const ng::Collider& GetCollider() const { return *collider_; }
+
+ private:
+  // The collider of the crate. Never null.
+  ng::Collider* collider_ = nullptr;
+};
+
+/// @brief A subclass, which has a TypeId of its own.
+class HeavyCrate : public Crate {
+ public:
+  using Crate::Crate;
+};
+
+class Barrel final : public Crate {
+ public:
+  using Crate::Crate;
+};
+
+void TestOwners() {
+  ng::App app(60);
+  auto owned = std::make_unique<ng::Scene>(&app);
+  ng::Scene& scene = *owned;
+  // Every owner overlaps the probe at the origin.
+  auto& crate = scene.MakeChild<Crate>(sf::Vector2f(4, 0));
+  auto& heavy = scene.MakeChild<HeavyCrate>(sf::Vector2f(0, 4));
+  auto added = std::make_unique<Crate>(&app, sf::Vector2f(-4, 0));
+  Crate& added_crate = *added;
+  scene.AddChild(std::move(added));
+  auto barrel = std::make_unique<Barrel>(&app, sf::Vector2f(0, -4));
+  Barrel& added_barrel = *barrel;
+  scene.AddChild(std::move(barrel));
+  auto& probe = scene.MakeChild<ng::RectangleCollider>(sf::Vector2f(16, 16));
+  // Far from the others, so typed queries never see its untyped owner.
+  auto hidden = std::make_unique<Crate>(&app, sf::Vector2f(1000, 1000));
+  Crate& hidden_crate = *hidden;
+  scene.AddChild(std::unique_ptr<ng::Node>(std::move(hidden)));
+  app.LoadScene(std::move(owned));
+  app.RunTicks(1);
+
+  ng::test::Expect(crate.GetCollider().GetOwner<Crate>() == &crate,
+                   "GetOwner to find an owner made by MakeChild");
+  ng::test::Expect(added_crate.GetCollider().GetOwner<Crate>() == &added_crate,
+                   "GetOwner to find an owner given to AddChild");
+  ng::test::Expect(
+      added_barrel.GetCollider().GetOwner<Barrel>() == &added_barrel,
+      "GetOwner to find a final owner given to AddChild");
+  ng::test::Expect(heavy.GetCollider().GetOwner<HeavyCrate>() == &heavy,
+                   "GetOwner to find an owner of a subclass by its own type");
+  ng::test::Expect(heavy.GetCollider().GetOwner<Crate>() == nullptr,
+                   "GetOwner to miss an owner of a subclass of the type");
+  ng::test::Expect(crate.GetCollider().GetOwner<Barrel>() == nullptr,
+                   "GetOwner to miss an owner of another type");
+  ng::test::Expect(probe.IsOwnerTypeKnown() &&
+                       probe.GetOwner<Crate>() == nullptr,
+                   "GetOwner to miss the scene root");
+  ng::test::Expect(!hidden_crate.GetCollider().IsOwnerTypeKnown(),
+                   "an owner added through a base class to have no type");
+
+  const ng::Physics& physics = scene.GetPhysics();
+  std::vector<Crate*> crates = physics.OverlapOwners<Crate>(probe);
+  std::ranges::sort(crates);
+  std::vector<Crate*> expected = {&crate, &added_crate};
+  std::ranges::sort(expected);
+  ng::test::Expect(crates == expected,
+                   "OverlapOwners to find the owners of exactly the type");
+  ng::test::Expect(physics.OverlapOwners<HeavyCrate>(probe) ==
+                       std::vector<HeavyCrate*>{&heavy},
+                   "OverlapOwners to find the owners of a subclass");
+  ng::test::Expect(physics.OverlapOwners<Barrel>(probe) ==
+                       std::vector<Barrel*>{&added_barrel},
+                   "OverlapOwners to find a final owner given to AddChild");
+  ng::test::Expect(
+      physics.OverlapOwners<Crate>(crate.GetCollider()).size() == 1,
+      "OverlapOwners to skip the owner of the collider itself");
+
+  app.UnloadScene();
+  app.RunTicks(1);
+}
+
+}  // namespace
+
+int main() {
+  TestOwners();
+  return ng::test::GetExitCode();
+}
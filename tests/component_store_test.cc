@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "engine/app.h"
+#include "engine/component_store.h"
+#include "engine/entity.h"
+#include "engine/node.h"
+#include "engine/scene.h"
+#include "tests/test.h"
+
+namespace {
+
+struct Position {
+  int x = 0;
+};
+
+struct Velocity {
+  int dx = 0;
+};
+
+struct Health {
+  int points = 0;
+};
+
+/// @brief Checks that every component of a type is found again through its entity, and that GetEntities and GetComponents agree.
+template <typename T>
+bool IsPacked(ng::ComponentStore& store) {
+  std::span<T> components = store.GetComponents<T>();
+  std::span<const ng::Entity> entities = store.GetEntities<T>();
+  if (components.size() != entities.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < entities.size(); ++i) {
+    if (store.Get<T>(entities[i]) != &components[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TestGenerations() {
+  ng::ComponentStore store;
+  ng::Entity first = store.CreateEntity();
+  store.Add<Health>(first, 3);
+  store.DestroyEntity(first);
+  ng::test::Expect(!store.IsAlive(first), "a destroyed entity to be dead");
+  ng::test::Expect(store.GetComponents<Health>().empty(),
+                   "a destroyed entity to lose its components");
+
+  ng::Entity second = store.CreateEntity();
+  ng::test::Expect(second.index == first.index &&
+                       second.generation == first.generation + 1,
+                   "a freed slot to be reused with a new generation");
+  store.Add<Health>(second, 5);
+  ng::test::Expect(
+      store.Get<Health>(first) == nullptr && !store.Has<Health>(first),
+      "a stale entity not to reach the components of the new one");
+  const ng::ComponentStore& const_store = store;
+  ng::test::Expect(const_store.Get<Health>(second) != nullptr &&
+                       const_store.Get<Health>(second)->points == 5,
+                   "the new entity to own its components");
+
+  // Destroying or removing through a stale entity is a no-op.
+  store.DestroyEntity(first);
+  store.Remove<Health>(first);
+  ng::test::Expect(store.IsAlive(second) && store.Has<Health>(second),
+                   "a stale entity not to destroy the new one");
+  ng::test::Expect(store.GetEntityCount() == 1, "a single entity to be alive");
+}
+
+void TestSwapRemove() {
+  ng::ComponentStore store;
+  std::vector<ng::Entity> entities;
+  for (int i = 0; i < 6; ++i) {
+    ng::Entity entity = store.CreateEntity();
+    store.Add<Position>(entity, i);
+    entities.push_back(entity);
+  }
+
+  // Removing the first component moves the last one into its place.
+  store.Remove<Position>(entities[0]);
+  ng::test::Expect(store.GetEntities<Position>().front() == entities[5],
+                   "the last component to fill the hole");
+  ng::test::Expect(store.Get<Position>(entities[5])->x == 5,
+                   "a moved component to keep its value");
+  // Removing the last component moves nothing.
+  store.Remove<Position>(entities[4]);
+  // Removing a component twice is a no-op.
+  store.Remove<Position>(entities[0]);
+  ng::test::Expect(store.GetComponents<Position>().size() == 4,
+                   "removed components to leave the pool");
+  ng::test::Expect(IsPacked<Position>(store),
+                   "every moved component to be found by its entity");
+  for (size_t i : {1, 2, 3, 5}) {
+    ng::test::Expect(store.Get<Position>(entities[i])->x == static_cast<int>(i),
+                     "every remaining component to keep its value");
+  }
+  ng::test::Expect(!store.Has<Position>(entities[0]) &&
+                       !store.Has<Position>(entities[4]) &&
+                       store.IsAlive(entities[0]),
+                   "removing a component to keep its entity alive");
+}
+
+void TestForEach() {
+  ng::ComponentStore store;
+  std::vector<ng::Entity> moving;
+  for (int i = 0; i < 8; ++i) {
+    ng::Entity entity = store.CreateEntity();
+    store.Add<Position>(entity, i);
+    // Only every third entity moves, so the Velocity pool is the smallest.
+    if (i % 3 == 0) {
+      store.Add<Velocity>(entity, 10);
+      moving.push_back(entity);
+    }
+  }
+  // A Velocity without a Position is skipped.
+  store.Add<Velocity>(store.CreateEntity(), 100);
+
+  std::vector<ng::Entity> visited;
+  store.ForEach<Position, Velocity>(
+      [&visited](ng::Entity entity, Position& position, Velocity& velocity) {
+        position.x += velocity.dx;
+        visited.push_back(entity);
+      });
+  auto by_index = [](ng::Entity a, ng::Entity b) { return a.index < b.index; };
+  std::ranges::sort(visited, by_index);
+  ng::test::Expect(visited == moving,
+                   "ForEach to visit every entity with both components");
+  ng::test::Expect(store.Get<Position>(moving[1])->x == 13,
+                   "ForEach to hand out the components of the entity");
+
+  size_t count = 0;
+  store.ForEach<Position>(
+      [&count](ng::Entity /*entity*/, Position& /*position*/) { ++count; });
+  ng::test::Expect(count == 8, "ForEach of a single pool to visit it all");
+  store.ForEach<Health>([](ng::Entity /*entity*/, Health& /*health*/) {
+    ng::test::Expect(false, "ForEach to skip a type that has no pool");
+  });
+}
+
+/// @brief A node that reads its component when it is destroyed.
+class Monster : public ng::Node {
+ public:
+  Monster(ng::App* app, int* last_points)
+      : ng::Node(app), last_points_(last_points) {}
+
+ protected:
+  void OnAdd() override { AddComponent<Health>(7); }
+  void OnDestroy() override { *last_points_ = GetComponent<Health>()->points; }
+
+ private:
+  // Where the health of the monster is written when it is destroyed.
+  int* last_points_ = nullptr;
+};
+
+void TestNodeComponents() {
+  ng::App app(60);
+  auto owned = std::make_unique<ng::Scene>(&app);
+  ng::Scene& scene = *owned;
+  app.LoadScene(std::move(owned));
+  app.RunTicks(1);
+
+  int last_points = 0;
+  auto& monster = scene.MakeChild<Monster>(&last_points);
+  auto& pet = monster.MakeChild<Monster>(&last_points);
+  ng::Node& rock = scene.MakeChild<ng::Node>();
+  app.RunTicks(1);
+  pet.AddComponent<Position>(4);
+  rock.AddComponent<Position>(9);
+
+  ng::ComponentStore& store = scene.GetMutableComponents();
+  ng::test::Expect(store.GetEntityCount() == 3 &&
+                       store.GetComponents<Health>().size() == 2,
+                   "each node with components to own an entity");
+  ng::test::Expect(rock.GetComponent<Health>() == nullptr &&
+                       rock.GetComponent<Position>()->x == 9,
+                   "a node to only have the components added to it");
+  ng::Entity pet_entity = pet.GetEntity();
+
+  // Destroying a node destroys the components of its whole subtree.
+  monster.Destroy();
+  app.RunTicks(1);
+  ng::test::Expect(last_points == 7,
+                   "OnDestroy to still read the components of the node");
+  ng::test::Expect(store.GetEntityCount() == 1 && !store.IsAlive(pet_entity),
+                   "a destroyed node to destroy its entity");
+  ng::test::Expect(store.GetComponents<Health>().empty() &&
+                       store.GetComponents<Position>().size() == 1,
+                   "a destroyed node to destroy its components");
+  ng::test::Expect(IsPacked<Position>(store),
+                   "the components of other nodes to stay reachable");
+
+  rock.RemoveComponent<Position>();
+  ng::test::Expect(rock.GetComponent<Position>() == nullptr,
+                   "RemoveComponent to remove the component of the node");
+
+  app.UnloadScene();
+  app.RunTicks(1);
+}
+
+}  // namespace
+
+int main() {
+  TestGenerations();
+  TestSwapRemove();
+  TestForEach();
+  TestNodeComponents();
+  return ng::test::GetExitCode();
+}
@@ -0,0 +1,45 @@
+#include <cstdint>
+#include <cstdio>
+
+#include "engine/app.h"
+#include "game/default_scene.h"
+#include "tests/allocation_counter.h"
+#include "tests/test.h"
+
+namespace {
+
+// The number of ticks run before counting, so that every buffer reused
+// across ticks has reached its steady-state capacity.
+constexpr uint32_t kWarmUpTicks = 120;
+// The number of ticks whose allocations are counted.
+constexpr uint32_t kMeasuredTicks = 600;
+
+}  // namespace
+
+int main() {
+  ng::App app({832U, 640U}, "Default Scene Allocation Test", 60, 60);
+  app.LoadScene(game::MakeDefaultScene(&app));
+  app.RunTicks(kWarmUpTicks);
+
+  ng::test::StartCountingAllocations();
+  app.RunTicks(kMeasuredTicks);
+  ng::test::AllocationCount ticks = ng::test::StopCountingAllocations();
+
+  std::printf("%zu allocations in %u ticks\n", ticks.count, kMeasuredTicks);
+  ng::test::Expect(ticks.count == 0,
+                   "no heap allocation in steady-state ticks");
+
+  // The first restart allocates the arena of the second scene, since the old
+  // scene is still alive while the new one is made. Later restarts reuse it.
+  app.LoadScene(game::MakeDefaultScene(&app));
+  app.RunTicks(1);
+  ng::test::StartCountingAllocations();
+  app.LoadScene(game::MakeDefaultScene(&app));
+  app.RunTicks(1);
+  ng::test::AllocationCount restart = ng::test::StopCountingAllocations();
+
+  // Not expected to be zero yet: the nodes' own containers still allocate.
+  std::printf("%zu allocations (%zu bytes) to restart the level\n",
+              restart.count, restart.bytes);
+  return ng::test::GetExitCode();
+}
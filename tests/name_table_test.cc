@@ -0,0 +1,77 @@
+#include "engine/name_table.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+
+#include "engine/app.h"
+#include "engine/node.h"
+#include "engine/scene.h"
+#include "tests/test.h"
+
+namespace {
+
+// Two names with the same 32-bit FNV-1a hash.
+constexpr std::string_view kName = "Node86939";
+constexpr std::string_view kCollidingName = "Node821602";
+static_assert(ng::HashName(kName) == ng::HashName(kCollidingName));
+
+void TestIntern() {
+  ng::NameTable table;
+  ng::test::Expect(table.Intern("") == ng::kNoName,
+                   "the empty name to be kNoName");
+  ng::test::Expect(table.Intern("Player") == ng::HashName("Player"),
+                   "the id to be the hash of the name");
+  ng::test::Expect(table.Intern("Player") == ng::HashName("Player"),
+                   "interning twice to give the same id");
+  ng::test::Expect(table.GetString(ng::HashName("Player")) == "Player",
+                   "the text of an interned name");
+  ng::test::Expect(table.GetString(ng::HashName("Mushroom")).empty(),
+                   "no text for a name that was never interned");
+}
+
+void TestCollision() {
+  ng::NameTable table;
+  table.Intern(kName);
+  bool has_thrown = false;
+  try {
+    table.Intern(kCollidingName);
+  } catch (const std::invalid_argument&) {
+    has_thrown = true;
+  }
+  ng::test::Expect(has_thrown, "a colliding name to be rejected");
+  ng::test::Expect(table.GetString(ng::HashName(kName)) == kName,
+                   "the first name to keep its text");
+}
+
+void TestCollidingNodeName() {
+  ng::App app(60);
+  auto scene = std::make_unique<ng::Scene>(&app);
+  ng::Node& first = scene->MakeChild<ng::Node>();
+  ng::Node& second = scene->MakeChild<ng::Node>();
+  first.SetName(kName);
+  second.SetName("Second");
+  app.LoadScene(std::move(scene));
+  app.RunTicks(1);
+
+  bool has_thrown = false;
+  try {
+    second.SetName(kCollidingName);
+  } catch (const std::invalid_argument&) {
+    has_thrown = true;
+  }
+  ng::test::Expect(has_thrown, "a colliding node name to be rejected");
+  ng::test::Expect(second.GetName() == "Second",
+                   "the node to keep its old name");
+  ng::test::Expect(first.GetScene()->FindByName(kName) == &first,
+                   "the name index to only hold the first name");
+}
+
+}  // namespace
+
+int main() {
+  TestIntern();
+  TestCollision();
+  TestCollidingNodeName();
+  return ng::test::GetExitCode();
+}
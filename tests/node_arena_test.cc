@@ -0,0 +1,175 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "engine/app.h"
+#include "engine/node.h"
+#include "engine/scene.h"
+#include "tests/allocation_counter.h"
+#include "tests/test.h"
+
+namespace {
+
+// The number of groups of a level, and of blocks in each group.
+constexpr size_t kGroupCount = 50;
+constexpr size_t kBlocksPerGroup = 20;
+
+/// @brief A node large enough that heap-allocated nodes would dominate the bytes allocated by a restart.
+class Block : public ng::Node {
+ public:
+  explicit Block(ng::App* app) : ng::Node(app) {}
+
+ private:
+  std::array<std::byte, 512> payload_ = {};
+};
+
+/// @brief A node that can make a child and then throw from its constructor.
+class Thrower : public ng::Node {
+ public:
+  // The address of the last Thrower constructed.
+  static inline const void* last_address = nullptr;
+
+  Thrower(ng::App* app, bool should_throw) : ng::Node(app) {
+    last_address = this;
+    MakeChild<Block>();
+    if (should_throw) {
+      throw std::runtime_error("Thrower");
+    }
+  }
+};
+
+/// @brief An over-aligned node that can take a child made before its own constructor runs.
+class alignas(64) Aligned : public ng::Node {
+ public:
+  explicit Aligned(ng::App* app) : ng::Node(app) {}
+
+  Aligned(ng::App* app, std::unique_ptr<ng::Node> child) : ng::Node(app) {
+    AddChild(std::move(child));
+  }
+};
+
+/// @brief Checks that a node sits at the alignment of its type.
+/// @param node The node to check.
+/// @return True if the node is aligned.
+bool IsAligned(const ng::Node& node) {
+  return reinterpret_cast<uintptr_t>(&node) % alignof(Aligned) == 0;
+}
+
+/// @brief Makes a level of kGroupCount groups of kBlocksPerGroup blocks.
+/// @param app The app the level belongs to.
+/// @return The scene of the level.
+std::unique_ptr<ng::Scene> MakeLevel(ng::App* app) {
+  auto scene = std::make_unique<ng::Scene>(app);
+  for (size_t i = 0; i < kGroupCount; ++i) {
+    auto& group = scene->MakeChild<ng::Node>();
+    for (size_t j = 0; j < kBlocksPerGroup; ++j) {
+      group.MakeChild<Block>();
+    }
+  }
+  return scene;
+}
+
+void TestThrowingConstructor(ng::App& app) {
+  auto scene = std::make_unique<ng::Scene>(&app);
+  bool has_thrown = false;
+  try {
+    scene->MakeChild<Thrower>(true);
+  } catch (const std::runtime_error&) {
+    has_thrown = true;
+  }
+  ng::test::Expect(has_thrown, "the exception to reach the caller");
+  const void* thrown_address = Thrower::last_address;
+
+  // The memory of the node that threw is the next one of its size class.
+  scene->MakeChild<Thrower>(false);
+  ng::test::Expect(Thrower::last_address == thrown_address,
+                   "the memory of a throwing node to go back to the arena");
+
+  // A node made outside of any scene must not see the arena of the node that
+  // threw, so its children come from the heap.
+  auto heap_node = std::make_unique<ng::Node>(&app);
+  ng::test::StartCountingAllocations();
+  heap_node->MakeChild<Block>();
+  ng::test::AllocationCount allocations =
+      ng::test::StopCountingAllocations();
+  ng::test::Expect(allocations.bytes >= sizeof(Block),
+                   "a heap node to make its children on the heap");
+}
+
+void TestOverAlignedNodes(ng::App& app) {
+  // A new-expression allocates the outer node before it evaluates the
+  // arguments, so the inner nodes are constructed in between. Each node must
+  // still be freed with its own alignment.
+  ng::test::StartCountingAllocations();
+  std::unique_ptr<Aligned> outer(
+      new Aligned(&app, std::unique_ptr<ng::Node>(new Aligned(
+                            &app, std::make_unique<Block>(&app)))));
+  ng::test::Expect(IsAligned(*outer), "a heap node to be aligned");
+  outer = nullptr;
+  ng::test::AllocationCount allocations =
+      ng::test::StopCountingAllocations();
+  ng::test::Expect(allocations.aligned_count == 2,
+                   "two aligned heap allocations");
+  ng::test::Expect(allocations.aligned_free_count == 2,
+                   "nested heap nodes to be freed with their own alignment");
+
+  // MakeChild allocates over-aligned nodes on the heap, outside of the arena.
+  auto scene = std::make_unique<ng::Scene>(&app);
+  ng::test::StartCountingAllocations();
+  Aligned& child = scene->MakeChild<Aligned>(std::make_unique<Aligned>(&app));
+  ng::test::Expect(IsAligned(child), "a child made by MakeChild to be aligned");
+  scene = nullptr;
+  allocations = ng::test::StopCountingAllocations();
+  ng::test::Expect(allocations.aligned_count == 2,
+                   "MakeChild to allocate over-aligned nodes on the heap");
+  ng::test::Expect(allocations.aligned_free_count == 2,
+                   "children made by MakeChild to be freed with their "
+                   "alignment");
+}
+
+/// @brief Loads a new level while the current one is still alive, like the game does to restart.
+/// @param app The app to load the level in.
+/// @return The allocations made to restart.
+ng::test::AllocationCount Restart(ng::App& app) {
+  ng::test::StartCountingAllocations();
+  app.LoadScene(MakeLevel(&app));
+  app.RunTicks(1);
+  return ng::test::StopCountingAllocations();
+}
+
+void TestRestart(ng::App& app) {
+  app.LoadScene(MakeLevel(&app));
+  app.RunTicks(1);
+  // The first restart allocates the arena of the second scene, since the
+  // first scene is still alive while the new one is made.
+  Restart(app);
+
+  ng::test::AllocationCount first = Restart(app);
+  ng::test::AllocationCount second = Restart(app);
+  size_t node_count = kGroupCount * kBlocksPerGroup;
+  std::printf("%zu allocations (%zu bytes) to restart a level of %zu nodes\n",
+              first.count, first.bytes, node_count);
+
+  // The scene's containers still allocate, but far less than the nodes take.
+  ng::test::Expect(first.bytes < node_count * sizeof(Block),
+                   "the nodes of a restarted level to come from the arena");
+  ng::test::Expect(second.count == first.count,
+                   "every restart to allocate the same");
+
+  app.UnloadScene();
+  app.RunTicks(1);
+}
+
+}  // namespace
+
+int main() {
+  ng::App app(60);
+  TestThrowingConstructor(app);
+  TestOverAlignedNodes(app);
+  TestRestart(app);
+  return ng::test::GetExitCode();
+}
@@ -0,0 +1,122 @@
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "engine/app.h"
+#include "engine/node.h"
+#include "engine/node_handle.h"
+#include "engine/node_slot_table.h"
+#include "engine/scene.h"
+#include "tests/test.h"
+
+namespace {
+
+class Enemy : public ng::Node {
+ public:
+  using ng::Node::Node;
+};
+
+/// @brief Loads a new empty scene and returns it.
+ng::Scene& LoadEmptyScene(ng::App& app) {
+  auto owned = std::make_unique<ng::Scene>(&app);
+  ng::Scene& scene = *owned;
+  app.LoadScene(std::move(owned));
+  app.RunTicks(1);
+  return scene;
+}
+
+void TestSlotTable() {
+  ng::NodeSlotTable slots;
+  ng::App app(60);
+  ng::Node first(&app);
+  ng::Node second(&app);
+
+  uint32_t index = slots.Acquire(&first);
+  uint32_t generation = slots.GetGeneration(index);
+  ng::test::Expect(slots.Find(index, generation) == &first,
+                   "a slot to find its node");
+  slots.Release(index);
+  ng::test::Expect(slots.Find(index, generation) == nullptr,
+                   "a freed slot to find nothing");
+
+  ng::test::Expect(slots.Acquire(&second) == index,
+                   "a freed slot to be reused");
+  ng::test::Expect(slots.GetGeneration(index) == generation + 1,
+                   "a reused slot to have a new generation");
+  ng::test::Expect(slots.Find(index, generation) == nullptr,
+                   "the old generation not to find the new node");
+  ng::test::Expect(slots.Find(index, generation + 1) == &second,
+                   "the new generation to find the new node");
+  slots.Release(index);
+}
+
+void TestDestroyedNode() {
+  ng::App app(60);
+  ng::Scene& scene = LoadEmptyScene(app);
+  ng::test::Expect(ng::NodeHandle<>().Resolve() == nullptr,
+                   "an empty handle to resolve to null");
+
+  auto& enemy = scene.MakeChild<Enemy>();
+  ng::NodeHandle<Enemy> handle(enemy);
+  app.RunTicks(1);
+  ng::test::Expect(handle.Resolve() == &enemy && handle.IsValid(),
+                   "a handle to resolve to its live node");
+
+  enemy.Destroy();
+  ng::test::Expect(handle.Resolve() == &enemy,
+                   "a node scheduled for destruction to still resolve");
+  app.RunTicks(1);
+  ng::test::Expect(handle.Resolve() == nullptr && !handle.IsValid(),
+                   "a handle to a destroyed node to resolve to null");
+
+  // The new node takes the slot, and likely the memory, the old one freed.
+  auto& replacement = scene.MakeChild<Enemy>();
+  ng::NodeHandle<Enemy> replacement_handle(replacement);
+  app.RunTicks(1);
+  ng::test::Expect(handle.Resolve() == nullptr,
+                   "a reused slot not to resolve the new node");
+  ng::test::Expect(replacement_handle.Resolve() == &replacement,
+                   "a handle to the new node to resolve to it");
+
+  app.UnloadScene();
+  app.RunTicks(1);
+}
+
+void TestHandleOutlivesScene() {
+  ng::App app(60);
+  ng::Scene& scene = LoadEmptyScene(app);
+  ng::NodeHandle<> parent_handle(scene.MakeChild<ng::Node>());
+  auto& child = parent_handle.Resolve()->MakeChild<Enemy>();
+  ng::NodeHandle<Enemy> child_handle(child);
+  app.RunTicks(1);
+  ng::test::Expect(parent_handle.IsValid() && child_handle.IsValid(),
+                   "handles to resolve before the scene is unloaded");
+
+  // The slot table lives on the App, so handles can outlive their scene.
+  app.UnloadScene();
+  app.RunTicks(1);
+  ng::test::Expect(!parent_handle.IsValid() && !child_handle.IsValid(),
+                   "handles to the nodes of an unloaded scene to be invalid");
+
+  // The next scene reuses the slots with new generations.
+  ng::Scene& next = LoadEmptyScene(app);
+  auto& next_parent = next.MakeChild<ng::Node>();
+  auto& next_child = next_parent.MakeChild<Enemy>();
+  app.RunTicks(1);
+  ng::test::Expect(!parent_handle.IsValid() && !child_handle.IsValid(),
+                   "old handles not to resolve the nodes of the next scene");
+  ng::test::Expect(ng::NodeHandle<Enemy>(next_child).Resolve() == &next_child,
+                   "handles to the next scene to resolve");
+
+  app.UnloadScene();
+  app.RunTicks(1);
+}
+
+}  // namespace
+
+int main() {
+  TestSlotTable();
+  TestDestroyedNode();
+  TestHandleOutlivesScene();
+  return ng::test::GetExitCode();
+}
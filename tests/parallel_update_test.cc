@@ -0,0 +1,143 @@
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "engine/app.h"
+#include "engine/node.h"
+#include "engine/scene.h"
+#include "engine/thread_pool.h"
+#include "tests/test.h"
+
+// The scene of this test found the races of the parallel update under
+// ThreadSanitizer. Configure with JP_THREAD_SANITIZER to check them again.
+
+namespace {
+
+// The number of independent subtrees, enough for several chunks per thread.
+constexpr size_t kWalkerCount = 200;
+// The number of ticks run before comparing the trees.
+constexpr int kTickCount = 30;
+// The number of children each walker keeps alive.
+constexpr size_t kPartCount = 3;
+
+/// @brief What the walkers share with the rest of the scene, only written under Scene::LockSharedState.
+struct Shared {
+  // The number of walker updates.
+  size_t update_count = 0;
+};
+
+/// @brief A node moved by the serial update. Its child is read by every walker, so its transform must be clean before they run.
+class Platform : public ng::Node {
+ public:
+  explicit Platform(ng::App* app)
+      : ng::Node(app), anchor_(&MakeChild<ng::Node>()) {
+    anchor_->SetLocalPosition({8, 4});
+  }
+
+  [[nodiscard]] const ng::Node& GetAnchor() const { return *anchor_; }
+
+ protected:
+  void Update() override {
+    Translate({1, 0.5F});
+    SetLocalRotation(GetLocalTransform().getRotation() + sf::degrees(3));
+  }
+
+ private:
+  // The child read by the walkers.
+  ng::Node* anchor_ = nullptr;
+};
+
+/// @brief The root of an independent subtree. Follows the anchor of the platform, creates and destroys its children, and counts its updates in the shared state.
+class Walker : public ng::Node {
+ public:
+  Walker(ng::App* app, const Platform* platform, Shared* shared, float offset)
+      : ng::Node(app), platform_(platform), shared_(shared), offset_(offset) {
+    SetParallelUpdate(true);
+  }
+
+  /// @brief Appends the global positions of the walker and its children.
+  void Snapshot(std::vector<sf::Vector2f>& positions) const {
+    positions.push_back(GetGlobalPosition());
+    for (const ng::Node* part : parts_) {
+      positions.push_back(part->GetGlobalPosition());
+    }
+  }
+
+ protected:
+  void Update() override {
+    ++tick_;
+    // Reads a transform outside the subtree, moved by the serial update.
+    sf::Vector2f anchor = platform_->GetAnchor().GetGlobalPosition();
+    SetLocalPosition(anchor + sf::Vector2f(offset_, offset_ * 0.5F));
+    SetLocalRotation(sf::degrees(offset_ + static_cast<float>(tick_)));
+
+    // Nodes made outside of MakeChild still take a slot of the scene.
+    auto scratch = std::make_unique<ng::Node>(GetApp());
+    scratch->SetLocalPosition(anchor);
+
+    ng::Node& part = MakeChild<ng::Node>();
+    part.SetLocalPosition({static_cast<float>(tick_), offset_});
+    parts_.push_back(&part);
+    if (parts_.size() > kPartCount) {
+      parts_.front()->Destroy();
+      parts_.pop_front();
+    }
+
+    auto lock = GetScene()->LockSharedState();
+    ++shared_->update_count;
+  }
+
+ private:
+  const Platform* platform_ = nullptr;
+  Shared* shared_ = nullptr;
+  // Where the walker stands relative to the anchor.
+  float offset_ = 0;
+  int tick_ = 0;
+  // The children alive, from the oldest to the newest.
+  std::deque<ng::Node*> parts_;
+};
+
+/// @brief Runs the scene and returns the global positions of the walkers and their children.
+/// @param app The app to load the scene in.
+/// @param thread_pool The thread pool of the scene, or nullptr to update every node in tree order.
+std::vector<sf::Vector2f> RunScene(ng::App& app, ng::ThreadPool* thread_pool) {
+  Shared shared;
+  auto scene = std::make_unique<ng::Scene>(&app);
+  scene->SetThreadPool(thread_pool);
+  auto& platform = scene->MakeChild<Platform>();
+  std::vector<const Walker*> walkers;
+  for (size_t i = 0; i < kWalkerCount; ++i) {
+    walkers.push_back(&scene->MakeChild<Walker>(&platform, &shared,
+                                                static_cast<float>(i)));
+  }
+  app.LoadScene(std::move(scene));
+  app.RunTicks(kTickCount);
+
+  ng::test::Expect(shared.update_count == kWalkerCount * kTickCount,
+                   "every walker to update once per tick");
+  std::vector<sf::Vector2f> positions;
+  for (const Walker* walker : walkers) {
+    walker->Snapshot(positions);
+  }
+  app.UnloadScene();
+  app.RunTicks(1);
+  return positions;
+}
+
+}  // namespace
+
+int main() {
+  ng::App app(60);
+  std::vector<sf::Vector2f> expected = RunScene(app, nullptr);
+  ng::test::Expect(expected.size() == kWalkerCount * (kPartCount + 1),
+                   "every walker to keep its children");
+  for (size_t thread_count : {1U, 2U, 4U}) {
+    ng::ThreadPool thread_pool(thread_count);
+    ng::test::Expect(RunScene(app, &thread_pool) == expected,
+                     "the same tree whatever the number of threads");
+  }
+  return ng::test::GetExitCode();
+}
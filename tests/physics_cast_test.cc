@@ -0,0 +1,189 @@
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "engine/app.h"
+#include "engine/broadphase.h"
+#include "engine/circle_collider.h"
+#include "engine/collider.h"
+#include "engine/collider_cache.h"
+#include "engine/collision_filter.h"
+#include "engine/dynamic_aabb_tree.h"
+#include "engine/physics.h"
+#include "engine/raycast_hit.h"
+#include "engine/rectangle_collider.h"
+#include "engine/scene.h"
+#include "engine/spatial_grid.h"
+#include "engine/sweep_and_prune.h"
+#include "tests/test.h"
+
+namespace {
+
+// The category of the circle, so that masks can skip the box in front of it.
+constexpr uint32_t kCircleCategory = 2;
+// Far enough to reach every collider of the scene.
+constexpr float kFar = 500;
+
+/// @brief The colliders of the scene the casts are checked against.
+struct Targets {
+  // A 20x20 box centered on (100, 0).
+  const ng::Collider* box = nullptr;
+  // A circle of radius 10 centered on (200, 0), behind the box on the x axis.
+  const ng::Collider* circle = nullptr;
+  // A static 40x20 box centered on (100, 200).
+  const ng::Collider* ground = nullptr;
+  // A circle of radius 5 centered on (200, -50), above the circle.
+  const ng::Collider* mover = nullptr;
+};
+
+bool IsNear(float a, float b) { return std::abs(a - b) < 1e-3F; }
+
+bool IsNear(sf::Vector2f a, sf::Vector2f b) {
+  return IsNear(a.x, b.x) && IsNear(a.y, b.y);
+}
+
+/// @brief Checks the collider, distance, and normal of a hit.
+void ExpectHit(const std::optional<ng::RaycastHit>& hit,
+               const ng::Collider* collider, float distance,
+               sf::Vector2f normal, std::string_view message) {
+  ng::test::Expect(hit.has_value(), message);
+  if (!hit) {
+    return;
+  }
+  ng::test::Expect(hit->collider == collider, message);
+  ng::test::Expect(IsNear(hit->distance, distance), message);
+  ng::test::Expect(IsNear(hit->normal, normal), message);
+}
+
+void TestRaycast(const ng::Physics& physics, const Targets& targets) {
+  ExpectHit(physics.Raycast({0, 0}, {1, 0}, kFar), targets.box, 90, {-1, 0},
+            "a ray to hit the side of a box");
+  ExpectHit(physics.Raycast({100, -100}, {0, 1}, kFar), targets.box, 90,
+            {0, -1}, "a ray to hit the top of a box");
+  ExpectHit(physics.Raycast({200, 100}, {0, -1}, kFar), targets.circle, 90,
+            {0, 1}, "a ray to hit the bottom of a circle");
+  // The direction does not need to be normalized.
+  sf::Vector2f diagonal = sf::Vector2f(1, 1).normalized();
+  ExpectHit(physics.Raycast({100, -100}, {3, 3}, kFar), targets.circle,
+            (100 * std::sqrt(2.F)) - 10, -diagonal,
+            "a diagonal ray to hit a circle");
+  ExpectHit(physics.Raycast({100, 50}, {0, 1}, kFar), targets.ground, 140,
+            {0, -1}, "a ray to hit a static box");
+  ExpectHit(physics.Raycast({100, 0}, {1, 0}, kFar), targets.box, 0, {-1, 0},
+            "a ray starting inside a box to hit it at once");
+  ExpectHit(physics.Raycast({0, 0}, {1, 0}, kFar, kCircleCategory),
+            targets.circle, 190, {-1, 0}, "a ray to skip masked colliders");
+
+  ng::test::Expect(!physics.Raycast({0, 0}, {1, 0}, 89), "a short ray to miss");
+  ng::test::Expect(!physics.Raycast({0, 0}, {-1, 0}, kFar),
+                   "a ray pointing away to miss");
+  ng::test::Expect(!physics.Raycast({0, 11}, {1, 0}, kFar),
+                   "a ray passing below the box and the circle to miss");
+}
+
+void TestRaycastAll(const ng::Physics& physics, const Targets& targets) {
+  std::vector<ng::RaycastHit> hits = physics.RaycastAll({0, 0}, {1, 0}, kFar);
+  ng::test::Expect(hits.size() == 2, "a ray to pass through every collider");
+  if (hits.size() == 2) {
+    ExpectHit(hits[0], targets.box, 90, {-1, 0}, "the closest hit first");
+    ExpectHit(hits[1], targets.circle, 190, {-1, 0}, "the farthest hit last");
+  }
+
+  hits = physics.RaycastAll({0, 0}, {1, 0}, 150);
+  ng::test::Expect(hits.size() == 1 && hits[0].collider == targets.box,
+                   "a ray to stop at its length");
+  ng::test::Expect(physics.RaycastAll({0, 0}, {-1, 0}, kFar).empty(),
+                   "a ray pointing away to hit nothing");
+}
+
+void TestShapeCast(const ng::Physics& physics, const Targets& targets) {
+  // A circle of radius 5 and an 8x8 box, both centered on the origin.
+  sf::FloatRect circle({-5, -5}, {10, 10});
+  sf::FloatRect box({-4, -4}, {8, 8});
+
+  ExpectHit(physics.ShapeCast(ng::ColliderShape::kCircle, circle, {1, 0}, kFar),
+            targets.box, 85, {-1, 0}, "a circle cast to hit a box");
+  ExpectHit(physics.ShapeCast(ng::ColliderShape::kCircle,
+                              {{195, 95}, {10, 10}}, {0, -1}, kFar),
+            targets.circle, 85, {0, 1}, "a circle cast to hit a circle");
+  ExpectHit(physics.ShapeCast(ng::ColliderShape::kRectangle, box, {1, 0}, kFar),
+            targets.box, 86, {-1, 0}, "a rect cast to hit a box");
+  ExpectHit(physics.ShapeCast(ng::ColliderShape::kRectangle,
+                              {{196, 96}, {8, 8}}, {0, -1}, kFar),
+            targets.circle, 86, {0, 1}, "a rect cast to hit a circle");
+  ExpectHit(physics.ShapeCast(ng::ColliderShape::kRectangle,
+                              {{96, 46}, {8, 8}}, {0, 1}, kFar),
+            targets.ground, 136, {0, -1}, "a rect cast to hit a static box");
+  // The top of the cast box slides along the bottom of the target box.
+  ExpectHit(physics.ShapeCast(ng::ColliderShape::kRectangle,
+                              {{-4, 10}, {8, 8}}, {1, 0}, kFar),
+            targets.box, 86, {-1, 0}, "a rect cast to hit a box at its edge");
+  ng::test::Expect(!physics.ShapeCast(ng::ColliderShape::kRectangle,
+                                      {{-4, 12}, {8, 8}}, {1, 0}, kFar),
+                   "a rect cast passing below the box and the circle to miss");
+  ng::test::Expect(!physics.ShapeCast(ng::ColliderShape::kCircle, circle,
+                                      {1, 0}, 84),
+                   "a short circle cast to miss");
+  ExpectHit(physics.ShapeCast(ng::ColliderShape::kCircle, circle, {1, 0}, kFar,
+                              kCircleCategory),
+            targets.circle, 185, {-1, 0},
+            "a circle cast to skip masked colliders");
+
+  // A collider casting its own shape ignores itself.
+  ExpectHit(physics.ShapeCast(*targets.mover, {0, 1}, kFar), targets.circle, 35,
+            {0, -1}, "a collider to cast its shape");
+  ng::test::Expect(!physics.ShapeCast(*targets.mover, {0, -1}, kFar),
+                   "a collider casting its shape away to miss");
+}
+
+void TestCasts(ng::App& app, std::unique_ptr<ng::Broadphase> broadphase) {
+  auto scene = std::make_unique<ng::Scene>(&app);
+  scene->GetMutablePhysics().SetBroadphase(std::move(broadphase));
+  Targets targets;
+
+  auto& box = scene->MakeChild<ng::RectangleCollider>(sf::Vector2f(20, 20));
+  box.SetLocalPosition({100, 0});
+  targets.box = &box;
+
+  auto& circle = scene->MakeChild<ng::CircleCollider>(10.F);
+  circle.SetLocalPosition({200, 0});
+  circle.SetCollisionFilter({.category = kCircleCategory});
+  targets.circle = &circle;
+
+  auto& ground = scene->MakeChild<ng::RectangleCollider>(sf::Vector2f(40, 20));
+  ground.SetLocalPosition({100, 200});
+  ground.SetStatic(true);
+  targets.ground = &ground;
+
+  auto& mover = scene->MakeChild<ng::CircleCollider>(5.F);
+  mover.SetLocalPosition({200, -50});
+  targets.mover = &mover;
+
+  ng::Scene* loaded = scene.get();
+  app.LoadScene(std::move(scene));
+  app.RunTicks(1);
+
+  const ng::Physics& physics = loaded->GetPhysics();
+  TestRaycast(physics, targets);
+  TestRaycastAll(physics, targets);
+  TestShapeCast(physics, targets);
+
+  app.UnloadScene();
+  app.RunTicks(1);
+}
+
+}  // namespace
+
+int main() {
+  ng::App app(60);
+  TestCasts(app, nullptr);
+  TestCasts(app, std::make_unique<ng::SpatialGrid>(sf::Vector2f(32, 32)));
+  TestCasts(app, std::make_unique<ng::DynamicAabbTree>());
+  TestCasts(app, std::make_unique<ng::SweepAndPrune>());
+  return ng::test::GetExitCode();
+}
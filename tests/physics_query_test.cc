@@ -0,0 +1,242 @@
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "engine/app.h"
+#include "engine/broadphase.h"
+#include "engine/collider.h"
+#include "engine/dynamic_aabb_tree.h"
+#include "engine/node.h"
+#include "engine/physics.h"
+#include "engine/rectangle_collider.h"
+#include "engine/scene.h"
+#include "engine/spatial_grid.h"
+#include "engine/sweep_and_prune.h"
+#include "tests/allocation_counter.h"
+#include "tests/test.h"
+
+namespace {
+
+// The boxes sit on a kGridSize x kGridSize grid, kSpacing apart.
+constexpr size_t kGridSize = 10;
+constexpr float kSpacing = 20;
+// The size of each box, smaller than the spacing so boxes do not touch.
+constexpr float kBoxSize = 16;
+// A rectangle covering the boxes of the first 3x3 cells of the grid.
+constexpr sf::FloatRect kNineBoxes({0, 0}, {50, 50});
+// The number of ticks run before counting, so every buffer reused across
+// ticks has reached its steady-state capacity.
+constexpr uint32_t kWarmUpTicks = 120;
+// The number of ticks whose allocations are counted.
+constexpr uint32_t kMeasuredTicks = 300;
+// The number of ticks a prober takes to sweep back and forth once.
+constexpr uint32_t kSweepTicks = 40;
+
+/// @brief A node with a large collider that runs every allocation-free query each tick, one of them nested in the visitor of another, while sweeping across the grid.
+class Prober : public ng::Node {
+ public:
+  explicit Prober(ng::App* app)
+      : ng::Node(app),
+        collider_(&MakeChild<ng::RectangleCollider>(sf::Vector2f(48, 48))) {}
+
+  // The number of colliders found by the last tick, to keep the queries from
+  // being optimized away.
+  size_t hit_count = 0;
+
+ protected:
+  void Update() override {
+    tick_ = (tick_ + 1) % kSweepTicks;
+    float offset = static_cast<float>(tick_ < kSweepTicks / 2
+                                          ? tick_
+                                          : kSweepTicks - tick_);
+    SetLocalPosition({offset * 4, offset * 4});
+
+    const ng::Physics& physics = GetScene()->GetPhysics();
+    hit_count = physics.Overlap(*collider_, hits_);
+    hit_count += physics.OverlapPoint(collider_->GetCenter(), hits_);
+    physics.Overlap(*collider_, [this, &physics](const ng::Collider& other) {
+      hit_count += physics.OverlapRect(other.GetBounds(), hits_);
+      return true;
+    });
+  }
+
+ private:
+  // The collider the queries are made with.
+  ng::Collider* collider_ = nullptr;
+  // The buffer the span queries write to.
+  std::array<const ng::Collider*, 16> hits_ = {};
+  // The position of the prober in its sweep.
+  uint32_t tick_ = 0;
+};
+
+/// @brief Makes a scene with a grid of boxes.
+/// @param app The app the scene belongs to.
+/// @param broadphase The broadphase of the scene, or nullptr to test every collider.
+/// @return The scene.
+std::unique_ptr<ng::Scene> MakeGrid(
+    ng::App& app, std::unique_ptr<ng::Broadphase> broadphase) {
+  auto scene = std::make_unique<ng::Scene>(&app);
+  scene->GetMutablePhysics().SetBroadphase(std::move(broadphase));
+  for (size_t y = 0; y < kGridSize; ++y) {
+    for (size_t x = 0; x < kGridSize; ++x) {
+      auto& box = scene->MakeChild<ng::RectangleCollider>(
+          sf::Vector2f(kBoxSize, kBoxSize));
+      // Colliders are centered on their position.
+      box.SetLocalPosition({(static_cast<float>(x) * kSpacing) + (kBoxSize / 2),
+                            (static_cast<float>(y) * kSpacing) +
+                                (kBoxSize / 2)});
+    }
+  }
+  return scene;
+}
+
+/// @brief Checks that every collider of a span is in a list, and that no collider appears twice.
+bool IsSubsetOf(std::span<const ng::Collider* const> hits,
+                const std::vector<const ng::Collider*>& all) {
+  std::vector<const ng::Collider*> sorted(hits.begin(), hits.end());
+  std::ranges::sort(sorted);
+  return std::ranges::adjacent_find(sorted) == sorted.end() &&
+         std::ranges::all_of(sorted, [&all](const ng::Collider* hit) {
+           return std::ranges::find(all, hit) != all.end();
+         });
+}
+
+void TestSpans(const ng::Physics& physics, const ng::Collider& probe) {
+  std::vector<const ng::Collider*> all = physics.OverlapRect(kNineBoxes);
+  ng::test::Expect(all.size() == 9, "a rectangle to cover nine boxes");
+
+  // The query stops once the span is full and leaves the rest untouched.
+  std::array<const ng::Collider*, 5> hits = {};
+  hits.back() = &probe;
+  size_t count = physics.OverlapRect(kNineBoxes, std::span(hits).first(4));
+  ng::test::Expect(count == 4, "a full span to stop the query");
+  ng::test::Expect(IsSubsetOf(std::span(hits).first(4), all),
+                   "a full span to hold distinct hits of the query");
+  ng::test::Expect(hits.back() == &probe,
+                   "the query to write nothing past the span");
+
+  std::array<const ng::Collider*, 16> large = {};
+  count = physics.OverlapRect(kNineBoxes, large);
+  ng::test::Expect(count == all.size(), "a large span to hold every hit");
+  ng::test::Expect(IsSubsetOf(std::span(large).first(count), all),
+                   "a large span to hold the hits of the query");
+  ng::test::Expect(physics.OverlapRect(kNineBoxes,
+                                       std::span<const ng::Collider*>()) == 0,
+                   "an empty span to find nothing");
+
+  // The probe covers the corners of four boxes.
+  std::vector<const ng::Collider*> around = physics.Overlap(probe);
+  ng::test::Expect(around.size() == 4, "a collider to overlap four boxes");
+  count = physics.Overlap(probe, std::span(hits).first(2));
+  ng::test::Expect(count == 2, "a full span to stop a collider query");
+  ng::test::Expect(IsSubsetOf(std::span(hits).first(2), around),
+                   "a collider query to write its hits");
+  count = physics.Overlap(probe, large);
+  ng::test::Expect(count == around.size() &&
+                       IsSubsetOf(std::span(large).first(count), around),
+                   "a large span to hold every hit of a collider query");
+
+  count = physics.OverlapPoint({8, 8}, large);
+  ng::test::Expect(count == 1 && large[0]->GetBounds().contains({8, 8}),
+                   "a point query to write the box containing the point");
+  ng::test::Expect(physics.OverlapPoint({18, 18}, large) == 0,
+                   "a point between boxes to find nothing");
+}
+
+void TestVisitors(const ng::Physics& physics, const ng::Collider& probe) {
+  size_t call_count = 0;
+  auto stop_after_three = [&call_count](const ng::Collider& /*other*/) {
+    return ++call_count < 3;
+  };
+  ng::test::Expect(!physics.OverlapRect(kNineBoxes, stop_after_three),
+                   "a stopped query to return false");
+  ng::test::Expect(call_count == 3, "a query to stop once the visitor says so");
+
+  call_count = 0;
+  auto visit_all = [&call_count](const ng::Collider& /*other*/) {
+    ++call_count;
+    return true;
+  };
+  ng::test::Expect(physics.OverlapRect(kNineBoxes, visit_all),
+                   "a completed query to return true");
+  ng::test::Expect(call_count == 9, "a query to visit every hit");
+
+  call_count = 0;
+  ng::test::Expect(!physics.Overlap(probe, stop_after_three) && call_count == 3,
+                   "a collider query to stop once the visitor says so");
+  call_count = 0;
+  ng::test::Expect(physics.OverlapPoint({8, 8}, visit_all) && call_count == 1,
+                   "a point query to visit the box containing the point");
+}
+
+void TestNestedQueries(const ng::Physics& physics) {
+  std::vector<const ng::Collider*> all = physics.OverlapRect(kNineBoxes);
+  std::vector<const ng::Collider*> visited;
+  bool are_inner_hits_right = true;
+  physics.OverlapRect(kNineBoxes, [&](const ng::Collider& other) {
+    visited.push_back(&other);
+    // The inner query must neither see nor clobber the state of the outer one.
+    std::array<const ng::Collider*, 4> inner = {};
+    size_t count = physics.OverlapPoint(other.GetCenter(), inner);
+    are_inner_hits_right =
+        are_inner_hits_right && count == 1 && inner[0] == &other;
+    return true;
+  });
+  ng::test::Expect(are_inner_hits_right,
+                   "a query nested in a visitor to find its own hits");
+  ng::test::Expect(visited.size() == all.size() && IsSubsetOf(visited, all),
+                   "a nested query to leave the outer query intact");
+}
+
+void TestSteadyStateAllocations(ng::App& app, ng::Scene& scene) {
+  for (size_t i = 0; i < 8; ++i) {
+    scene.MakeChild<Prober>();
+  }
+  app.RunTicks(kWarmUpTicks);
+
+  ng::test::StartCountingAllocations();
+  app.RunTicks(kMeasuredTicks);
+  ng::test::AllocationCount ticks = ng::test::StopCountingAllocations();
+  std::printf("%zu allocations in %u ticks of queries\n", ticks.count,
+              kMeasuredTicks);
+  ng::test::Expect(ticks.count == 0,
+                   "no heap allocation by queries after the warm-up");
+}
+
+void TestQueries(ng::App& app, std::unique_ptr<ng::Broadphase> broadphase) {
+  auto scene = MakeGrid(app, std::move(broadphase));
+  auto& probe = scene->MakeChild<ng::RectangleCollider>(sf::Vector2f(8, 8));
+  // Between four boxes outside of kNineBoxes, touching each of their corners.
+  probe.SetLocalPosition({(4 * kSpacing) - 2, (4 * kSpacing) - 2});
+  ng::Scene* loaded = scene.get();
+  app.LoadScene(std::move(scene));
+  app.RunTicks(1);
+
+  const ng::Physics& physics = loaded->GetPhysics();
+  TestSpans(physics, probe);
+  TestVisitors(physics, probe);
+  TestNestedQueries(physics);
+  TestSteadyStateAllocations(app, *loaded);
+
+  app.UnloadScene();
+  app.RunTicks(1);
+}
+
+}  // namespace
+
+int main() {
+  ng::App app(60);
+  TestQueries(app, nullptr);
+  TestQueries(app, std::make_unique<ng::SpatialGrid>(sf::Vector2f(32, 32)));
+  TestQueries(app, std::make_unique<ng::DynamicAabbTree>());
+  TestQueries(app, std::make_unique<ng::SweepAndPrune>());
+  return ng::test::GetExitCode();
+}
@@ -0,0 +1,201 @@
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "engine/app.h"
+#include "engine/broadphase.h"
+#include "engine/collider.h"
+#include "engine/dynamic_aabb_tree.h"
+#include "engine/node.h"
+#include "engine/physics.h"
+#include "engine/rectangle_collider.h"
+#include "engine/scene.h"
+#include "engine/spatial_grid.h"
+#include "engine/sweep_and_prune.h"
+#include "tests/test.h"
+
+namespace {
+
+// The number of bodies overlapping the hub.
+constexpr size_t kBodyCount = 50;
+
+/// @brief A node with a square collider that counts its collision callbacks.
+class Recorder : public ng::Node {
+ public:
+  explicit Recorder(ng::App* app)
+      : ng::Node(app),
+        collider(&MakeChild<ng::RectangleCollider>(sf::Vector2f(16, 16))) {}
+
+  ng::Collider* collider = nullptr;
+
+  size_t enter_count = 0;
+  size_t stay_count = 0;
+  size_t exit_count = 0;
+
+  void ResetCounts() {
+    enter_count = 0;
+    stay_count = 0;
+    exit_count = 0;
+  }
+
+ protected:
+  void OnCollisionEnter(const ng::Collider& /*collider*/,
+                        const ng::Collider& /*other*/) override {
+    ++enter_count;
+  }
+
+  void OnCollisionStay(const ng::Collider& /*collider*/,
+                       const ng::Collider& /*other*/) override {
+    ++stay_count;
+  }
+
+  void OnCollisionExit(const ng::Collider& /*collider*/,
+                       const ng::Collider& /*other*/) override {
+    ++exit_count;
+  }
+};
+
+/// @brief Runs a tick and checks the callbacks the hub received.
+void ExpectHubCallbacks(ng::App& app, Recorder& hub, size_t enter_count,
+                        size_t stay_count, size_t exit_count) {
+  hub.ResetCounts();
+  app.RunTicks(1);
+  ng::test::Expect(hub.enter_count == enter_count, "the enter callbacks");
+  ng::test::Expect(hub.stay_count == stay_count, "the stay callbacks");
+  ng::test::Expect(hub.exit_count == exit_count, "the exit callbacks");
+}
+
+void TestDestroyWhileColliding(ng::App& app,
+                               std::unique_ptr<ng::Broadphase> broadphase) {
+  auto scene = std::make_unique<ng::Scene>(&app);
+  scene->GetMutablePhysics().SetBroadphase(std::move(broadphase));
+  Recorder& hub = scene->MakeChild<Recorder>();
+  // The bodies sit in a row across the hub, each overlapping it.
+  std::vector<Recorder*> bodies;
+  for (size_t i = 0; i < kBodyCount; ++i) {
+    bodies.push_back(&scene->MakeChild<Recorder>());
+    bodies.back()->SetLocalPosition({0, static_cast<float>(i) * 0.25F});
+  }
+  app.LoadScene(std::move(scene));
+
+  ExpectHubCallbacks(app, hub, kBodyCount, 0, 0);
+  ExpectHubCallbacks(app, hub, 0, kBodyCount, 0);
+
+  // Destroyed colliders are forgotten without notifying anyone, and the
+  // collisions of the others go on.
+  for (size_t i = 0; i < kBodyCount; i += 2) {
+    bodies[i]->Destroy();
+  }
+  ExpectHubCallbacks(app, hub, 0, kBodyCount / 2, 0);
+  ExpectHubCallbacks(app, hub, 0, kBodyCount / 2, 0);
+
+  // Bodies made in the place of the destroyed ones collide anew.
+  for (size_t i = 0; i < kBodyCount; i += 2) {
+    hub.GetScene()->MakeChild<Recorder>();
+  }
+  ExpectHubCallbacks(app, hub, kBodyCount / 2, kBodyCount / 2, 0);
+
+  bodies[1]->SetLocalPosition({1000, 0});
+  ExpectHubCallbacks(app, hub, 0, kBodyCount - 1, 1);
+
+  app.UnloadScene();
+  app.RunTicks(1);
+}
+
+/// @brief Runs ticks until a collider falls asleep, checking that the collisions it had go on.
+void RunUntilAsleep(ng::App& app, Recorder& hub, size_t stay_count) {
+  for (uint32_t tick = 0; tick <= ng::Physics::kTicksBeforeSleep; ++tick) {
+    ExpectHubCallbacks(app, hub, 0, stay_count, 0);
+  }
+  ng::test::Expect(
+      hub.GetScene()->GetPhysics().IsAsleep(*hub.collider),
+      "a collider to fall asleep after staying still");
+}
+
+void TestSleep(ng::App& app, std::unique_ptr<ng::Broadphase> broadphase) {
+  auto scene = std::make_unique<ng::Scene>(&app);
+  scene->GetMutablePhysics().SetBroadphase(std::move(broadphase));
+  Recorder& hub = scene->MakeChild<Recorder>();
+  Recorder& body = scene->MakeChild<Recorder>();
+  body.SetLocalPosition({8, 0});
+  Recorder& wall = scene->MakeChild<Recorder>();
+  wall.collider->SetStatic(true);
+  wall.SetLocalPosition({500, 0});
+  Recorder& sleeper = scene->MakeChild<Recorder>();
+  sleeper.SetLocalPosition({1000, 1000});
+  ng::Scene* loaded = scene.get();
+  app.LoadScene(std::move(scene));
+  const ng::Physics& physics = loaded->GetPhysics();
+
+  // A pair of sleeping colliders keeps colliding.
+  ExpectHubCallbacks(app, hub, 1, 0, 0);
+  RunUntilAsleep(app, hub, 1);
+  ng::test::Expect(physics.IsAsleep(*body.collider),
+                   "both colliders of a pair to fall asleep");
+
+  // Moving one of them wakes it up and ends the collision.
+  body.SetLocalPosition({100, 0});
+  ng::test::Expect(!physics.IsAsleep(*body.collider),
+                   "a moved collider to wake up");
+  ExpectHubCallbacks(app, hub, 0, 0, 1);
+  body.SetLocalPosition({8, 0});
+  ExpectHubCallbacks(app, hub, 1, 0, 0);
+  RunUntilAsleep(app, hub, 1);
+
+  // A filter that no longer allows the pair ends the collision.
+  body.collider->SetCollisionFilter({.category = 2, .mask = 2});
+  ExpectHubCallbacks(app, hub, 0, 0, 1);
+  body.collider->SetCollisionFilter({});
+  ExpectHubCallbacks(app, hub, 1, 0, 0);
+  RunUntilAsleep(app, hub, 1);
+
+  // A static collider moved over sleeping ones collides with them.
+  wall.SetLocalPosition({4, 0});
+  wall.ResetCounts();
+  body.ResetCounts();
+  ExpectHubCallbacks(app, hub, 1, 1, 0);
+  ng::test::Expect(wall.enter_count == 2 && body.enter_count == 1,
+                   "a moved static collider to collide with sleeping ones");
+  ng::test::Expect(physics.IsAsleep(*sleeper.collider),
+                   "a moved static collider to leave far colliders asleep");
+  RunUntilAsleep(app, hub, 2);
+
+  // Moving it away wakes the sleeping colliders it left.
+  wall.SetLocalPosition({500, 0});
+  body.ResetCounts();
+  ExpectHubCallbacks(app, hub, 0, 1, 1);
+  ng::test::Expect(body.exit_count == 1,
+                   "a static collider moved away to end its collisions");
+  ng::test::Expect(physics.IsAsleep(*sleeper.collider),
+                   "moving a static collider away to leave far ones asleep");
+
+  // A static collider whose filter changes wakes the colliders it touches.
+  wall.SetLocalPosition({4, 0});
+  ExpectHubCallbacks(app, hub, 1, 1, 0);
+  RunUntilAsleep(app, hub, 2);
+  wall.collider->SetCollisionFilter({.category = 2, .mask = 2});
+  ExpectHubCallbacks(app, hub, 0, 1, 1);
+  ng::test::Expect(physics.IsAsleep(*sleeper.collider),
+                   "a static filter change to leave far colliders asleep");
+
+  app.UnloadScene();
+  app.RunTicks(1);
+}
+
+}  // namespace
+
+int main() {
+  ng::App app(60);
+  TestDestroyWhileColliding(app, nullptr);
+  TestDestroyWhileColliding(
+      app, std::make_unique<ng::SpatialGrid>(sf::Vector2f(32, 32)));
+  TestDestroyWhileColliding(app, std::make_unique<ng::DynamicAabbTree>());
+  TestDestroyWhileColliding(app, std::make_unique<ng::SweepAndPrune>());
+  TestSleep(app, nullptr);
+  TestSleep(app, std::make_unique<ng::SpatialGrid>(sf::Vector2f(32, 32)));
+  TestSleep(app, std::make_unique<ng::DynamicAabbTree>());
+  TestSleep(app, std::make_unique<ng::SweepAndPrune>());
+  return ng::test::GetExitCode();
+}
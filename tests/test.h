@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdio>
+#include <source_location>
+#include <string_view>
+
+namespace ng::test {
+
+/// @brief Gets the number of failed expectations of the running test.
+/// @return The number of failed expectations.
+inline int& GetFailureCount() {
+  static int failure_count = 0;
+  return failure_count;
+}
+
+/// @brief Reports a failed expectation with its location, without stopping the test.
+/// @param condition The condition that must hold.
+/// @param message What the condition checks.
+/// @param location The location of the expectation.
+inline void Expect(
+    bool condition, std::string_view message,
+    std::source_location location = std::source_location::current()) {
+  if (condition) {
+    return;
+  }
+
+  ++GetFailureCount();
+  std::fprintf(stderr, "%s:%u: expected %.*s\n", location.file_name(),
+               location.line(), static_cast<int>(message.size()),
+               message.data());
+}
+
+/// @brief Gets the exit code of the running test.
+/// @return 0 if every expectation held, 1 otherwise.
+inline int GetExitCode() {
+  return GetFailureCount() == 0 ? 0 : 1;
+}
+
+}  // namespace ng::test
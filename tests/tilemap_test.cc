@@ -0,0 +1,208 @@
+#include "engine/tilemap.h"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#include "engine/app.h"
+#include "engine/scene.h"
+#include "engine/tile.h"
+#include "engine/tileset.h"
+#include "tests/test.h"
+
+// The tiles of the test. The engine leaves TileID to be defined by the game.
+enum class TileID : uint64_t {
+  kEmpty = 0,
+  kWall = 1,
+};
+
+namespace {
+
+constexpr uint32_t kSolid = 1;
+constexpr uint32_t kWater = 2;
+// The size of the tiles, and where the tilemap sits in the world.
+constexpr float kTileSize = 16;
+const sf::Vector2f kOrigin(32, 48);
+// The size of the boxes moved through the tilemap.
+const sf::Vector2f kBoxSize(12, 12);
+
+// A 10x8 tilemap. Row 6 is the ground, with a wall standing on it and an
+// overhang above the right side. Row 7 is empty, below the ground.
+constexpr std::array<std::string_view, 8> kRows = {
+    "..........",  //
+    "..........",  //
+    ".....#..#.",  //
+    ".....#....",  //
+    ".....#....",  //
+    ".....#....",  //
+    "##########",  //
+    "..........",  //
+};
+
+/// @brief Moves a box through the tilemap.
+/// @param tilemap The tilemap.
+/// @param position The top-left corner of the box, relative to the tilemap.
+/// @param velocity The motion of the box.
+/// @return The result, with the position relative to the tilemap.
+ng::TileMoveResult Move(const ng::Tilemap& tilemap, sf::Vector2f position,
+                        sf::Vector2f velocity) {
+  ng::TileMoveResult result = tilemap.MoveAndCollide(
+      {kOrigin + position, kBoxSize}, velocity, kSolid);
+  result.position -= kOrigin;
+  return result;
+}
+
+// The contacts expected from a move.
+struct Contacts {
+  bool is_on_ground = false;
+  bool hit_ceiling = false;
+  bool hit_left_wall = false;
+  bool hit_right_wall = false;
+  bool is_out_of_bounds = false;
+};
+
+/// @brief Checks that a move ends at a position, with no contact other than the expected ones.
+void ExpectMove(const ng::TileMoveResult& result, sf::Vector2f position,
+                const Contacts& contacts, std::string_view message) {
+  ng::test::Expect(result.position == position, message);
+  ng::test::Expect(result.is_on_ground == contacts.is_on_ground &&
+                       result.hit_ceiling == contacts.hit_ceiling &&
+                       result.hit_left_wall == contacts.hit_left_wall &&
+                       result.hit_right_wall == contacts.hit_right_wall &&
+                       result.is_out_of_bounds == contacts.is_out_of_bounds,
+                   message);
+}
+
+void TestLanding(const ng::Tilemap& tilemap) {
+  ExpectMove(Move(tilemap, {8, 60}, {0, 30}), {8, 84}, {.is_on_ground = true},
+             "a falling box to land flush on the ground");
+  ExpectMove(Move(tilemap, {8, 80}, {0, 4}), {8, 84}, {.is_on_ground = true},
+             "a box falling exactly onto the ground to land");
+  ExpectMove(Move(tilemap, {8, 84}, {0, 0.5F}), {8, 84},
+             {.is_on_ground = true}, "a resting box to stay on the ground");
+  ExpectMove(Move(tilemap, {130, 60}, {0, -30}), {130, 48},
+             {.hit_ceiling = true}, "a rising box to stop under the ceiling");
+}
+
+void TestNoTunnelling(const ng::Tilemap& tilemap) {
+  ExpectMove(Move(tilemap, {8, 68}, {200, 0}), {68, 68},
+             {.hit_right_wall = true},
+             "a fast box to stop at a one tile wall on its right");
+  ExpectMove(Move(tilemap, {120, 68}, {-200, 0}), {96, 68},
+             {.hit_left_wall = true},
+             "a fast box to stop at a one tile wall on its left");
+  ExpectMove(Move(tilemap, {8, 0}, {0, 500}), {8, 84}, {.is_on_ground = true},
+             "a fast falling box to stop on the ground");
+}
+
+void TestStartFlush(const ng::Tilemap& tilemap) {
+  ExpectMove(Move(tilemap, {68, 68}, {3, 0}), {68, 68},
+             {.hit_right_wall = true},
+             "a box flush against a wall not to move into it");
+  ExpectMove(Move(tilemap, {68, 68}, {-3, 0}), {65, 68}, {},
+             "a box flush against a wall to move away from it");
+  ExpectMove(Move(tilemap, {96, 68}, {-3, 0}), {96, 68},
+             {.hit_left_wall = true},
+             "a box flush against a wall on its left not to move into it");
+}
+
+void TestOutOfBounds(const ng::Tilemap& tilemap) {
+  ExpectMove(Move(tilemap, {2, 20}, {-5, 3}), {2, 20},
+             {.is_out_of_bounds = true}, "leaving through the left side");
+  ExpectMove(Move(tilemap, {146, 20}, {5, 3}), {146, 20},
+             {.is_out_of_bounds = true}, "leaving through the right side");
+  ExpectMove(Move(tilemap, {20, 2}, {0, -5}), {20, 2},
+             {.is_out_of_bounds = true}, "leaving through the top side");
+  ExpectMove(Move(tilemap, {20, 114}, {0, 5}), {20, 114},
+             {.is_out_of_bounds = true}, "leaving through the bottom side");
+  // The horizontal pass stops at the border, the vertical one is skipped.
+  ExpectMove(Move(tilemap, {148, 20}, {0, 5}), {148, 25}, {},
+             "a box touching the border to move along it");
+}
+
+void TestSingleAxis(const ng::Tilemap& tilemap) {
+  ExpectMove(Move(tilemap, {8, 20}, {5, 0}), {13, 20}, {},
+             "a horizontal move to leave the vertical position alone");
+  ExpectMove(Move(tilemap, {8, 20}, {0, -5}), {8, 15}, {},
+             "a vertical move to leave the horizontal position alone");
+  ExpectMove(Move(tilemap, {8, 84}, {5, 0}), {13, 84}, {},
+             "a box walking on the ground not to report it");
+  ExpectMove(Move(tilemap, {8, 20}, {0, 0}), {8, 20}, {},
+             "a box without velocity not to move");
+}
+
+void TestStartInsideSolid(const ng::Tilemap& tilemap) {
+  // The box overlaps the wall, whose tiles it already is in cannot stop it.
+  ExpectMove(Move(tilemap, {75, 68}, {2, 0}), {77, 68}, {},
+             "a box overlapping a wall to move out of it to the right");
+  ExpectMove(Move(tilemap, {75, 68}, {-2, 0}), {73, 68}, {},
+             "a box overlapping a wall to move out of it to the left");
+  ExpectMove(Move(tilemap, {82, 68}, {-20, 0}), {62, 68}, {},
+             "a box inside a wall to move out of it");
+  // A box sunk into the ground is never pushed back up while falling.
+  ExpectMove(Move(tilemap, {8, 90}, {0, 1}), {8, 91}, {},
+             "a box sunk into the ground not to move against its velocity");
+}
+
+void TestDefaultFlags(ng::App& app) {
+  // Unset cells hold TileID::kEmpty, so they have the flags of its tile.
+  ng::Tileset tileset(sf::Vector2u(16, 16));
+  tileset.AddTile(ng::Tile(TileID::kEmpty, kWater));
+  tileset.AddTile(ng::Tile(TileID::kWall, kSolid));
+  ng::Tilemap tilemap(&app, {3, 2}, std::move(tileset));
+  ng::test::Expect(tilemap.GetTileFlags({2, 1}) == kWater &&
+                       tilemap.GetTile({2, 1}).GetFlags() == kWater,
+                   "unset cells to have the flags of the default tile");
+  tilemap.SetTile({2, 1}, TileID::kWall);
+  ng::test::Expect(tilemap.GetTileFlags({2, 1}) == kSolid &&
+                       tilemap.GetTileFlags({1, 1}) == kWater,
+                   "a set cell to have the flags of its own tile");
+
+  // Without a tile for the default TileID, unset cells have no flags.
+  ng::Tileset walls(sf::Vector2u(16, 16));
+  walls.AddTile(ng::Tile(TileID::kWall, kSolid));
+  ng::Tilemap sparse(&app, {3, 2}, std::move(walls));
+  ng::test::Expect(sparse.GetTileFlags({0, 0}) == 0,
+                   "unset cells to have no flags without a default tile");
+}
+
+}  // namespace
+
+int main() {
+  ng::App app(60);
+  TestDefaultFlags(app);
+  ng::Tileset tileset(sf::Vector2u(16, 16));
+  tileset.AddTile(ng::Tile(TileID::kEmpty));
+  tileset.AddTile(ng::Tile(TileID::kWall, kSolid));
+
+  auto scene = std::make_unique<ng::Scene>(&app);
+  auto& tilemap = scene->MakeChild<ng::Tilemap>(
+      sf::Vector2u(kRows[0].size(), kRows.size()), std::move(tileset));
+  tilemap.SetLocalPosition(kOrigin);
+  for (size_t y = 0; y < kRows.size(); ++y) {
+    for (size_t x = 0; x < kRows[y].size(); ++x) {
+      if (kRows[y][x] == '#') {
+        tilemap.SetTile(
+            {static_cast<uint32_t>(x), static_cast<uint32_t>(y)},
+            TileID::kWall);
+      }
+    }
+  }
+  app.LoadScene(std::move(scene));
+  app.RunTicks(1);
+
+  ng::test::Expect(tilemap.GetTileSize() == sf::Vector2u(16, 16),
+                   "the tile size of the tileset");
+  TestLanding(tilemap);
+  TestNoTunnelling(tilemap);
+  TestStartFlush(tilemap);
+  TestOutOfBounds(tilemap);
+  TestSingleAxis(tilemap);
+  TestStartInsideSolid(tilemap);
+  return ng::test::GetExitCode();
+}
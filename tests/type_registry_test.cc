@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "engine/app.h"
+#include "engine/node.h"
+#include "engine/scene.h"
+#include "tests/test.h"
+
+namespace {
+
+// The number of rounds of destroying and re-creating nodes.
+constexpr int kRoundCount = 5;
+
+class Enemy : public ng::Node {
+ public:
+  using ng::Node::Node;
+};
+
+/// @brief A subclass, which has a TypeId of its own.
+class Boss : public Enemy {
+ public:
+  using Enemy::Enemy;
+};
+
+class Coin final : public ng::Node {
+ public:
+  using ng::Node::Node;
+};
+
+/// @brief Returns every node ForEach visits, sorted.
+template <typename T>
+std::vector<ng::Node*> Visit(const ng::Scene& scene) {
+  std::vector<ng::Node*> visited;
+  scene.ForEach<T>([&visited](T& node) { visited.push_back(&node); });
+  std::ranges::sort(visited);
+  return visited;
+}
+
+/// @brief Checks that ForEach visits exactly the expected nodes, and that FindFirst returns one of them.
+template <typename T>
+bool HasExactly(const ng::Scene& scene, std::vector<ng::Node*> expected) {
+  std::ranges::sort(expected);
+  T* first = scene.FindFirst<T>();
+  bool is_first_right =
+      expected.empty() ? first == nullptr
+                       : std::ranges::find(expected, first) != expected.end();
+  return is_first_right && Visit<T>(scene) == expected;
+}
+
+/// @brief Removes a node from a list of expected nodes.
+void Erase(std::vector<ng::Node*>& nodes, ng::Node* node) {
+  nodes.erase(std::ranges::find(nodes, node));
+}
+
+void TestRegistry() {
+  ng::App app(60);
+  auto owned = std::make_unique<ng::Scene>(&app);
+  ng::Scene& scene = *owned;
+  app.LoadScene(std::move(owned));
+  app.RunTicks(1);
+
+  std::vector<ng::Node*> enemies;
+  std::vector<ng::Node*> bosses;
+  std::vector<ng::Node*> coins;
+  // Enemies at the root, each holding a coin, and bosses nested in a group.
+  ng::Node& group = scene.MakeChild<ng::Node>();
+  for (int i = 0; i < 4; ++i) {
+    auto& enemy = scene.MakeChild<Enemy>();
+    enemies.push_back(&enemy);
+    coins.push_back(&enemy.MakeChild<Coin>());
+    bosses.push_back(&group.MakeChild<Boss>());
+  }
+  // AddChild records the type when given a pointer to the exact type.
+  auto added = std::make_unique<Enemy>(&app);
+  enemies.push_back(added.get());
+  coins.push_back(&added->MakeChild<Coin>());
+  scene.AddChild(std::move(added));
+  // Through a pointer to a base class, the node has no TypeId and is not
+  // registered.
+  scene.AddChild(std::unique_ptr<ng::Node>(std::make_unique<Enemy>(&app)));
+  app.RunTicks(1);
+
+  ng::test::Expect(HasExactly<Enemy>(scene, enemies),
+                   "ForEach to visit every enemy but no boss");
+  ng::test::Expect(HasExactly<Boss>(scene, bosses),
+                   "ForEach to visit every boss");
+  ng::test::Expect(HasExactly<Coin>(scene, coins),
+                   "ForEach to visit every nested coin");
+
+  for (int round = 0; round < kRoundCount; ++round) {
+    // Destroys the first enemy, and its coin with it, then a boss.
+    ng::Node* enemy = enemies.front();
+    Erase(coins, enemy->GetChild<Coin>());
+    Erase(enemies, enemy);
+    enemy->Destroy();
+    ng::Node* boss = bosses.back();
+    Erase(bosses, boss);
+    boss->Destroy();
+    app.RunTicks(1);
+    ng::test::Expect(HasExactly<Enemy>(scene, enemies) &&
+                         HasExactly<Boss>(scene, bosses) &&
+                         HasExactly<Coin>(scene, coins),
+                     "destroyed nodes to leave the registry");
+
+    // Re-creates them, possibly in the memory the destroyed ones used.
+    auto& new_enemy = scene.MakeChild<Enemy>();
+    enemies.push_back(&new_enemy);
+    coins.push_back(&new_enemy.MakeChild<Coin>());
+    bosses.push_back(&group.MakeChild<Boss>());
+    app.RunTicks(1);
+    ng::test::Expect(HasExactly<Enemy>(scene, enemies) &&
+                         HasExactly<Boss>(scene, bosses) &&
+                         HasExactly<Coin>(scene, coins),
+                     "re-created nodes to join the registry");
+  }
+
+  // Destroying the group takes every boss with it.
+  group.Destroy();
+  bosses.clear();
+  app.RunTicks(1);
+  ng::test::Expect(HasExactly<Boss>(scene, bosses),
+                   "a destroyed subtree to leave the registry");
+  ng::test::Expect(HasExactly<Enemy>(scene, enemies),
+                   "a destroyed subtree to leave other types alone");
+
+  app.UnloadScene();
+  app.RunTicks(1);
+}
+
+void TestGetChild() {
+  ng::App app(60);
+  auto scene = std::make_unique<ng::Scene>(&app);
+  ng::Node& parent = scene->MakeChild<ng::Node>();
+  auto& boss = parent.MakeChild<Boss>();
+  auto untyped = std::make_unique<Enemy>(&app);
+  Enemy* enemy = untyped.get();
+  parent.AddChild(std::unique_ptr<ng::Node>(std::move(untyped)));
+  app.LoadScene(std::move(scene));
+  // Children are added at the start of the next tick.
+  app.RunTicks(1);
+
+  ng::test::Expect(parent.GetChild<Boss>() == &boss,
+                   "GetChild to find a child of the exact type");
+  ng::test::Expect(parent.GetChild<Enemy>() == nullptr,
+                   "GetChild to skip subclasses and untyped children");
+  ng::test::Expect(parent.GetChild<Coin>() == nullptr,
+                   "GetChild to find nothing without a child of the type");
+  ng::test::Expect(parent.GetChildDynamicCast<Enemy>() == &boss,
+                   "GetChildDynamicCast to match the first subclass");
+  ng::test::Expect(parent.GetChildDynamicCast<ng::Node>() == &boss,
+                   "GetChildDynamicCast to match any node as a Node");
+  boss.Destroy();
+  app.RunTicks(1);
+  ng::test::Expect(parent.GetChildDynamicCast<Enemy>() == enemy,
+                   "GetChildDynamicCast to match an untyped child");
+
+  app.UnloadScene();
+  app.RunTicks(1);
+}
+
+}  // namespace
+
+int main() {
+  TestRegistry();
+  TestGetChild();
+  return ng::test::GetExitCode();
+}
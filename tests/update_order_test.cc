@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "engine/app.h"
+#include "engine/node.h"
+#include "engine/scene.h"
+#include "tests/test.h"
+
+namespace {
+
+// The number of ticks of the harness, and of changes made before each tick.
+constexpr int kTickCount = 400;
+constexpr int kChangesPerTick = 12;
+
+/// @brief A child made by a node during its Update.
+struct Spawn {
+  ng::Node* parent = nullptr;
+  ng::Node* child = nullptr;
+};
+
+/// @brief What the nodes of the test write to during a tick.
+struct Journal {
+  // The nodes updated, in the order they were updated.
+  std::vector<const ng::Node*> updates;
+  // The children made during the updates, in the order they were made.
+  std::vector<Spawn> spawns;
+};
+
+/// @brief A node that logs its updates, and may make a child on its third one.
+class Logger : public ng::Node {
+ public:
+  Logger(ng::App* app, Journal* journal, bool spawns_child)
+      : ng::Node(app), journal_(journal), spawns_child_(spawns_child) {}
+
+ protected:
+  void Update() override {
+    journal_->updates.push_back(this);
+    if (spawns_child_ && ++update_count_ == 3) {
+      ng::Node& child = MakeChild<Logger>(journal_, false);
+      journal_->spawns.push_back({.parent = this, .child = &child});
+    }
+  }
+
+ private:
+  Journal* journal_ = nullptr;
+  bool spawns_child_ = false;
+  int update_count_ = 0;
+};
+
+/// @brief A mirror of the scene tree, in which changes take effect at once.
+class Model {
+ public:
+  /// @brief Adds a node as the last child of a parent. Null is the scene root.
+  void Add(ng::Node* parent, ng::Node* child, bool updates) {
+    children_[parent].push_back(child);
+    parents_[child] = parent;
+    if (updates) {
+      updating_.insert(child);
+    }
+    live_.push_back(child);
+  }
+
+  /// @brief Removes a node and its descendants.
+  void Remove(ng::Node* node) {
+    std::vector<ng::Node*>& siblings = children_[parents_.at(node)];
+    siblings.erase(std::ranges::find(siblings, node));
+    std::vector<ng::Node*> stack = {node};
+    while (!stack.empty()) {
+      ng::Node* current = stack.back();
+      stack.pop_back();
+      for (ng::Node* child : children_[current]) {
+        stack.push_back(child);
+      }
+      children_.erase(current);
+      parents_.erase(current);
+      updating_.erase(current);
+      live_.erase(std::ranges::find(live_, current));
+    }
+  }
+
+  /// @brief Returns the nodes that override Update, in a fresh pre-order walk.
+  [[nodiscard]] std::vector<const ng::Node*> GetUpdateOrder() const {
+    std::vector<const ng::Node*> order;
+    std::vector<ng::Node*> stack;
+    auto push_children = [&](ng::Node* parent) -> void {
+      auto it = children_.find(parent);
+      if (it != children_.end()) {
+        stack.insert(stack.end(), it->second.rbegin(), it->second.rend());
+      }
+    };
+    push_children(nullptr);
+    while (!stack.empty()) {
+      ng::Node* node = stack.back();
+      stack.pop_back();
+      if (updating_.contains(node)) {
+        order.push_back(node);
+      }
+      push_children(node);
+    }
+    return order;
+  }
+
+  /// @brief Returns every node of the model.
+  [[nodiscard]] const std::vector<ng::Node*>& GetLiveNodes() const {
+    return live_;
+  }
+
+ private:
+  std::unordered_map<ng::Node*, std::vector<ng::Node*>> children_;
+  std::unordered_map<ng::Node*, ng::Node*> parents_;
+  std::unordered_set<const ng::Node*> updating_;
+  std::vector<ng::Node*> live_;
+};
+
+void TestRandomChanges() {
+  std::mt19937 random(25);
+  std::uniform_int_distribution<int> operation(0, 9);
+  std::bernoulli_distribution coin(0.5);
+
+  ng::App app(60);
+  auto owned_scene = std::make_unique<ng::Scene>(&app);
+  ng::Scene& scene = *owned_scene;
+  app.LoadScene(std::move(owned_scene));
+  app.RunTicks(1);
+
+  Journal journal;
+  Model model;
+  // Nodes made since the last tick. They cannot be destroyed yet, since
+  // DestroyChild ignores nodes that are not children yet.
+  std::unordered_set<const ng::Node*> pending;
+  auto pick = [&]() -> ng::Node* {
+    const std::vector<ng::Node*>& nodes = model.GetLiveNodes();
+    std::uniform_int_distribution<size_t> index(0, nodes.size() - 1);
+    return nodes[index(random)];
+  };
+
+  for (int tick = 0; tick < kTickCount; ++tick) {
+    for (int change = 0; change < kChangesPerTick; ++change) {
+      int kind = operation(random);
+      ng::Node* parent =
+          model.GetLiveNodes().empty() || coin(random) ? nullptr : pick();
+      ng::Node* child = nullptr;
+      bool updates = true;
+      if (kind < 4) {
+        auto make = [&](auto& owner) -> ng::Node* {
+          return &owner.template MakeChild<Logger>(&journal, coin(random));
+        };
+        child = parent == nullptr ? make(scene) : make(*parent);
+      } else if (kind < 6) {
+        // Grouping nodes are left out of the update list.
+        child = parent == nullptr ? &scene.MakeChild<ng::Node>()
+                                  : &parent->MakeChild<ng::Node>();
+        updates = false;
+      } else if (kind == 6) {
+        // Nodes added by AddChild are assumed to override Update.
+        auto node = std::make_unique<Logger>(&app, &journal, false);
+        child = node.get();
+        if (parent == nullptr) {
+          scene.AddChild(std::move(node));
+        } else {
+          parent->AddChild(std::move(node));
+        }
+      } else if (!model.GetLiveNodes().empty()) {
+        ng::Node* node = pick();
+        if (!pending.contains(node)) {
+          node->Destroy();
+          model.Remove(node);
+        }
+      }
+
+      if (child != nullptr) {
+        model.Add(parent, child, updates);
+        pending.insert(child);
+      }
+    }
+
+    journal.updates.clear();
+    journal.spawns.clear();
+    app.RunTicks(1);
+    pending.clear();
+    ng::test::Expect(journal.updates == model.GetUpdateOrder(),
+                     "the update order to match a pre-order walk");
+
+    // Children made during the tick are added at the next one.
+    for (const Spawn& spawn : journal.spawns) {
+      model.Add(spawn.parent, spawn.child, true);
+      pending.insert(spawn.child);
+    }
+  }
+
+  app.UnloadScene();
+  app.RunTicks(1);
+}
+
+}  // namespace
+
+int main() {
+  TestRandomChanges();
+  return ng::test::GetExitCode();
+}